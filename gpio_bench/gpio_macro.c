@@ -0,0 +1,84 @@
+// Reference for gpio_template.cpp: writes to an HD44780 on the lcdtemp
+// pins and reads the interrupt_count button on P1.3 (shared with D7)
+// with the usual macros. Both files must stay the same program.
+
+#include <msp430.h>
+
+#include "delay.h"
+
+#define LCD_DIR P1DIR
+#define LCD_OUT P1OUT
+#define LCD_RS  (1 << 5)
+#define LCD_E   (1 << 4)
+#define LCD_D   0x0f
+#define BUTTON  (1 << 3)
+
+static void write_nibble(unsigned char data)
+{
+    LCD_OUT |= LCD_E;
+    LCD_OUT &= ~LCD_D;
+    LCD_OUT |= data;
+    delay_us(40);
+    LCD_OUT &= ~LCD_E;
+    delay_us(40);
+}
+
+static void write_byte(unsigned char data)
+{
+    write_nibble(data >> 4);
+    write_nibble(data & 0x0f);
+    delay_us(41);
+}
+
+// Turns D7 around, samples it with the pullup and gives it back.
+static unsigned char button_down(void)
+{
+    unsigned char down;
+
+    LCD_DIR &= ~BUTTON;
+    LCD_OUT |= BUTTON;
+    P1REN |= BUTTON;
+    delay_us(40);
+    down = !(P1IN & BUTTON);
+    P1REN &= ~BUTTON;
+    LCD_DIR |= BUTTON;
+    return down;
+}
+
+int main(void)
+{
+    unsigned char c = '0';
+    unsigned char was_down = 0;
+
+    WDTCTL = WDTPW | WDTHOLD;
+
+    LCD_DIR |= LCD_RS | LCD_E | LCD_D;
+    LCD_OUT &= ~(LCD_RS | LCD_E);
+    delay_ms(50);
+    write_nibble(0x3);
+    delay_ms(5);
+    write_nibble(0x3);
+    delay_us(200);
+    write_nibble(0x3);
+    write_nibble(0x2);
+    write_byte(0x28);
+    write_byte(0x0c); // Display on, cursor off, blinking off.
+    write_byte(0x01);
+    delay_ms(2);
+
+    // One more digit every press.
+    while(1)
+    {
+        unsigned char down = button_down();
+        if(down && !was_down)
+        {
+            LCD_OUT |= LCD_RS;
+            write_byte(c);
+            LCD_OUT &= ~LCD_RS;
+            if(++c > '9')
+                c = '0';
+        }
+        was_down = down;
+        delay_ms(10);
+    }
+}
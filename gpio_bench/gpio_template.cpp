@@ -0,0 +1,87 @@
+// gpio_macro.c written with gpio.hpp. Compare the two with make compare.
+
+#include <msp430.h>
+
+#include "gpio.hpp"
+
+extern "C" {
+#include "delay.h"
+}
+
+typedef Pin<Port1, 5> LcdRs;
+typedef Pin<Port1, 4> LcdE;
+typedef Bus4<Pin<Port1, 0>, Pin<Port1, 1>,
+             Pin<Port1, 2>, Shared<Pin<Port1, 3> > > LcdData;
+typedef PinGroup<LcdRs, LcdE, LcdData> Lcd;
+typedef Shared<Pin<Port1, 3> > Button;
+
+// Without Shared<> on both sides this fails to compile.
+static_assert(PinMap<Lcd, Button>::ok, "");
+
+static void write_nibble(unsigned char data)
+{
+    LcdE::set();
+    LcdData::write(data);
+    delay_us(40);
+    LcdE::clear();
+    delay_us(40);
+}
+
+static void write_byte(unsigned char data)
+{
+    write_nibble(data >> 4);
+    write_nibble(data & 0x0f);
+    delay_us(41);
+}
+
+// Turns D7 around, samples it with the pullup and gives it back.
+static bool button_down()
+{
+    bool down;
+
+    Button::input();
+    Button::pullup();
+    delay_us(40);
+    down = !Button::read();
+    Button::nopull();
+    Button::output();
+    return down;
+}
+
+int main(void)
+{
+    unsigned char c = '0';
+    bool was_down = false;
+
+    WDTCTL = WDTPW | WDTHOLD;
+
+    Lcd::output();
+    PinGroup<LcdRs, LcdE>::clear();
+    delay_ms(50);
+    write_nibble(0x3);
+    delay_ms(5);
+    write_nibble(0x3);
+    delay_us(200);
+    write_nibble(0x3);
+    write_nibble(0x2);
+    write_byte(0x28);
+    write_byte(0x0c); // Display on, cursor off, blinking off.
+    write_byte(0x01);
+    delay_ms(2);
+
+    // One more digit every press.
+    while(1)
+    {
+        bool down = button_down();
+        if(down && !was_down)
+        {
+            LcdRs::set();
+            write_byte(c);
+            LcdRs::clear();
+            if(++c > '9')
+                c = '0';
+        }
+        was_down = down;
+        delay_ms(10);
+    }
+}
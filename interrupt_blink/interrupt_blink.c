@@ -1,53 +1,51 @@
 #include <msp430.h>
 #include <intrinsics.h>
 
+#include "systick.h"
+
 #define eint() __eint()
-#define dint() __dint()
 
-// Timer interrupt. Blink led every half second.
-static void __attribute__ ((__interrupt__(TIMERA1_VECTOR))) blink_led(void)
-{
-    // Reset overflow interrupt. Reading TAIV resets highest pending
-    // interrupt flag for timers (TACCR1 CCIFG, TACCR2 CCIFG, TAIFG).
-    // Not needed for TACCR0 CCIFG (TIMERA0_VECTOR).
-    unsigned int ta = TAIV;
-    (void)ta;
-
-    // Toggle led.
-    P1OUT ^= (1 << 6);
-}
+#define LED (1 << 6)
+#define BLINK_US 500000
 
 int main(void)
 {
-    // Disable watchdog timer.
+    unsigned long last;
+
+    // Disable watchdog timer, systick_init() takes it over.
     WDTCTL = WDTPW | WDTHOLD;
 
-    // Calibrate main clock to 1Mhz.
+    // Calibrate main clock to 1Mhz. systick_calibrate() measures the VLO
+    // against it.
     if(CALBC1_1MHZ == 0xff || CALDCO_1MHZ == 0xff)
         while(1); // Trap if calibration values were erased.
     DCOCTL = 0; // Choose lowest DCO clock and MODx values.
     BCSCTL1 = CALBC1_1MHZ;
     DCOCTL = CALDCO_1MHZ;
 
-    // Set timer in up mode to count to give 500 ms interrupt.
-
-    // Use cpu clock for timer.
-    TACTL |= TASSEL1;
-    // Divide input clock by 8.
-    TACTL |= (ID1 | ID0);
-    // Count up.
-    TACTL |= MC0;
-    // Enable Timer A TAIFG interrupt.
-    TACTL |= TAIE;
-    // Enable global interrupt.
-    eint();
-    // Count up to 62500 => 0.5 second interrupt hit.
-    TACCR0 = 62500;
-
     // Set to output so we can turn on led.
-    P1DIR |= (1 << 6);
+    P1DIR |= LED;
+
+    systick_init();
+    eint();
+    systick_calibrate();
+
+    // Toggle every half second on the tick nearest to it, the next one
+    // half a second after when it should have been, not when it was.
+    // Toggles only come on ticks, so each is up to half a tick early or
+    // late: at a 6 kHz VLO (10.7 ms ticks, see the Makefile) the toggles
+    // are 46 or 47 ticks apart, 491 or 501 ms, and average 500 ms.
+    last = systick_us();
+    while(1)
+    {
+        // DCO off, only the VLO and the watchdog run.
+        __bis_status_register(LPM3_bits);
+        if(systick_us() - last + systick_tick_us() / 2 >= BLINK_US)
+        {
+            last += BLINK_US;
+            P1OUT ^= LED;
+        }
+    }
 
-    while(1);
-    
     return 0;
 }
@@ -1,77 +1,161 @@
 #include <msp430.h>
 #include <intrinsics.h>
 
+#include "boot.h"
+#include "lcdqueue.h"
+#include "ring.h"
+#include "trace.h"
+
 #define eint() __eint()
 #define dint() __dint()
 
-#define LCD_DIR P1DIR
-#define LCD_OUT P1OUT
-#define LCD_RS  (1 << 5)
-#define LCD_E   (1 << 4)
-#define BUTTON  (1 << 3)
+#define BUTTON (1 << 3) // LCD D7 as well, see lcdqueue.h.
+
+// Timer A runs from SMCLK / 8 = 125 kHz.
+#define DEBOUNCE_TICKS 2500 // 20 ms.
+#define RETRY_TICKS    125  // 1 ms.
+#define SETTLE_TICKS   250  // 2 ms.
+
+// Trace ids.
+#define TRACE_COUNT_PRESS 0
+#define TRACE_DEBOUNCE    1
+
+// Count after each press, newest last. Only the newest is displayed.
+// main() empties the ring on every display update. Should presses come
+// in faster than that, count_lost says the ring was full and count has
+// the newest one.
+// The count is BCD, a nibble per digit, incremented with dadd. It wraps
+// from 9999 to 0.
+RING_DECLARE(count_ring, unsigned int, 4)
+count_ring counts;
+volatile unsigned int count = 0;
+volatile unsigned char count_lost = 0;
+
+#define COUNT_DIGITS 4
 
-// Assumes n > 14.
-// Assumes a 1 Mhz clock.
-// Can be 3 cycles too long.
-static void delay_us(register unsigned int n)
+static const boot_step boot_steps[] = {lcdq_init_step};
+
+// Count as it is on the display, right aligned in the first columns.
+// lcdq_init_step() clears the display.
+char count_shown[COUNT_DIGITS] = {' ', ' ', ' ', ' '};
+
+static void count_queue(void)
 {
-    __asm__ __volatile__ (
-        "   sub #11, %[n]  \n\t"    // 2 + 5 + 2 + 1 + 1 + 4 * k cycles.
-                                    // k = (n - 11) / 4
-        "   rra %[n]       \n\t"    // 2 for moving into %[n] before call.
-                                    // 5 for calling function.
-                                    // 3 for ret from function is not
-                                    // included because division by 4
-                                    // can make the number of cycles 3 short
-                                    // in some cases. It's better to have
-                                    // three more cycles in some cases
-                                    // than come up short.
-        "   rra %[n]       \n\t"
-        "1: dec %[n]       \n\t"    // Have to use local labels (numbers).
-        "   nop            \n\t"    // Nop (single cycle, single byte).
-        "   jne 1b           \n"    // Jump backwards.
-        : [n] "+r" (n));
+    if(!count_ring_put(&counts, count))
+        count_lost = 1;
 }
 
-// Assumes n > 0.
-// Assumes a 1 Mhz clock.
-// Not exactly n ms because 2 cycles needed to load %[n], 5 cycles to
-// call function and 3 cycles to return from function.
-static void delay_ms(register unsigned int n)
+// Button edge (or software edge from pinshare_release()).
+static void __attribute__ ((__interrupt__(PORT1_VECTOR))) count_press(void)
 {
-    __asm__ __volatile__ (
-        "1: mov #331, r14  \n\t"   // 2 + 3 * 331 + 2 + 1 + 2 = 1000 cycles.
-        "2: dec r14        \n\t"   // Have to use local labels (numbers).
-        "   jne 2b         \n\t"   // Jump backwards.
-        "   jmp $+2        \n\t"   // Two cycle single byte nop.
-        "   dec %[n]       \n\t"   // Delay n 1ms cycles.
-        "   jne 1b           \n"   // Jump backwards.
-        : [n] "+r" (n));
+    TRACE_ENTER(TRACE_COUNT_PRESS);
+
+    // Need to manually clear P1IFG.
+    P1IFG &= ~BUTTON;
+
+    // Edge caused by the LCD driving D7.
+    if(lcdq_d7.role == PINSHARE_OUTPUT)
+    {
+        TRACE_EXIT(TRACE_COUNT_PRESS);
+        return;
+    }
+
+    if(!lcdq_d7.held)
+    {
+        // Count how many times the button is pressed.
+        // Queueing it indicates that the display needs to be updated.
+        count = __bcd_add_short(count, 1);
+        count_queue();
+    }
+    lcdq_d7.held = !lcdq_d7.held;
+
+    // Ignore bounces. The debounce timer looks at the pin again.
+    P1IE &= ~BUTTON;
+    TACCR1 = TAR + DEBOUNCE_TICKS;
+    TACCTL1 = CCIE;
+
+    // Wake up main loop to update display or to resume sending.
+    __bic_status_register_on_exit(LPM0_bits);
+
+    TRACE_EXIT(TRACE_COUNT_PRESS);
 }
 
-#define LCD_SET_INSTRUCTION() LCD_OUT &= ~LCD_RS
-#define LCD_SET_DATA()        LCD_OUT |= LCD_RS
+// Debounce timer. Sample the button once it has settled.
+static void __attribute__ ((__interrupt__(TIMERA1_VECTOR))) debounce(void)
+{
+    TRACE_ENTER_AT(TRACE_DEBOUNCE, TACCR1);
+
+    // Reading TAIV clears TACCR1 CCIFG.
+    unsigned int ta = TAIV;
+    (void)ta;
+
+    // LCD owns the pin right now. pinshare_release() hands it back
+    // shortly, try again then.
+    if(lcdq_d7.role == PINSHARE_OUTPUT)
+    {
+        TACCR1 += RETRY_TICKS;
+        TRACE_EXIT_AT(TRACE_DEBOUNCE);
+        return;
+    }
+    // Pressed or released during the debounce window.
+    unsigned char held = !(P1IN & BUTTON);
+    unsigned char changed = held != lcdq_d7.held;
+    if(held && !lcdq_d7.held)
+    {
+        count = __bcd_add_short(count, 1);
+        count_queue();
+    }
+    pinshare_set_held(&lcdq_d7, held);
+    // Changed with no edge seen, so the pin may be bouncing right now.
+    // Sample again once that is over instead of letting a bounce in as
+    // the next edge.
+    if(changed)
+    {
+        TACCR1 += SETTLE_TICKS;
+        __bic_status_register_on_exit(LPM0_bits);
+        TRACE_EXIT_AT(TRACE_DEBOUNCE);
+        return;
+    }
+    TACCTL1 = 0;
+    P1IE |= BUTTON;
+    // Changed again while switching edges.
+    if((!(P1IN & BUTTON)) != held)
+        P1IFG |= BUTTON;
 
-void lcd_initialize(void);
-void lcd_write_nibble(unsigned char data);
-void lcd_write_byte(unsigned char data);
-void lcd_send_instruction(unsigned char inst);
-void lcd_send_data(unsigned char inst);
-void lcd_goto(unsigned char loc);
+    __bic_status_register_on_exit(LPM0_bits);
 
-volatile int count = 0;
-// Display zero to begin.
-volatile unsigned char counted = 1;
+    TRACE_EXIT_AT(TRACE_DEBOUNCE);
+}
 
-// Button interrupt. Increment global count here.
-static void __attribute__ ((__interrupt__(PORT1_VECTOR))) count_press(void)
+// Queues the digits of bcd from the first one that differs from the
+// display. Digits come straight from the nibbles, leading zeros are
+// blank. A press only changes the last digit and the ones it carried
+// into, so that is usually one character.
+static void count_show(unsigned int bcd)
 {
-    // Need to manually clear P1IFG.
-    P1IFG &= ~BUTTON;
-    // Count how many times the button is pressed.
-    ++count;
-    // Indicates that the display needs to be updated.
-    counted = 1;
+    char text[COUNT_DIGITS];
+    unsigned char first = COUNT_DIGITS;
+    unsigned char lead = 1;
+    unsigned char i;
+
+    // Top nibble first, shifted by a constant each time.
+    for(i = 0; i < COUNT_DIGITS; ++i, bcd <<= 4)
+    {
+        unsigned char digit = (bcd >> 12) & 0x0f;
+        lead &= !digit && i != COUNT_DIGITS - 1;
+        text[i] = lead ? ' ' : '0' + digit;
+        if(first == COUNT_DIGITS && text[i] != count_shown[i])
+            first = i;
+    }
+
+    if(first == COUNT_DIGITS)
+        return;
+    lcdq_put(0x80 | first);
+    for(i = first; i < COUNT_DIGITS; ++i)
+    {
+        lcdq_put(LCDQ_DATA | text[i]);
+        count_shown[i] = text[i];
+    }
 }
 
 int main(void)
@@ -86,154 +170,62 @@ int main(void)
     BCSCTL1 = CALBC1_1MHZ;
     DCOCTL = CALDCO_1MHZ;
 
-    // Lcd initialization.
-    lcd_initialize();
-
-    // Set P1.3 as input to detect button press.
-    P1DIR &= ~BUTTON;
-    // Choose pullup.
-    P1OUT |= BUTTON;
-    // Enable pullup/pulldown resistor.
-    P1REN |= BUTTON;
-    // Button press detected on high to low transition.
-    P1IES |= BUTTON;
-    // Enable interrupt on P1.3.
-    P1IE |= BUTTON;
-    // Clear existing interrupts for button.
-    P1IFG &= ~BUTTON;
+    // Timer for debouncing.
+    // Use cpu clock for timer.
+    TACTL |= TASSEL1;
+    // Divide input clock by 8.
+    TACTL |= (ID1 | ID0);
+    // Count continuously.
+    TACTL |= MC1;
+
+    TRACE_INIT();
+
+    // P1.3 starts out as the button input. The LCD claims it per nibble.
+    pinshare_init(&lcdq_d7);
+
+    // Lcd initialization, timed on Timer A.
+    boot_run(boot_steps, 1);
+
+    // Display zero to begin.
+    count_ring_put(&counts, 0);
+
     // Enable global interrupt.
     eint();
 
     while(1)
     {
-        if(!counted)
-            continue; // Don't update count if not necessary.
-
-        // Critical section.
-        P1IE &= ~BUTTON;
-
-        // Debounce button press.
-        delay_ms(20);
-
-        // Wait until button is no longer pressed.
-        // Otherwise, P1.3 will be low affecting lcd display when it
-        // becomes an output.
-        while(!(P1IN & BUTTON))
-            ;
-
-        // Disable pullup/pulldown resistor.
-        P1REN &= ~BUTTON;
-        // Need to make P1.3 an output port for LCD code to work.
-        P1DIR |= BUTTON;
-
-        // Show current count.
-
-        // Convert number to string.
-        char buf[10];
-        buf[9] = '\0';
-        char *p = buf + 8;
-        int i = count;
-        if(!i)
-            *p-- = '0';
-        while(i)
+        // Show newest count once the previous one is on the display.
+        unsigned int bcd = 0;
+        unsigned char lost = count_lost;
+        if(lcdq_idle() && (count_ring_get(&counts, &bcd) || lost))
         {
-            *p-- = (i % 10) + '0';
-            i /= 10;
+            while(count_ring_get(&counts, &bcd))
+                ;
+            // Cleared before count is read, so a press in between shows
+            // up again next time round.
+            if(lost)
+            {
+                count_lost = 0;
+                bcd = count;
+            }
+            count_show(bcd);
+
+            TRACE_DUMP();
         }
 
-        // Display string on lcd.
-        lcd_goto(0x0); // Start on first row, first column.
-        lcd_send_instruction(0x01); // Clear lcd.
-        LCD_SET_DATA();
-        while(*++p)
-            lcd_send_data(*p);
-
-        // Go back to using P1.3 as input and set it to interrupt.
-
-        // Set P1.3 as input to detect button press.
-        P1DIR &= ~BUTTON;
-        // Choose pullup.
-        P1OUT |= BUTTON;
-        // Enable pullup/pulldown resistor.
-        P1REN |= BUTTON;
-        // Clear interrupt flag for button before re-enabling interrupts.
-        // Needed because changing PxOUT, PxDIR can cause it to be set.
-        P1IFG &= ~BUTTON;
-
-        // Acknowledged increase in count.
-        counted = 0;
-
-        // End of critical section.
-        P1IE |= BUTTON;
+        // Stops early if the button is down.
+        lcdq_flush();
+
+        // Sleep until there is a new count or the button is released.
+        // Checked with interrupts off so a wake up can't be missed before
+        // going to sleep.
+        dint();
+        if(lcdq_idle() ? count_ring_empty(&counts) && !count_lost :
+                         lcdq_d7.held)
+            __bis_status_register(LPM0_bits | GIE);
+        else
+            eint();
     }
     
     return 0;
 }
-
-// Initialization sequence for 4-bit access from HD44780 datasheet.
-void lcd_initialize(void)
-{
-    LCD_DIR |= (LCD_RS | LCD_E | 0x0f);
-    LCD_OUT &= ~LCD_RS;
-
-    delay_ms(50);
-    lcd_write_nibble(0x3);
-    delay_ms(5);
-    lcd_write_nibble(0x3);
-    delay_us(200);
-    lcd_write_nibble(0x3);
-    delay_us(37);
-    lcd_write_nibble(0x2);
-    delay_us(37);
-    lcd_send_instruction(0x28);
-    lcd_send_instruction(0x08);
-    lcd_send_instruction(0x01);
-    lcd_send_instruction(0x06);
-
-    lcd_send_instruction(0x0c); // Display on, cursor off, blinking off.
-    lcd_send_instruction(0x02); // Go home.
-    delay_us(1520 - 37);        // Going home takes longer than other
-                                // instructions.
-}
-
-// Write a byte to HD44780.
-void lcd_write_byte(unsigned char data)
-{
-    lcd_write_nibble(data >> 4);
-    lcd_write_nibble(data & 0x0f);
-}
-
-// Assume data <= 0xf.
-void lcd_write_nibble(unsigned char data)
-{
-    LCD_OUT |= LCD_E;
-    LCD_OUT &= 0xf0;
-    LCD_OUT |= data;
-    delay_ms(1);
-    LCD_OUT &= ~LCD_E;
-    delay_ms(1);
-}
-
-// Use LCD_SET_INSTRUCTION() first.
-void lcd_send_instruction(unsigned char inst)
-{
-    lcd_write_byte(inst);
-    delay_us(37);
-}
-
-// Use LCD_SET_DATA() first.
-void lcd_send_data(unsigned char data)
-{
-    lcd_write_byte(data);
-    delay_us(41);
-}
-
-// First bit tells which row.
-void lcd_goto(unsigned char loc)
-{
-    LCD_SET_INSTRUCTION();
-    if(loc & 0x80)
-        lcd_send_instruction(0x80 | (0x40 + loc));
-    else
-        lcd_send_instruction(0x80 | loc);
-}
@@ -1,8 +1,18 @@
 #include <msp430.h>
 #include <intrinsics.h>
 
-#include "display.h"
+#include "pcd8544.h"
+#include "clock.h"
 #include "delay.h"
+#include "physics.h"
+#include "ring.h"
+#include "spi.h"
+#include "text.h"
+#include "trace.h"
+#include "world.h"
+
+// player_sprite[], PHYSICS_WIDTH columns of one bank.
+#include "player_sprite.pcd8544.h"
 
 #define debug() P1DIR |= 1; do { P1OUT ^= 1; delay_ms(500); } while(1)
 #define eint() __eint()
@@ -10,55 +20,103 @@
 #define min(a, b) (((a) < (b)) ? (a) : (b))
 #define max(a, b) (((a) > (b)) ? (a) : (b))
 
-volatile unsigned char button_pressed = 0;
-volatile unsigned char button_press_pending = 0;
-volatile unsigned char gravity_pending = 0;
-volatile unsigned char player_row_prev = 32;
-volatile unsigned char player_row = 32;
-volatile signed char * first_block_col = 0;
+// Trace ids.
+#define TRACE_BUTTON_PRESS 0
+#define TRACE_FRAME_DRAW   1 // Interrupts masked while drawing.
+#define TRACE_FRAME_SCROLL 2 // Interrupts masked while scrolling.
+
+// Button presses from the ISR. Handled once per frame.
+RING_DECLARE(press_ring, unsigned char, 4)
+press_ring presses;
+physics_body player = {PHYSICS_FIX(PHYSICS_GROUND), 0, 1};
+unsigned char player_row_prev = PHYSICS_GROUND;
+unsigned char player_row = PHYSICS_GROUND;
+// Blocks that went past.
+unsigned int score = 0;
+// Whole dt since the last physics step, from the TACCR1 tick. The rest of
+// a dt carries over by itself.
+volatile unsigned char frame_dts = 0;
+// Timer A ticks per dt at the current clock.
+static unsigned int dt_ticks = PHYSICS_DT_TICKS;
 
 void init_cpu(void);
 volatile unsigned int rand = 0xFADE;
 unsigned int rand_int();
 
-typedef struct
+static void __attribute__ ((__interrupt__(PORT1_VECTOR))) button_press(void)
 {
-    signed char col;
-    signed char len;
-} block;
+    TRACE_ENTER(TRACE_BUTTON_PRESS);
 
-static void __attribute__ ((__interrupt__(TIMER0_A0_VECTOR))) gravity(void)
+    P1IFG &= ~_(3); // Need manual interrupt clear.
+    // Dropped if the frame loop is 4 presses behind.
+    press_ring_put(&presses, 1);
+
+    TRACE_EXIT(TRACE_BUTTON_PRESS);
+}
+
+// Every dt. Counts up to PHYSICS_DT_MAX, longer frames run slow.
+static void __attribute__ ((__interrupt__(TIMERA1_VECTOR))) frame_tick(void)
 {
-    TACTL &= ~MC0;
-    //if(player_row == 3 && *first_block_col > 5)
-    if(player_row < 32 && *first_block_col > 5)
-        player_row_prev = player_row++;
+    // Reading TAIV clears TACCR1 CCIFG.
+    unsigned int ta = TAIV;
+    (void)ta;
+
+    TACCR1 += dt_ticks;
+    if(frame_dts < PHYSICS_DT_MAX)
+        frame_dts++;
 }
 
-static void __attribute__ ((__interrupt__(PORT1_VECTOR))) button_press(void)
+// Clock listener (clock.h): Timer A counts SMCLK / 8, PHYSICS_DT_TICKS a
+// dt at 1 Mhz.
+static void frame_clock(unsigned char mhz)
 {
-    P1IFG &= ~_(3); // Need manual interrupt clear.
-    //if(player_row == 4)
-    //if(player_row > 24 && !button_press_pending)
-    if(!button_press_pending)
-    {
-        button_pressed = 1;
-        //player_row_prev = player_row--;   // Move player.
-        // Gravity kicks in.
-        //TAR = 0;
-        //TACTL |= MC0;
-    }
+    dt_ticks = PHYSICS_DT_TICKS * mhz;
+}
+
+
+// Column j of the player in bank, with its top at row. Bit 0 is the top.
+static unsigned char player_byte(unsigned char j, unsigned char row,
+                                 unsigned char bank)
+{
+    unsigned char top = row >> 3;
+
+    if(bank == top)
+        return player_sprite[j] << (row & 7);
+    if(bank == top + 1 && (row & 7))
+        return player_sprite[j] >> (8 - (row & 7));
+    return 0;
+}
+
+static void draw_score(void)
+{
+    char buf[TEXT_COLS + 1];
+
+    text_utoa(score, buf, 5);
+    text_goto(0, TEXT_COLS - 5);
+    text_puts(buf);
 }
 
 int main(void)
 {
     init_cpu();
+
+    // 16 Mhz, so the frame bursts out with SCLK at 4 Mhz. Stays at 1 Mhz
+    // without the calibration. spi_clock() is in before spi_init(), which
+    // keeps the divider.
+    clock_listen(delay_clock);
+    clock_listen(spi_clock);
+    clock_listen(frame_clock);
+    clock_set(CLOCK_16MHZ);
+
     display_init();
 
-    // For gravity.
-    TACTL |= TASSEL1 | ID0 | ID1;
-    TACCTL0 |= CCIE;
-    TACCR0 = 62500 / 2;
+    // Frame times for the physics, a TACCR1 compare every dt. SMCLK / 8,
+    // counting continuously. Trace builds take their timestamps from it
+    // too, 0.5 us ticks at 16 Mhz.
+    TACTL = TASSEL_2 | ID_3 | MC_2 | TACLR;
+    TACCR1 = TAR + dt_ticks;
+    TACCTL1 = CCIE;
+    TRACE_INIT();
 
     // Initialize register to read pin on interrupt.
     P1DIR &= ~_(3); // Read input.
@@ -76,23 +134,12 @@ int main(void)
     //blocks[2].col = 50;
     //blocks[2].len = 10;
 
-    first_block_col = &blocks[0].col;
-
     unsigned char i;
     unsigned char j;
-    signed char lim_begin;
-    signed char lim_end;
+    unsigned char bank;
+    unsigned char over[PHYSICS_WIDTH];
     unsigned char num_blocks = sizeof(blocks) / sizeof(block);
 
-    // Gravity steps.
-    unsigned char gravity_up[] = {1, 2, 3, 1, 1, 0, 0, 0};
-    unsigned char gravity_down[] = {1, 2, 2, 3, 4, 4};
-    unsigned char *gravity_up_begin = gravity_up;
-    unsigned char *gravity_up_end = gravity_up + sizeof(gravity_up) / sizeof(gravity_up[0]);
-    unsigned char *gravity_down_begin = gravity_down;
-    unsigned char *gravity_down_end = gravity_down + sizeof(gravity_down) / sizeof(gravity_down[0]);
-    unsigned char *gravity_idx = gravity_up_begin;
-
     // Display bottom bar.
     display_goto(5, 0);
     DISPLAY_SET_DATA();
@@ -101,162 +148,78 @@ int main(void)
         display_send_byte(0xff);
     }
 
+    text_goto(0, 0);
+    text_puts("Score");
+    draw_score();
+
+    world_init(blocks, num_blocks);
+
     while(1)
     {
+        // Send the trace once per new block.
+        if(blocks[num_blocks - 1].col == 84)
+            TRACE_DUMP();
+
         // Critical section.
         dint();
+        TRACE_ENTER(TRACE_FRAME_DRAW);
 
         // Check for game over.
         //if(blocks[0].col == 4 && player_row > 24)
         //goto game_over;
 
-        // Gravity.
-        if(gravity_pending)
-        {
-            if(gravity_idx != gravity_down_end && player_row != 32)
-            {
-                player_row_prev = player_row;
-                player_row += *gravity_idx++;
-            }
-            else
-            {
-                gravity_idx = gravity_up_begin;
-                gravity_pending = 0;
-            }
-        }
+        // Presses in the air don't start another jump.
+        unsigned char press;
+        while(press_ring_get(&presses, &press))
+            physics_jump(&player);
 
-        // Handle button press.
-        if(!gravity_pending && button_pressed)
-        {
-            if(gravity_idx != gravity_up_end)
-            {
-                player_row_prev = player_row;
-                player_row -= *gravity_idx++;
-                button_press_pending = 1;
-            }
-            else
-            {
-                button_press_pending = 0;
-                button_pressed = 0;
-                // Gravity kicks in.
-                gravity_pending = 1;
-                gravity_idx = gravity_down_begin;
-            }
-        }
+        // Time since the last frame in whole dt. Frames over
+        // PHYSICS_DT_MAX are cut short.
+        unsigned char dt = frame_dts;
+        frame_dts = 0;
 
-        // Check to see if landed on top of block.
-        unsigned char player_on_block = (blocks[0].col <= 5 && player_row == 24);
-        if(player_on_block)
-        {
-            button_pressed = 0;
-            button_press_pending = 0;
-            gravity_pending = 0;
-            gravity_idx = gravity_up_begin;
-        }
+        physics_step(&player, dt, blocks, num_blocks);
+        player_row_prev = player_row;
+        player_row = player.y >> 8;
 
-        // Display all blocks.
-        for(j = 0; j < num_blocks; ++j)
+        // Above the blocks' bank the player is alone. Every bank it was or
+        // is in is erased and drawn in one pass, only when it moved.
+        if(player_row != player_row_prev)
         {
-            lim_begin = max(0, blocks[j].col);
-            lim_end = min(blocks[j].col + blocks[j].len, 84);
-
-            display_goto(4, lim_begin);
-            DISPLAY_SET_DATA();
-
-            for(i = lim_begin; i < lim_end; ++i)
+            for(bank = min(player_row, player_row_prev) >> 3;
+                bank < WORLD_BANK; ++bank)
             {
-                display_send_byte(0xff);
+                for(j = 0; j < PHYSICS_WIDTH; ++j)
+                    over[j] = player_byte(j, player_row, bank);
+                display_goto(bank, 0);
+                DISPLAY_SET_DATA();
+                display_send_bytes(over, PHYSICS_WIDTH);
             }
         }
 
+        // The blocks' bank, with the player over it.
+        for(j = 0; j < PHYSICS_WIDTH; ++j)
+            over[j] = player_byte(j, player_row, WORLD_BANK);
+        world_flush(over, PHYSICS_WIDTH);
+
         // Wait to change frame.
         // Can interrupt here.
+        TRACE_EXIT(TRACE_FRAME_DRAW);
         eint();
         delay_ms(33);
         dint();
+        TRACE_ENTER(TRACE_FRAME_SCROLL);
 
-        // Clear whatever was drawn. No frame buffer.
+        // Everything moves a column left. Only the column coming in on the
+        // right is composed.
         for(j = 0; j < num_blocks; ++j)
-        {
-            if(blocks[j].col == -blocks[j].len)
-                continue;
-
-            lim_begin = max(0, blocks[j].col);
-            lim_end = min(blocks[j].col + blocks[j].len, 84);
-
-            display_goto(4, lim_begin);
-            DISPLAY_SET_DATA();
-
-            for(i = lim_begin; i < lim_end; ++i)
-            {
-                display_send_byte(0x00);
-            }
-
             blocks[j].col--;
-        }
-
-        const unsigned char player[] = {0x08, 0xeb, 0x3f, 0xeb, 0x08};
-        // Clear previous player.
-        //display_goto(player_row_prev, 0);
-        unsigned char player_row_prev_bot = (player_row_prev >> 3);
-        unsigned char player_row_prev_aligned =
-            player_row_prev - (player_row_prev_bot << 3);
-        if(player_row_prev_aligned)
-            ++player_row_prev_bot;
-        unsigned char player_row_prev_top = player_row_prev_bot - 1;
-        display_goto(player_row_prev_bot, 0);
-        DISPLAY_SET_DATA();
-        for(j = 0; j < sizeof(player) / sizeof(player[0]); ++j)
-        {
-            display_send_byte(0x00);
-        }
-        if(player_row_prev_aligned)
-        {
-            display_goto(player_row_prev_top, 0);
-            DISPLAY_SET_DATA();
-            for(j = 0; j < sizeof(player) / sizeof(player[0]); ++j)
-            {
-                display_send_byte(0x00);
-            }
-        }
-
-        // Draw player.
-        //display_goto(player_row, 0);
-        unsigned char player_row_bot = (player_row >> 3);
-        unsigned char player_row_aligned =
-            player_row - (player_row_bot << 3);
-        if(player_row_aligned)
-            ++player_row_bot;
-        unsigned char player_row_top = player_row_bot - 1;
-        // Draw bottom part.
-        display_goto(player_row_bot, 0);
-        DISPLAY_SET_DATA();
-        for(j = 0; j < sizeof(player) / sizeof(player[0]); ++j)
-        {
-            display_send_byte(player[j] >> ((player_row_bot << 3) - player_row));
-        }
-        if(player_row_aligned)
-        {
-            // Draw top part.
-            display_goto(player_row_top, 0);
-            DISPLAY_SET_DATA();
-            for(j = 0; j < sizeof(player) / sizeof(player[0]); ++j)
-            {
-                display_send_byte(player[j] << (player_row - (player_row_top << 3)));
-            }
-        }
+        world_scroll(blocks, num_blocks);
 
         // If the left most block is off the screen, add a new block.
         if(blocks[0].col == -blocks[0].len)
         {
-            //if(player_row == 3)
-            //player_row_prev = player_row++;
-            if(player_row == 24)
-            {
-                gravity_pending = 1;
-                gravity_idx = gravity_down_begin;
-            }
-
+            // Whoever stood on it falls on the next physics_step().
             for(j = 0; j < num_blocks - 1; ++j)
             {
                 blocks[j].col = blocks[j + 1].col;
@@ -265,8 +228,12 @@ int main(void)
 
             blocks[j].col = 84;
             blocks[j].len = (rand_int() % 11) + 10;
+
+            ++score;
+            draw_score();
         }
 
+        TRACE_EXIT(TRACE_FRAME_SCROLL);
         eint();
     }
 
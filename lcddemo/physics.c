@@ -0,0 +1,60 @@
+#include "physics.h"
+
+// x * dt / 256, dt's bits lowest first: halving the sum each time keeps
+// it within x, so nothing overflows 16 bits.
+static int scale(int x, unsigned char dt)
+{
+    int sum = 0;
+    unsigned char bit;
+
+    x >>= 1;
+    for(bit = 1; bit; bit <<= 1)
+    {
+        sum >>= 1;
+        if(dt & bit)
+            sum += x;
+    }
+    return sum;
+}
+
+unsigned char physics_jump(physics_body *b)
+{
+    if(!b->standing)
+        return 0;
+    b->v = -PHYSICS_JUMP;
+    b->standing = 0;
+    return 1;
+}
+
+void physics_step(physics_body *b, unsigned char dt, const block *blocks,
+                  unsigned char n)
+{
+    int v;
+    int y;
+    int floor = PHYSICS_FIX(PHYSICS_GROUND);
+    unsigned char i;
+
+    if(dt > PHYSICS_DT_MAX)
+        dt = PHYSICS_DT_MAX;
+    v = b->v + scale(PHYSICS_GRAVITY, dt);
+    // Mean of the velocities, exact for constant gravity.
+    y = b->y + scale((b->v >> 1) + (v >> 1), dt);
+
+    // A block's top is only in the way on the way down, from above it, and
+    // if it was under the sprite at some point in the step: now or a
+    // column to the right.
+    if(v >= 0 && b->y <= PHYSICS_FIX(PHYSICS_BLOCK))
+        for(i = 0; i < n; ++i)
+            if(blocks[i].col < PHYSICS_WIDTH &&
+               blocks[i].col + blocks[i].len >= 0)
+                floor = PHYSICS_FIX(PHYSICS_BLOCK);
+
+    b->standing = y >= floor;
+    if(b->standing)
+    {
+        y = floor;
+        v = 0;
+    }
+    b->y = y;
+    b->v = v;
+}
@@ -0,0 +1,65 @@
+#ifndef PHYSICS_H_
+#define PHYSICS_H_
+
+// lcddemo's jump: velocity, gravity and a jump impulse in 8.8 fixed point
+// (1/256 pixel), rows growing downwards like the display's.
+//
+// Time steps (dt) are PHYSICS_DT_TICKS of 125 kHz, about 2 ms (Timer A
+// at SMCLK / 8 and 1 Mhz, lcddemo scales it to the clock), up to
+// PHYSICS_DT_MAX. Velocities are per 256 of them (524 ms)
+// and positions move by the mean of the velocity before and after a step,
+// which is exact for constant gravity, so a jump has the same height and
+// length whatever the frame rate. Products with dt are 8 shifts and adds
+// (no multiply on the G2452), so a step costs the same for any dt.
+// That is about 262 cycles a frame over lcddemo's 2 blocks and 5714 for
+// a jump at dt 10, against 52 and 728 for the step tables it replaced
+// (estimates counted by hand, sim/targets/bench_lcddemo.c).
+//
+//     physics_body player = {PHYSICS_FIX(PHYSICS_GROUND), 0, 1};
+//     physics_jump(&player);                     // On a press.
+//     physics_step(&player, dt, blocks, 2);      // Every frame.
+//     player_row = player.y >> 8;
+//
+// Collision is swept: the sprite lands on the ground or a block when its
+// bottom went through the top of it during the step, so a long step
+// can't fall through.
+
+#define PHYSICS_FIX(px) ((int)(px) << 8)
+
+#define PHYSICS_DT_TICKS 256
+#define PHYSICS_DT_MAX   64 // 131 ms. Longer frames run slow.
+
+// Per 256 dt. Jumps 10 pixels in 250 ms.
+#define PHYSICS_JUMP    10737 // 80 pixels per s.
+#define PHYSICS_GRAVITY 22518 // 320 pixels per s^2.
+
+// The player's 5x8 sprite in the first columns.
+#define PHYSICS_WIDTH 5
+// Player rows (top of the sprite) standing on the ground and on a block.
+#define PHYSICS_GROUND 32
+#define PHYSICS_BLOCK  24
+
+// Block on the ground, moved left a column per frame.
+typedef struct
+{
+    signed char col;
+    signed char len;
+} block;
+
+typedef struct
+{
+    int y;                  // Top of the sprite.
+    int v;                  // Negative is up.
+    unsigned char standing; // On the ground or a block, can jump.
+} physics_body;
+
+// Jumps if standing. Returns 0 if it can't.
+unsigned char physics_jump(physics_body *b);
+
+// Gravity for dt, then lands on whatever of blocks (n of them) or the
+// ground the sprite went into. The blocks are where this frame draws them,
+// a column left of the last one.
+void physics_step(physics_body *b, unsigned char dt, const block *blocks,
+                  unsigned char n);
+
+#endif
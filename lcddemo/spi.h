@@ -1,7 +0,0 @@
-#ifndef SPI_H_
-#define SPI_H_
-
-void spi_init(void);
-void spi_send_byte(unsigned char byte);
-
-#endif
@@ -0,0 +1,126 @@
+#include "world.h"
+
+#include <msp430.h>
+
+#include "pcd8544.h"
+
+// A goto is two command bytes, so changed columns at most this far apart
+// are sent as one span with the ones in between.
+#define SPAN_GAP 2
+
+static unsigned char ring[WORLD_COLS];
+// Ring index of the leftmost column on the display.
+static unsigned char head = 0;
+// Scrolls since the last flush, WORLD_FULL to send every column.
+static unsigned char scrolls;
+#define WORLD_FULL 0xff
+// What was the leftmost column before the last scroll.
+static unsigned char left_was;
+
+// Blocks fill their bank, a column is all or nothing.
+static unsigned char column(const block *blocks, unsigned char n, int col)
+{
+    unsigned char i;
+
+    for(i = 0; i < n; ++i)
+        if(col >= blocks[i].col && col < blocks[i].col + blocks[i].len)
+            return 0xff;
+    return 0x00;
+}
+
+void world_init(const block *blocks, unsigned char n)
+{
+    unsigned char i;
+
+    head = 0;
+    scrolls = WORLD_FULL;
+    for(i = 0; i < WORLD_COLS; ++i)
+        ring[i] = column(blocks, n, i);
+}
+
+void world_scroll(const block *blocks, unsigned char n)
+{
+    // The old leftmost column becomes the new rightmost one.
+    left_was = ring[head];
+    ring[head] = column(blocks, n, WORLD_COLS - 1);
+    if(++head == WORLD_COLS)
+        head = 0;
+    if(scrolls != WORLD_FULL)
+        scrolls++;
+}
+
+// Ring index of display column col.
+static unsigned char at(unsigned char col)
+{
+    col += head;
+    return col < WORLD_COLS ? col : col - WORLD_COLS;
+}
+
+// Display columns from to to - 1, from where the last send left off.
+static void send(unsigned char from, unsigned char to)
+{
+    unsigned char first = at(from);
+
+    if(first + (to - from) <= WORLD_COLS)
+        display_send_bytes(ring + first, to - from);
+    else
+    {
+        // Horizontal addressing carries on from the end of the ring.
+        display_send_bytes(ring + first, WORLD_COLS - first);
+        display_send_bytes(ring, to - from - (WORLD_COLS - first));
+    }
+}
+
+// Whether a single scroll changed display column col.
+static unsigned char changed(unsigned char col)
+{
+    return ring[at(col)] != (col ? ring[at(col - 1)] : left_was);
+}
+
+void world_flush(const unsigned char *over, unsigned char n)
+{
+    unsigned char first[WORLD_OVER];
+    unsigned char col;
+    unsigned char start;
+    unsigned char last;
+    // Where the display's address is.
+    unsigned char addr = n;
+
+    for(col = 0; col < n; ++col)
+        first[col] = ring[at(col)] | over[col];
+    display_goto(WORLD_BANK, 0);
+    DISPLAY_SET_DATA();
+    if(n)
+        display_send_bytes(first, n);
+
+    if(scrolls != 1)
+    {
+        if(scrolls)
+            send(n, WORLD_COLS);
+        scrolls = 0;
+        return;
+    }
+    scrolls = 0;
+
+    col = n;
+    while(col < WORLD_COLS)
+    {
+        if(!changed(col++))
+            continue;
+
+        // A span ends SPAN_GAP unchanged columns after its last change.
+        start = last = col - 1;
+        for(; col < WORLD_COLS && col - last <= SPAN_GAP; ++col)
+            if(changed(col))
+                last = col;
+
+        if(start - addr > SPAN_GAP)
+        {
+            display_goto(WORLD_BANK, start);
+            DISPLAY_SET_DATA();
+            addr = start;
+        }
+        send(addr, last + 1);
+        addr = last + 1;
+    }
+}
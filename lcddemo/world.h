@@ -0,0 +1,41 @@
+#ifndef WORLD_H_
+#define WORLD_H_
+
+#include "physics.h"
+
+// The blocks' bank of the display as a ring of columns.
+//
+// Scrolling is moving the head, the ring index of the leftmost column on
+// the display, one on and composing the column that comes in on the
+// right. Nothing else is composed, so a scroll costs the same however
+// wide the blocks are. A flush sends the first columns with the sprite
+// that is in the bank ORed over them, then only the columns a scroll
+// changed: those where the blocks begin or end. Changed columns close
+// together go as one span rather than with a goto each. The whole bank
+// is sent after world_init() or more than one scroll.
+//
+//     world_init(blocks, 2);
+//     ... every frame ...
+//     world_flush(player_bank4, 5);
+//     for(j = 0; j < 2; ++j)
+//         blocks[j].col--;
+//     world_scroll(blocks, 2);
+
+#define WORLD_COLS 84
+#define WORLD_BANK 4
+// Most columns world_flush() lays over the ring.
+#define WORLD_OVER 5
+
+// Composes every column from blocks.
+void world_init(const block *blocks, unsigned char n);
+
+// Moves the display a column to the right over the world. blocks are
+// where they are after it, the new rightmost column is composed from
+// them.
+void world_scroll(const block *blocks, unsigned char n);
+
+// Sends the bank with over (n <= WORLD_OVER bytes) ORed over its first
+// columns. The ring keeps only the blocks.
+void world_flush(const unsigned char *over, unsigned char n);
+
+#endif
@@ -0,0 +1,98 @@
+#include "adcscan.h"
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+// Real hardware takes the block address as is, the simulator needs its
+// own macro for host pointers.
+#ifndef ADC10SA_SET
+#define ADC10SA_SET(block) (ADC10SA = (unsigned int)(block))
+#endif
+
+static const adcscan_channel *channels;
+static unsigned char count;
+static unsigned char top;
+static unsigned char scans;         // Per round.
+static volatile unsigned char scan; // In this round.
+static volatile unsigned char done;
+
+// One scan, A(top) first.
+static volatile unsigned int block[12];
+static unsigned int sums[ADCSCAN_CHANNELS];
+static unsigned int results[ADCSCAN_CHANNELS];
+
+void adcscan_init(const adcscan_channel *list, unsigned char n,
+                  unsigned int ctl0)
+{
+    unsigned char i;
+    unsigned char ae = 0;
+    unsigned char shift = 0;
+
+    channels = list;
+    count = n;
+    top = 0;
+    for(i = 0; i < n; ++i)
+    {
+        if(list[i].inch > top)
+            top = list[i].inch;
+        if(list[i].shift > shift)
+            shift = list[i].shift;
+        if(list[i].inch < 8)
+            ae |= 1 << list[i].inch;
+        sums[i] = 0;
+    }
+    scans = 1 << shift;
+    scan = 0;
+    done = 0;
+
+    ADC10CTL0 &= ~ENC;
+    // Sequence from A(top) to A0, ADC10OSC / 4, triggered by ADC10SC.
+    ADC10CTL1 = ((unsigned int)top << 12) | ADC10DIV_3 | CONSEQ_1;
+    ADC10AE0 |= ae;
+    ADC10CTL0 = ctl0 | MSC | ADC10ON | ADC10IE;
+    // One block per scan, started again at ADC10SA after each.
+    ADC10DTC0 = ADC10CT;
+    ADC10DTC1 = top + 1;
+    ADC10SA_SET(block);
+}
+
+void adcscan_start(void)
+{
+    done = 0;
+    scan = 0;
+    ADC10CTL0 |= ENC | ADC10SC;
+}
+
+unsigned char adcscan_done(void)
+{
+    return done;
+}
+
+unsigned int adcscan_result(unsigned char i)
+{
+    return results[i];
+}
+
+// A scan is in block.
+static void __attribute__ ((__interrupt__(ADC10_VECTOR))) adcscan_block(void)
+{
+    unsigned char i;
+
+    for(i = 0; i < count; ++i)
+        if(scan < (1 << channels[i].shift))
+            sums[i] += block[top - channels[i].inch];
+
+    if(++scan < scans)
+    {
+        ADC10CTL0 |= ADC10SC;
+        return;
+    }
+
+    for(i = 0; i < count; ++i)
+    {
+        results[i] = sums[i] >> channels[i].shift;
+        sums[i] = 0;
+    }
+    done = 1;
+    __bic_status_register_on_exit(LPM0_bits);
+}
@@ -0,0 +1,48 @@
+#ifndef ADCSCAN_H_
+#define ADCSCAN_H_
+
+// ADC10 channel scan.
+//
+// Each scan is one sequence (CONSEQ_1, MSC) from the highest channel
+// asked for down to A0, moved to RAM by the DTC. The CPU only runs once
+// per scan, in the block interrupt, to add up the channels it was asked
+// for. A round is as many scans as the largest oversampling ratio; each
+// channel is averaged over its own first 1 << shift scans.
+//
+//     static const adcscan_channel channels[] = {{10, 4}, {11, 1}};
+//     adcscan_init(channels, 2, SREF_1 | REFON | REF2_5V | ADC10SHT_3);
+//     adcscan_start();
+//     ... sleep in LPM0 until adcscan_done() ...
+//     adcscan_result(0);  // Temperature, average of 16 scans.
+//
+// Every channel gets the same sample time. ADC10OSC / 4 with ADC10SHT_3
+// gives about 50 us (at least 40 us), enough for the temperature sensor's
+// 30 us, and about 60 us per channel converted.
+
+#ifndef ADCSCAN_CHANNELS
+#define ADCSCAN_CHANNELS 4
+#endif
+
+typedef struct
+{
+    unsigned char inch;  // 0 to 11. A0 to A7 get their ADC10AE0 bit set.
+    unsigned char shift; // Averaged over 1 << shift scans, at most 6.
+} adcscan_channel;
+
+// Sets up ADC10 and the DTC, channels has to stay around. ctl0 is the
+// reference and sample time part of ADC10CTL0 (SREFx, REFON, REF2_5V,
+// ADC10SHTx). The reference needs 30 us after this before adcscan_start().
+void adcscan_init(const adcscan_channel *channels, unsigned char n,
+                  unsigned int ctl0);
+
+// Starts a round. The interrupt clears LPM0 on exit when it's done.
+// Needs GIE.
+void adcscan_start(void);
+
+// Returns 1 once the round started by adcscan_start() is done.
+unsigned char adcscan_done(void);
+
+// Average of channels[i] over the last finished round.
+unsigned int adcscan_result(unsigned char i);
+
+#endif
@@ -0,0 +1,22 @@
+# Images turned into headers by ../tools/asset.py, see there. Included by
+# lib.mk and ../sim/Makefile. A project lists the headers it includes in
+# ASSETS and gives each one's flags as a target variable:
+#
+#     ASSETS = digits.hd44780.h
+#     digits.hd44780.h: ASSETFLAGS = --rle --picture 3x2
+#
+# The headers are made from name.pbm or name.png next to them.
+
+ASSET = ../tools/asset.py
+
+%.pcd8544.h: %.pbm $(ASSET)
+	$(ASSET) pcd8544 $(ASSETFLAGS) $< $@
+
+%.pcd8544.h: %.png $(ASSET)
+	$(ASSET) pcd8544 $(ASSETFLAGS) $< $@
+
+%.hd44780.h: %.pbm $(ASSET)
+	$(ASSET) hd44780 $(ASSETFLAGS) $< $@
+
+%.hd44780.h: %.png $(ASSET)
+	$(ASSET) hd44780 $(ASSETFLAGS) $< $@
@@ -0,0 +1,37 @@
+#include "boot.h"
+
+#include <msp430.h>
+
+void boot_run(const boot_step *steps, unsigned char n)
+{
+    // When each step's wait started, and how many ticks it is.
+    unsigned int start[BOOT_STEPS];
+    unsigned int ticks[BOOT_STEPS];
+    unsigned char left = (1 << n) - 1;
+    unsigned char i;
+
+    for(i = 0; i < n; ++i)
+    {
+        start[i] = 0;
+        ticks[i] = 0;
+    }
+
+    while(left)
+    {
+        for(i = 0; i < n; ++i)
+        {
+            unsigned int us;
+
+            // Elapsed ticks wrap around with TAR.
+            if(!(left & (1 << i)) || TAR - start[i] < ticks[i])
+                continue;
+            us = steps[i]();
+            if(!us)
+                left &= ~(1 << i);
+            start[i] = TAR;
+            // TAR was already part way through a tick, one more so the
+            // wait can only be longer.
+            ticks[i] = us / BOOT_TICK_US + 1;
+        }
+    }
+}
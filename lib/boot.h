@@ -0,0 +1,34 @@
+#ifndef BOOT_H_
+#define BOOT_H_
+
+// Boot time initialization as state machines run side by side, so one
+// device's wait (the LCD's 40 ms after power on, the ADC reference
+// settling) is spent on the others instead of in a delay.
+//
+// A step does the next bit of its device's sequence and returns how long
+// to wait, in us, before it is called again, or 0 once it is done.
+// boot_run() calls each step again once its wait is up, until all of
+// them are done:
+//
+//     static const boot_step steps[] = {lcd_init_step, adc_init_step};
+//     TACTL = TASSEL_2 | MC_2 | TACLR; // 1 Mhz, counting continuously.
+//     boot_run(steps, 2);
+//
+// Waits are timed on TAR, which has to count continuously at 1 Mhz
+// (BOOT_TICK_US 1) or at the tick the project sets with -DBOOT_TICK_US.
+// boot_run() polls TAR instead of taking a vector, so it works next to
+// whatever owns the timer's interrupts; the CPU is busy until it returns.
+// A wait has to fit in 65535 ticks.
+
+#ifndef BOOT_TICK_US
+#define BOOT_TICK_US 1
+#endif
+#ifndef BOOT_STEPS
+#define BOOT_STEPS 2 // Most steps boot_run() takes.
+#endif
+
+typedef unsigned int (*boot_step)(void);
+
+void boot_run(const boot_step *steps, unsigned char n);
+
+#endif
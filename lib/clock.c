@@ -0,0 +1,67 @@
+#include "clock.h"
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+unsigned char clock_mhz = CLOCK_1MHZ;
+
+static clock_listener listeners[CLOCK_LISTENERS];
+
+unsigned char clock_listen(clock_listener fn)
+{
+    unsigned char i;
+
+    for(i = 0; i < CLOCK_LISTENERS; ++i)
+    {
+        if(!listeners[i])
+        {
+            listeners[i] = fn;
+            fn(clock_mhz);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+unsigned char clock_set(unsigned char mhz)
+{
+    unsigned char bc1;
+    unsigned char dco;
+    unsigned char i;
+    unsigned int gie;
+
+    switch(mhz)
+    {
+    case CLOCK_1MHZ:
+        bc1 = CALBC1_1MHZ;
+        dco = CALDCO_1MHZ;
+        break;
+    case CLOCK_8MHZ:
+        bc1 = CALBC1_8MHZ;
+        dco = CALDCO_8MHZ;
+        break;
+    case CLOCK_16MHZ:
+        bc1 = CALBC1_16MHZ;
+        dco = CALDCO_16MHZ;
+        break;
+    default:
+        return 0;
+    }
+    if(bc1 == 0xff || dco == 0xff)
+        return 0;
+
+    gie = __read_status_register() & GIE;
+    __dint();
+
+    DCOCTL = 0; // Choose lowest DCO clock and MODx values.
+    BCSCTL1 = bc1;
+    DCOCTL = dco;
+    clock_mhz = mhz;
+
+    for(i = 0; i < CLOCK_LISTENERS && listeners[i]; ++i)
+        listeners[i](mhz);
+
+    if(gie)
+        __eint();
+    return 1;
+}
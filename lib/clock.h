@@ -0,0 +1,32 @@
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+// MCLK and SMCLK from the DCO, switched at runtime between the
+// frequencies calibrated in the TLV. The G2xx1 parts only have 1 Mhz,
+// 16 Mhz needs VCC >= 3.3 V.
+//
+// Drivers whose timing depends on the clock (delays, baud rates, timer
+// periods) register a listener and recompute when it's called.
+
+#define CLOCK_1MHZ  1
+#define CLOCK_8MHZ  8
+#define CLOCK_16MHZ 16
+
+#define CLOCK_LISTENERS 4
+
+typedef void (*clock_listener)(unsigned char mhz);
+
+// Current MCLK in Mhz, 1 before the first clock_set().
+extern unsigned char clock_mhz;
+
+// Calls fn with the current frequency and after every change.
+// Returns 0 if all CLOCK_LISTENERS are taken.
+unsigned char clock_listen(clock_listener fn);
+
+// Switches MCLK and SMCLK to mhz, then calls the listeners with interrupts
+// disabled so ISRs never see the new clock with old divisors.
+// Returns 0, leaving the clock alone, if mhz has no calibration values
+// (erased or not on this part).
+unsigned char clock_set(unsigned char mhz);
+
+#endif
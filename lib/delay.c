@@ -0,0 +1,61 @@
+#include "delay.h"
+
+// MCLK is 1 << delay_shift Mhz.
+unsigned char delay_mhz = 1;
+unsigned char delay_shift = 0;
+
+void delay_clock(unsigned char mhz)
+{
+    delay_mhz = mhz;
+    for(delay_shift = 0; (1 << delay_shift) < mhz; ++delay_shift)
+        ;
+}
+
+// Assumes n > 20.
+// Can be 3 cycles too long, plus 4 cycles per doubling of the clock.
+void delay_us(register unsigned int n)
+{
+    __asm__ __volatile__ (
+        "   mov.b %[shift], r14 \n\t" // 2 + 5 + 3 + 1 + 2 + 2 + 1 + 1
+        "   tst.b r14      \n\t"    // + 4 * k cycles at 1 Mhz.
+        "   jz 2f          \n\t"    // k = (n - 17) / 4
+        "1: rla %[n]       \n\t"    // Cycles are n << delay_shift, the
+        "   dec r14        \n\t"    // shift costs 4 cycles per bit.
+        "   jne 1b         \n\t"
+        "2: sub #17, %[n]  \n\t"    // 2 for moving into %[n] before call.
+                                    // 5 for calling function.
+                                    // 3 for ret from function is not
+                                    // included because division by 4
+                                    // can make the number of cycles 3 short
+                                    // in some cases. It's better to have
+                                    // three more cycles in some cases
+                                    // than come up short.
+        "   rra %[n]       \n\t"
+        "   rra %[n]       \n\t"
+        "3: dec %[n]       \n\t"    // Have to use local labels (numbers).
+        "   nop            \n\t"    // Nop (single cycle, single byte).
+        "   jne 3b           \n"    // Jump backwards.
+        : [n] "+r" (n)
+        : [shift] "m" (delay_shift) // Not &delay_shift in the string,
+        : "r14");                   // LTO can rename the symbol.
+}
+
+// Assumes n > 0.
+// Not exactly n ms because 2 cycles needed to load %[n], 5 cycles to
+// call function, 3 cycles to return from function and 6 cycles per ms.
+void delay_ms(register unsigned int n)
+{
+    __asm__ __volatile__ (
+        "1: mov.b %[mhz], r13 \n\t" // 3 cycles, once per ms.
+        "2: mov #331, r14  \n\t"   // 2 + 3 * 331 + 2 + 1 + 2 = 1000 cycles,
+        "3: dec r14        \n\t"   // delay_mhz times per ms.
+        "   jne 3b         \n\t"   // Have to use local labels (numbers).
+        "   jmp $+2        \n\t"   // Two cycle single byte nop.
+        "   dec r13        \n\t"
+        "   jne 2b         \n\t"
+        "   dec %[n]       \n\t"   // Delay n 1ms cycles.
+        "   jne 1b           \n"   // Jump backwards.
+        : [n] "+r" (n)
+        : [mhz] "m" (delay_mhz)
+        : "r13", "r14");
+}
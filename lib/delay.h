@@ -0,0 +1,20 @@
+#ifndef DELAY_H_
+#define DELAY_H_
+
+// Both delays assume a 1 Mhz clock unless delay_clock() is registered
+// with clock_listen() (see clock.h), then they follow MCLK.
+
+// Assumes n > 20.
+// Assumes n < 4096 at 16 Mhz, n < 8192 at 8 Mhz.
+// Can be 3 cycles too long, plus 4 cycles per doubling of the clock.
+void delay_us(register unsigned int n);
+
+// Assumes n > 0.
+// Not exactly n ms because 2 cycles needed to load %[n], 5 cycles to
+// call function, 3 cycles to return from function and 6 cycles per ms.
+void delay_ms(register unsigned int n);
+
+// Clock listener, mhz is 1, 8 or 16.
+void delay_clock(unsigned char mhz);
+
+#endif
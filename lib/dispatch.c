@@ -0,0 +1,107 @@
+#include "dispatch.h"
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+typedef struct
+{
+    unsigned char mask;
+    unsigned char priority;
+    dispatch_port1_fn fn;
+} port1_handler;
+
+// Sorted by priority, registration order within one.
+static port1_handler port1[DISPATCH_PORT1_HANDLERS];
+static unsigned char port1_count;
+
+static unsigned char timer_none(void)
+{
+    return 0;
+}
+
+// Indexed by TAIV / 2, TACCR0 in the unused slot 0. Sources nobody
+// registered call timer_none(), so the ISRs needn't check.
+static dispatch_timer_fn timer[DISPATCH_TAIFG + 1] = {
+    timer_none, timer_none, timer_none, timer_none, timer_none, timer_none
+};
+
+unsigned char dispatch_port1(unsigned char mask, unsigned char priority,
+                             dispatch_port1_fn fn)
+{
+    unsigned char i;
+
+    if(port1_count == DISPATCH_PORT1_HANDLERS)
+        return 0;
+
+    // Insertion sort, registering is rare and the ISR only walks it.
+    for(i = port1_count; i && port1[i - 1].priority > priority; --i)
+        port1[i] = port1[i - 1];
+    port1[i].mask = mask;
+    port1[i].priority = priority;
+    port1[i].fn = fn;
+    port1_count++;
+    return 1;
+}
+
+void dispatch_timer(unsigned char source, dispatch_timer_fn fn)
+{
+    timer[source] = fn;
+}
+
+// TACCR0's handler, if its compare is due. The port 1 and TAIV ISRs call
+// this on entry and between their steps: before each table entry and at
+// the end, after each TAIV handler. A sampler on TACCR0 then waits for
+// one handler at most, not a whole ISR. Clearing CCIFG takes the request
+// back.
+static inline unsigned char taccr0_due(void)
+{
+    if((TACCTL0 & (CCIE | CCIFG)) != (CCIE | CCIFG))
+        return 0;
+    TACCTL0 &= ~CCIFG;
+    return timer[DISPATCH_TACCR0]();
+}
+
+static void __attribute__ ((__interrupt__(PORT1_VECTOR))) dispatch_pins(void)
+{
+    unsigned char wake = taccr0_due();
+    unsigned char pending = P1IFG & P1IE;
+    unsigned char i;
+
+    P1IFG &= ~pending;
+    for(i = 0; i < port1_count; ++i)
+    {
+        unsigned char pins = pending & port1[i].mask;
+        wake |= taccr0_due();
+        if(pins)
+            wake |= port1[i].fn(pins);
+    }
+    wake |= taccr0_due();
+
+    if(wake)
+        __bic_status_register_on_exit(LPM0_bits);
+}
+
+// CCIFG is reset when the interrupt is taken.
+static void __attribute__ ((__interrupt__(TIMER0_A0_VECTOR)))
+dispatch_taccr0(void)
+{
+    if(timer[DISPATCH_TACCR0]())
+        __bic_status_register_on_exit(LPM0_bits);
+}
+
+// Reading TAIV resets the flag it returns.
+static void __attribute__ ((__interrupt__(TIMER0_A1_VECTOR)))
+dispatch_taiv(void)
+{
+    unsigned int iv;
+    unsigned char wake = taccr0_due();
+
+    while((iv = TAIV))
+    {
+        wake |= timer[iv >> 1]();
+        wake |= taccr0_due();
+    }
+
+    if(wake)
+        __bic_status_register_on_exit(LPM0_bits);
+}
@@ -0,0 +1,61 @@
+#ifndef DISPATCH_H_
+#define DISPATCH_H_
+
+// Port 1 and Timer_A interrupts shared by several tasks in one image.
+//
+// dispatch.c owns PORT1_VECTOR, TIMER0_A0_VECTOR and TIMER0_A1_VECTOR, so
+// a project linking it declares none of those ISRs itself. Each task
+// registers handlers for its pins and timer sources instead, before
+// interrupts are enabled:
+//
+//     dispatch_port1(IR_SENSOR, 0, ir_edge);   // Runs before button().
+//     dispatch_port1(BUTTON, 1, button);
+//     dispatch_timer(DISPATCH_TACCR0, sample);
+//     dispatch_timer(DISPATCH_TACCR1, debounce);
+//
+// The port 1 ISR reads P1IFG & P1IE once, clears those flags and calls
+// every handler with one of them among its pins, lowest priority number
+// first, with the ones it got. Flags set in the meantime run the ISR
+// again. TACCR0 has a vector of its own and one handler, called straight
+// from it. TACCR1, TACCR2 and the overflow are read from TAIV until it is
+// 0, which gives them in that order.
+//
+// TACCR0 comes first: the port 1 and TAIV ISRs poll its compare on entry
+// and between handlers and run its handler as soon as it is due. It
+// waits for one other handler at most, which keeps 100 kHz sampling at
+// 8 Mhz within its 80 cycles as long as the other handlers are short.
+//
+// A handler returns DISPATCH_WAKE to have main() woken from LPM0 when the
+// ISR exits, 0 to let it sleep on.
+//
+// Dispatch costs every handler the ISR's register reads and a call
+// through the table. sim/targets/bench_dispatch.c measures the latency to
+// the handler and the 100 kHz sampling deadline on the simulator.
+
+#ifndef DISPATCH_PORT1_HANDLERS
+#define DISPATCH_PORT1_HANDLERS 4
+#endif
+
+#define DISPATCH_WAKE 1
+
+// Timer sources, TAIV / 2 for all but TACCR0.
+#define DISPATCH_TACCR0 0
+#define DISPATCH_TACCR1 1
+#define DISPATCH_TACCR2 2
+#define DISPATCH_TAIFG  5
+
+// pins are the flags that brought it in, already cleared.
+typedef unsigned char (*dispatch_port1_fn)(unsigned char pins);
+typedef unsigned char (*dispatch_timer_fn)(void);
+
+// fn for the pins in mask, after the handlers with a lower or the same
+// priority number. Returns 0 if all DISPATCH_PORT1_HANDLERS are taken.
+unsigned char dispatch_port1(unsigned char mask, unsigned char priority,
+                             dispatch_port1_fn fn);
+
+// fn for a DISPATCH_TACCRx or DISPATCH_TAIFG source, replacing the one
+// there was. The caller enables the interrupt (CCIE, TAIE) itself. An
+// enabled source with no fn is acknowledged and ignored.
+void dispatch_timer(unsigned char source, dispatch_timer_fn fn);
+
+#endif
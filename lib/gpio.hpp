@@ -0,0 +1,217 @@
+#ifndef GPIO_HPP_
+#define GPIO_HPP_
+
+#include <msp430.h>
+
+// Compile time GPIO for C++ (msp430-g++ -std=gnu++0x).
+//
+// Pins are types, so masks are constants and every call inlines to the
+// bis.b/bic.b/xor.b/bit.b on an absolute address the equivalent macro
+// gives. The registers come from <msp430.h>, so building against
+// sim/include runs the same code in the simulator.
+//
+//     typedef Pin<Port1, 4> LcdE;
+//     typedef Bus4<Pin<Port1, 0>, Pin<Port1, 1>,
+//                  Pin<Port1, 2>, Pin<Port1, 3> > LcdData;
+//     typedef PinGroup<LcdE, LcdRs, LcdData> LcdPins;
+//
+//     LcdPins::output();   // One bis.b for all six pins.
+//     LcdData::write(n);   // bic.b + bis.b, like LCD_OUT &= 0xf0 ...
+//
+// PinMap<...> fails to compile if two entries use the same pin. Pins that
+// are shared on purpose (see pinshare.h) are wrapped in Shared<> and may
+// only overlap other Shared<> pins.
+
+struct Port1
+{
+    static const unsigned char id = 1;
+    static volatile unsigned char &in() { return P1IN; }
+    static volatile unsigned char &out() { return P1OUT; }
+    static volatile unsigned char &dir() { return P1DIR; }
+    static volatile unsigned char &ifg() { return P1IFG; }
+    static volatile unsigned char &ies() { return P1IES; }
+    static volatile unsigned char &ie() { return P1IE; }
+    static volatile unsigned char &sel() { return P1SEL; }
+    static volatile unsigned char &ren() { return P1REN; }
+};
+
+struct Port2
+{
+    static const unsigned char id = 2;
+    static volatile unsigned char &in() { return P2IN; }
+    static volatile unsigned char &out() { return P2OUT; }
+    static volatile unsigned char &dir() { return P2DIR; }
+    static volatile unsigned char &ifg() { return P2IFG; }
+    static volatile unsigned char &ies() { return P2IES; }
+    static volatile unsigned char &ie() { return P2IE; }
+    static volatile unsigned char &sel() { return P2SEL; }
+    static volatile unsigned char &ren() { return P2REN; }
+};
+
+// Operations on all pins in Mask at once.
+template <class Port, unsigned char Mask>
+struct PortBits
+{
+    typedef Port port;
+    static const unsigned char mask = Mask;
+    static const unsigned char shared_mask = 0;
+
+    static void set() { Port::out() |= Mask; }
+    static void clear() { Port::out() &= (unsigned char)~Mask; }
+    static void toggle() { Port::out() ^= Mask; }
+    static unsigned char read() { return Port::in() & Mask; }
+
+    static void output() { Port::dir() |= Mask; }
+    static void input() { Port::dir() &= (unsigned char)~Mask; }
+    static void peripheral() { Port::sel() |= Mask; }
+    static void pullup()
+    {
+        Port::out() |= Mask;
+        Port::ren() |= Mask;
+    }
+    static void pulldown()
+    {
+        Port::out() &= (unsigned char)~Mask;
+        Port::ren() |= Mask;
+    }
+    static void nopull() { Port::ren() &= (unsigned char)~Mask; }
+
+    // Pin interrupts.
+    static void falling() { Port::ies() |= Mask; }
+    static void rising() { Port::ies() &= (unsigned char)~Mask; }
+    static void enable() { Port::ie() |= Mask; }
+    static void disable() { Port::ie() &= (unsigned char)~Mask; }
+    static void acknowledge() { Port::ifg() &= (unsigned char)~Mask; }
+    static unsigned char pending() { return Port::ifg() & Mask; }
+};
+
+template <class Port, unsigned char Bit>
+struct Pin : PortBits<Port, (1 << Bit)>
+{
+    static_assert(Bit < 8, "pin number out of range");
+    static const unsigned char bit = Bit;
+
+    static void write(bool level)
+    {
+        if(level)
+            Port::out() |= (1 << Bit);
+        else
+            Port::out() &= (unsigned char)~(1 << Bit);
+    }
+};
+
+// A pin (or group) deliberately used by more than one driver.
+template <class P>
+struct Shared : P
+{
+    static const unsigned char shared_mask = P::mask;
+};
+
+// Masks of a list of pins or groups, per port.
+template <class... List>
+struct PinList;
+
+template <>
+struct PinList<>
+{
+    template <class Port>
+    struct on
+    {
+        static const unsigned char mask = 0;
+        static const unsigned char shared_mask = 0;
+        static const bool all = true;
+    };
+    static const bool disjoint = true;
+};
+
+template <class P, class... Rest>
+struct PinList<P, Rest...>
+{
+    template <class Port>
+    struct on
+    {
+        static const bool here = P::port::id == Port::id;
+        static const unsigned char mask = (here ? P::mask : 0) |
+            PinList<Rest...>::template on<Port>::mask;
+        static const unsigned char shared_mask =
+            (here ? P::shared_mask : 0) |
+            PinList<Rest...>::template on<Port>::shared_mask;
+        // Every entry is on Port.
+        static const bool all = here && PinList<Rest...>::template
+                                            on<Port>::all;
+    };
+
+    typedef typename PinList<Rest...>::template on<typename P::port> after;
+
+    // P overlaps nothing after it, except where both sides are shared.
+    static const bool disjoint = PinList<Rest...>::disjoint &&
+        !(P::mask & after::mask & ~(P::shared_mask & after::shared_mask));
+};
+
+// Pins (or groups) on one port, driven together.
+template <class First, class... Rest>
+struct PinGroup : PortBits<typename First::port,
+                           PinList<First, Rest...>::template
+                               on<typename First::port>::mask>
+{
+    static_assert(PinList<First, Rest...>::template
+                      on<typename First::port>::all,
+                  "PinGroup pins must be on one port");
+    static_assert(PinList<First, Rest...>::disjoint,
+                  "pin used twice in PinGroup");
+    static const unsigned char shared_mask = PinList<First, Rest...>::
+        template on<typename First::port>::shared_mask;
+};
+
+// Four pins on one port as a nibble, D0 lowest. Written like the macros
+// (clear then set), so the lines pass through 0 between the two
+// instructions; assign() does a single mov.b for lines that must not.
+template <class D0, class D1, class D2, class D3>
+struct Bus4 : PinGroup<D0, D1, D2, D3>
+{
+    typedef typename D0::port port;
+    static const unsigned char mask = PinGroup<D0, D1, D2, D3>::mask;
+    static const bool consecutive = D1::bit == D0::bit + 1 &&
+        D2::bit == D0::bit + 2 && D3::bit == D0::bit + 3;
+
+    // Assumes v <= 0xf. Folds to a shift (or nothing) for consecutive pins.
+    static unsigned char spread(unsigned char v)
+    {
+        if(consecutive)
+            return v << D0::bit;
+        return ((v & 1) ? D0::mask : 0) | ((v & 2) ? D1::mask : 0) |
+               ((v & 4) ? D2::mask : 0) | ((v & 8) ? D3::mask : 0);
+    }
+
+    static void write(unsigned char v)
+    {
+        port::out() &= (unsigned char)~mask;
+        port::out() |= spread(v);
+    }
+
+    static void assign(unsigned char v)
+    {
+        port::out() = (port::out() & (unsigned char)~mask) | spread(v);
+    }
+
+    static unsigned char read()
+    {
+        unsigned char in = port::in();
+        if(consecutive)
+            return (in & mask) >> D0::bit;
+        return ((in & D0::mask) ? 1 : 0) | ((in & D1::mask) ? 2 : 0) |
+               ((in & D2::mask) ? 4 : 0) | ((in & D3::mask) ? 8 : 0);
+    }
+};
+
+// The pin assignment of a project, checked when instantiated:
+//
+//     static_assert(PinMap<LcdPins, Shared<Button> >::ok, "");
+template <class... Entries>
+struct PinMap
+{
+    static_assert(PinList<Entries...>::disjoint, "pin conflict in PinMap");
+    static const bool ok = PinList<Entries...>::disjoint;
+};
+
+#endif
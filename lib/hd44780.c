@@ -0,0 +1,123 @@
+#include "hd44780.h"
+
+#include "delay.h"
+
+// Initialization sequence for 4-bit access from HD44780 datasheet:
+// single nibbles with the wait after each, then instructions.
+static const unsigned char init_nibbles[] = {0x3, 0x3, 0x3, 0x2};
+static const unsigned int init_nibble_us[] = {5000, 200, 37, 37};
+static const unsigned char init_instructions[] = {
+    0x28, 0x08, 0x01, 0x06,
+    0x0c, // Display on, cursor off, blinking off.
+    0x02, // Go home.
+};
+static unsigned char init_state = 0;
+
+unsigned int lcd_init_sequence(unsigned char *state, lcd_nibble_writer write)
+{
+    unsigned char i = *state;
+    unsigned char inst;
+
+    if(!i)
+    {
+        ++*state;
+        return 50000; // Power on.
+    }
+    if(--i < sizeof(init_nibbles))
+    {
+        if(!write(init_nibbles[i]))
+            return LCD_INIT_RETRY_US;
+        ++*state;
+        return init_nibble_us[i];
+    }
+
+    // Instructions a nibble at a time, high one first. The low one
+    // follows straight away.
+    i -= sizeof(init_nibbles);
+    while(i < 2 * sizeof(init_instructions))
+    {
+        inst = init_instructions[i >> 1];
+        if(!write(i & 1 ? inst & 0x0f : inst >> 4))
+            return LCD_INIT_RETRY_US;
+        ++*state;
+        if(i++ & 1)
+            // Clear and home take longer than other instructions.
+            return inst < 0x04 ? 1520 : 37;
+    }
+    // From the start next time.
+    *state = 0;
+    return 0;
+}
+
+static unsigned char init_write(unsigned char data)
+{
+    lcd_write_nibble(data);
+    return 1;
+}
+
+unsigned int lcd_init_step(void)
+{
+    if(!init_state)
+    {
+        LCD_DIR |= (LCD_RS | LCD_E | 0x0f);
+        LCD_SET_INSTRUCTION();
+    }
+    return lcd_init_sequence(&init_state, init_write);
+}
+
+void lcd_initialize(void)
+{
+    unsigned int us;
+
+    while((us = lcd_init_step()))
+    {
+        if(us >= 1000)
+            delay_ms(us / 1000);
+        // The rest is 0 or over 20 us for every wait above.
+        if(us % 1000)
+            delay_us(us % 1000);
+    }
+}
+
+// Write a byte to HD44780.
+void lcd_write_byte(unsigned char data)
+{
+    lcd_write_nibble(data >> 4);
+    lcd_write_nibble(data & 0x0f);
+}
+
+// Assume data <= 0xf.
+// Data is latched on the falling edge of E, which only has to be 450 ns
+// long. The second nibble of a byte can follow straight away, the
+// instruction's wait comes after it.
+void lcd_write_nibble(unsigned char data)
+{
+    LCD_OUT &= 0xf0;
+    LCD_OUT |= data;
+    LCD_OUT |= LCD_E;
+    LCD_OUT &= ~LCD_E;
+}
+
+// Use LCD_SET_INSTRUCTION() first.
+void lcd_send_instruction(unsigned char inst)
+{
+    lcd_write_byte(inst);
+    delay_us(37);
+}
+
+// Use LCD_SET_DATA() first.
+void lcd_send_data(unsigned char data)
+{
+    lcd_write_byte(data);
+    delay_us(41);
+}
+
+// First bit tells which row.
+void lcd_goto(unsigned char loc)
+{
+    LCD_SET_INSTRUCTION();
+    if(loc & 0x80)
+        lcd_send_instruction(0x80 | (0x40 + loc));
+    else
+        lcd_send_instruction(0x80 | loc);
+}
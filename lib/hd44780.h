@@ -0,0 +1,36 @@
+#ifndef HD44780_H_
+#define HD44780_H_
+
+#include <msp430.h>
+
+// HD44780 in 4-bit mode. D4..D7 on P1.0..P1.3, RW tied to GND.
+#define LCD_DIR P1DIR
+#define LCD_OUT P1OUT
+#define LCD_RS  (1 << 5)
+#define LCD_E   (1 << 4)
+
+#define LCD_SET_INSTRUCTION() LCD_OUT &= ~LCD_RS
+#define LCD_SET_DATA()        LCD_OUT |= LCD_RS
+
+// Initialization sequence, blocking.
+void lcd_initialize(void);
+// The same as a step for boot_run() (boot.h): returns the us to wait
+// before the next call, 0 when done.
+unsigned int lcd_init_step(void);
+
+// Writes a nibble (data <= 0xf), 0 if it could not and has to be tried
+// again later.
+typedef unsigned char (*lcd_nibble_writer)(unsigned char data);
+#define LCD_INIT_RETRY_US 1000
+// The sequence behind lcd_init_step() for drivers that write the nibbles
+// themselves. *state starts at 0, where the caller sets up the pins, and
+// is back at 0 when done. A write that fails is tried again after
+// LCD_INIT_RETRY_US.
+unsigned int lcd_init_sequence(unsigned char *state, lcd_nibble_writer write);
+void lcd_write_nibble(unsigned char data);
+void lcd_write_byte(unsigned char data);
+void lcd_send_instruction(unsigned char inst);
+void lcd_send_data(unsigned char inst);
+void lcd_goto(unsigned char loc);
+
+#endif
@@ -0,0 +1,141 @@
+#include "irtx.h"
+
+#include <msp430.h>
+
+#include "clock.h"
+#include "delay.h"
+
+static unsigned int saved_tactl;
+static unsigned int saved_tacctl0;
+
+// delay_us() takes at most 4096 us at 16 Mhz.
+static void wait(unsigned int us)
+{
+    while(us > 4000)
+    {
+        delay_us(4000);
+        us -= 4000;
+    }
+    if(us > 20)
+        delay_us(us);
+}
+
+static void carrier_on(void)
+{
+    // Output high right away and TAR from 0, so the first carrier cycle
+    // is a whole one. Reset/set then takes over from the high level.
+    TACCTL1 = OUTMOD_0 | OUT;
+    TACTL |= TACLR;
+    TACCTL1 = OUTMOD_7;
+}
+
+static void carrier_off(void)
+{
+    TACCTL1 = OUTMOD_0;
+}
+
+void irtx_start(void)
+{
+    unsigned int period = (clock_mhz * 1000U + IRTX_KHZ / 2) / IRTX_KHZ;
+
+    saved_tactl = TACTL;
+    saved_tacctl0 = TACCTL0;
+    TACCTL0 &= ~CCIE;
+
+    TACCTL1 = OUTMOD_0;
+    TACCR0 = period - 1;
+    TACCR1 = period / 3;
+    TACTL = TASSEL_2 | MC_1 | TACLR;
+
+    P1DIR |= IRTX_PIN;
+    P1SEL |= IRTX_PIN;
+}
+
+void irtx_stop(void)
+{
+    carrier_off();
+    P1SEL &= ~IRTX_PIN;
+    P1OUT &= ~IRTX_PIN;
+
+    TACCR0 = 0;
+    TACTL = saved_tactl;
+    TACCTL0 = saved_tacctl0;
+}
+
+void irtx_mark(unsigned int us)
+{
+    carrier_on();
+    wait(us);
+}
+
+void irtx_space(unsigned int us)
+{
+    carrier_off();
+    wait(us);
+}
+
+void irtx_send(const irtx_protocol *p, unsigned long code,
+               unsigned char bits)
+{
+    if(p->leader_mark)
+    {
+        irtx_mark(p->leader_mark);
+        irtx_space(p->leader_space);
+    }
+    while(bits--)
+    {
+        if(code & 1)
+        {
+            irtx_mark(p->mark_1);
+            irtx_space(p->space_1);
+        }
+        else
+        {
+            irtx_mark(p->mark_0);
+            irtx_space(p->space_0);
+        }
+        code >>= 1;
+    }
+    // The last space of a pulse distance code needs a mark to end it.
+    if(p->mark_0 == p->mark_1)
+        irtx_mark(p->mark_0);
+    carrier_off();
+}
+
+void irtx_replay(const volatile unsigned char *samples, unsigned int n,
+                 unsigned char sample_us)
+{
+    unsigned int i = 0;
+
+    while(i < n)
+    {
+        unsigned int start = i;
+        unsigned char level = samples[i >> 3] >> (i & 7) & 1;
+        // Whole bytes at the same level at once.
+        unsigned char same = level ? 0xff : 0x00;
+
+        if(level)
+            carrier_off();
+        else
+            carrier_on();
+
+        while(i < n)
+        {
+            unsigned char b = samples[i >> 3];
+            if(!(i & 7) && b == same && i + 8 <= n)
+            {
+                i += 8;
+                continue;
+            }
+            if((b >> (i & 7) & 1) != level)
+                break;
+            ++i;
+        }
+
+        // Nothing to end the last space.
+        if(i == n && level)
+            break;
+        wait((i - start) * sample_us);
+    }
+    carrier_off();
+}
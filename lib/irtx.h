@@ -0,0 +1,59 @@
+#ifndef IRTX_H_
+#define IRTX_H_
+
+// IR transmitter.
+//
+// The carrier is hardware PWM from Timer_A output 1 (TA0.1 on P1.6, an
+// IR LED driver in place of or next to LED2): up mode with TACCR0 as the
+// carrier period and reset/set at 1/3 duty. A mark switches the output
+// unit to reset/set, a space to OUT = 0, so the CPU only touches the
+// timer at envelope edges. In between it waits with delay_us(), which has
+// to be following MCLK (delay_clock() registered with clock_listen()).
+//
+//     irtx_start();
+//     irtx_send(&nec, 0xbf40ff00, 32);
+//     irtx_stop();
+//
+// irtx_start() takes over Timer_A and masks the TACCR0 interrupt,
+// irtx_stop() puts TACTL and TACCTL0 back and leaves the timer stopped.
+// SMCLK has to be clock_mhz (DIVS_0). Interrupts that take long stretch
+// the mark or space they hit.
+
+#ifndef IRTX_KHZ
+#define IRTX_KHZ 38
+#endif
+#define IRTX_PIN BIT6
+
+// Times in us, at least 30 (the carrier is about 26 us at 38 kHz).
+// Pulse distance codes (NEC) have mark_0 == mark_1 and get a final mark
+// after the last bit, pulse width codes (Sony) have space_0 == space_1.
+typedef struct
+{
+    unsigned int leader_mark; // 0 for no leader.
+    unsigned int leader_space;
+    unsigned int mark_0;
+    unsigned int mark_1;
+    unsigned int space_0;
+    unsigned int space_1;
+} irtx_protocol;
+
+void irtx_start(void);
+void irtx_stop(void);
+
+// Carrier on (mark) or off (space) for us.
+void irtx_mark(unsigned int us);
+void irtx_space(unsigned int us);
+
+// Sends the low bits of code, bit 0 first.
+void irtx_send(const irtx_protocol *p, unsigned long code,
+               unsigned char bits);
+
+// Replays n samples taken sample_us apart, packed LSB first with 0 for
+// a mark (the receiver's active low output, as remote captures them).
+// A space at the end isn't sent. Finding where each run ends is done
+// while it's being sent and adds about 1 us per sample byte at 8 Mhz to
+// it, 1% on long runs.
+void irtx_replay(const volatile unsigned char *samples, unsigned int n,
+                 unsigned char sample_us);
+
+#endif
@@ -0,0 +1,92 @@
+#include "lcdqueue.h"
+
+#include <msp430.h>
+
+#include "delay.h"
+#include "hd44780.h"
+#include "ring.h"
+
+RING_DECLARE(lcdq_ring, unsigned int, LCDQ_SIZE)
+static lcdq_ring queue;
+// Transaction being sent and how many of its nibbles are left.
+static unsigned int current;
+static unsigned char nibbles = 0;
+
+pinshare lcdq_d7 = {LCDQ_D7};
+
+// Assume data <= 0xf.
+// Returns 0 without writing anything while the button holds D7.
+static unsigned char write_nibble(unsigned char data)
+{
+    if(!pinshare_claim(&lcdq_d7))
+        return 0;
+    LCD_OUT &= 0xf0;
+    LCD_OUT |= data;
+    // Data is latched on the falling edge of E. The pulse only has to be
+    // 450 ns long, so D7 is only driven for a few cycles.
+    LCD_OUT |= LCD_E;
+    LCD_OUT &= ~LCD_E;
+    pinshare_release(&lcdq_d7);
+    return 1;
+}
+
+// 0 before power on, then every nibble sent.
+static unsigned char init_state = 0;
+
+// D7 is switched by the pin arbiter. While the button holds it the same
+// nibble is tried again a millisecond later.
+unsigned int lcdq_init_step(void)
+{
+    if(!init_state)
+    {
+        LCD_DIR |= (LCD_RS | LCD_E | 0x07);
+        LCD_SET_INSTRUCTION();
+    }
+    return lcd_init_sequence(&init_state, write_nibble);
+}
+
+unsigned char lcdq_put(unsigned int t)
+{
+    return lcdq_ring_put(&queue, t);
+}
+
+unsigned char lcdq_idle(void)
+{
+    return !nibbles && lcdq_ring_empty(&queue);
+}
+
+// Bit 8 of a transaction selects data (LCDQ_DATA) or instruction.
+void lcdq_flush(void)
+{
+    while(1)
+    {
+        if(!nibbles)
+        {
+            if(!lcdq_ring_get(&queue, &current))
+                return;
+            nibbles = 2;
+        }
+
+        unsigned int t = current;
+
+        if(t & LCDQ_DATA)
+            LCD_SET_DATA();
+        else
+            LCD_SET_INSTRUCTION();
+
+        // Same nibble is sent again on the next call if this fails.
+        if(!write_nibble(nibbles == 2 ? ((t >> 4) & 0x0f) : (t & 0x0f)))
+            return;
+
+        if(!--nibbles)
+        {
+            // Clear and home take longer than other instructions.
+            if(t & LCDQ_DATA)
+                delay_us(41);
+            else if(t < 0x04)
+                delay_us(1520);
+            else
+                delay_us(37);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef LCDQUEUE_H_
+#define LCDQUEUE_H_
+
+#include "pinshare.h"
+
+// HD44780 writes queued and sent a nibble at a time, for a board where
+// the button (S2 on P1.3) is also LCD D7. Wired like hd44780.h; see
+// pinshare.h for how the pin changes hands.
+//
+// A transaction is an instruction, or a character with LCDQ_DATA set.
+// lcdq_flush() sends them from main() while the button isn't holding D7
+// and waits them out with delays. The button's ISR keeps lcdq_d7.held up
+// to date (pinshare_set_held()) and ignores edges while lcdq_d7.role is
+// PINSHARE_OUTPUT.
+//
+//     static const boot_step steps[] = {lcdq_init_step};
+//     pinshare_init(&lcdq_d7);
+//     boot_run(steps, 1);            // See boot.h.
+//     lcdq_put(0x80 | 3);            // Fourth column of the first line.
+//     lcdq_put(LCDQ_DATA | '7');
+//     lcdq_flush();                  // Stops early while the button is
+//                                    // down, call again after.
+
+#ifndef LCDQ_SIZE
+#define LCDQ_SIZE 16 // Power of two.
+#endif
+#define LCDQ_DATA 0x100 // Send with RS set.
+
+#define LCDQ_D7 (1 << 3)
+
+extern pinshare lcdq_d7;
+
+// Initialization sequence as a step for boot_run() (boot.h): returns the
+// us to wait before the next call, 0 when done. Needs lcdq_d7 set up.
+unsigned int lcdq_init_step(void);
+
+// Returns 0 if the queue is full.
+unsigned char lcdq_put(unsigned int t);
+
+// Sends until the queue is empty or the button holds D7.
+void lcdq_flush(void);
+
+// Nothing queued or half sent.
+unsigned char lcdq_idle(void);
+
+#endif
@@ -0,0 +1,116 @@
+# Build rules shared by the projects. A project Makefile sets
+#
+#     TARGET   name of the elf
+#     MCU      msp430g2231, msp430g2452, ...
+#     SRC      its own sources
+#     LIBSRC   the drivers from this directory it uses (../lib/delay.c ...)
+#     LIBFLAGS the -D settings for the drivers (-DADCSCAN_CHANNELS=2 ...),
+#              its own sources see them too
+#     ASSETS   headers it includes that are made from images (asset.mk)
+#
+# and then includes ../lib/lib.mk. The drivers take their pins and sizes
+# from LIBFLAGS and the chip from MCU, so they are compiled once for each
+# MCU, OPT, LTO and LIBFLAGS into an archive in ../lib/build/, which every
+# project with the same settings links. The linker only takes the drivers
+# a project calls.
+#
+# The sources and the archive's objects are built with -flto: the
+# drivers' per byte paths (display_send_byte, lcd_send_data, ...) can
+# inline into their callers at the link, and -ffunction-sections with
+# --gc-sections drops the functions nothing calls. The archive is made
+# with gcc-ar so the linker sees the LTO objects in it.
+#
+#     make               $(TARGET).elf
+#     make LTO=0         the build without LTO, each file compiled on its own
+#     make lto-compare   both builds (the LTO=0 one into nolto/) and
+#                        ../tools/build_compare.py on them
+#     make STACK_USAGE=1 also writes gcc's .su frame sizes for
+#                        ../tools/size_report.py, see below
+#     make libdir        prints the archive's directory
+
+TOOLCHAIN ?= msp430
+CC = $(TOOLCHAIN)-gcc
+CXX = $(TOOLCHAIN)-g++
+OD = $(TOOLCHAIN)-objdump
+SIZE = $(TOOLCHAIN)-size
+AR = $(TOOLCHAIN)-gcc-ar
+FLASHER = mspdebug
+FLASHER_DRIVER ?= rf2500
+
+OPT ?= -Os
+ODFLAGS ?= -D
+LTO ?= 1
+# Output prefix, nolto/ for the comparison build.
+OUT ?=
+
+LIBCFLAGS = -Wall $(OPT) -g -mmcu=$(MCU) -I../lib $(LIBFLAGS)
+ifneq ($(LTO),0)
+LIBCFLAGS += -flto -ffunction-sections -fdata-sections
+LDFLAGS += -Wl,--gc-sections
+endif
+# -fstack-usage writes a .su next to each object. With LTO the code is
+# generated at the link, which would leave its .su files in a temporary
+# directory: -dumpdir puts them in the project's, named after the elf.
+ifdef STACK_USAGE
+LIBCFLAGS += -fstack-usage
+LDFLAGS += -dumpdir $(CURDIR)/$(basename $@).
+endif
+CFLAGS += $(LIBCFLAGS)
+
+# One archive per driver configuration, named by the chip and a checksum
+# of the rest.
+LIBKEY := $(shell printf '%s' "$(OPT) $(LTO) $(LIBFLAGS)" | cksum | \
+                  cut -d' ' -f1)
+LIBDIR = ../lib/build/$(MCU)-$(LIBKEY)
+LIBA = $(LIBDIR)/libdrivers.a
+LIBOBJ = $(patsubst ../lib/%.c,$(LIBDIR)/%.o,$(LIBSRC))
+
+# The elf program flashes, a project with several sets it and EXTRA_ELFS.
+ELF ?= $(OUT)$(TARGET).elf
+ELFS = $(OUT)$(TARGET).elf $(EXTRA_ELFS)
+
+compile: $(ELFS)
+
+$(OUT)$(TARGET).elf: $(SRC) $(LIBA) $(ASSETS)
+	@mkdir -p $(dir $@)
+	$(CC) $(CFLAGS) $(LDFLAGS) $(SRC) $(LIBA) -o $@
+
+$(LIBDIR)/%.o: ../lib/%.c $(wildcard ../lib/*.h)
+	@mkdir -p $(dir $@)
+	$(CC) $(LIBCFLAGS) -c $< -o $@
+
+# Another project may have put other drivers in already, only the new
+# and rebuilt ones are added.
+$(LIBA): $(LIBOBJ)
+	$(AR) rcs $@ $?
+
+# LTO objects hold GIMPLE, not assembly.
+assemble: $(SRC) $(ASSETS)
+	$(CC) $(CFLAGS) -fno-lto -S $(SRC)
+
+listing: $(ELFS)
+	for f in $(ELFS:.elf=); do $(OD) $(ODFLAGS) $$f.elf > $$f.lst; done
+
+size: $(ELFS)
+	$(SIZE) $(ELFS)
+
+program: $(ELF)
+	$(FLASHER) $(FLASHER_DRIVER) 'prog $(ELF)'
+
+lto-builds:
+	$(MAKE) -B LTO=0 OUT=nolto/ compile
+	$(MAKE) -B compile
+
+lto-compare: lto-builds
+	../tools/build_compare.py $(notdir $(CURDIR))
+
+libdir:
+	@echo $(LIBDIR)
+
+clean:
+	rm -rf $(ELFS) $(ELFS:.elf=.lst) $(ASSETS) *.s *.o *.su nolto
+
+include ../lib/asset.mk
+
+.PHONY: compile assemble listing size program lto-builds lto-compare libdir \
+        clean
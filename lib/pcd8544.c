@@ -1,4 +1,4 @@
-#include "display.h"
+#include "pcd8544.h"
 
 #include "spi.h"
 
@@ -48,11 +48,13 @@ void display_clear(void)
     // Set x, y.
     display_goto(0, 0);
 
-    // Clear everything.
+    // Clear everything, two bytes per shift with SCE held low.
     DISPLAY_SET_DATA();
+    DISPLAY_START_TRANSMIT();
     unsigned int i = 0;
-    while(i++ < 6 * 84)
-        display_send_byte(0x00);
+    while(i++ < 6 * 84 / 2)
+        spi_send_word(0x0000);
+    DISPLAY_END_TRANSMIT();
 }
 
 void display_send_byte(unsigned char byte)
@@ -63,3 +65,12 @@ void display_send_byte(unsigned char byte)
 
     DISPLAY_END_TRANSMIT();
 }
+
+void display_send_bytes(const unsigned char *bytes, unsigned int n)
+{
+    DISPLAY_START_TRANSMIT();
+
+    spi_send_burst(bytes, n);
+
+    DISPLAY_END_TRANSMIT();
+}
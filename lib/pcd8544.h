@@ -0,0 +1,35 @@
+#ifndef PCD8544_H_
+#define PCD8544_H_
+
+// Nokia 5110 (PCD8544) display on the USI in SPI mode, see spi.h.
+
+#define DISPLAY_DIR  P1DIR
+#define DISPLAY_OUT  P1OUT
+
+#define _(x)         (1 << x)
+
+#define DISPLAY_RES   _(1)
+#define DISPLAY_SCE   _(2)
+#define DISPLAY_MODE  _(4)
+#define DISPLAY_SCLK  _(5)
+#define DISPLAY_SDOUT _(6)
+#define DISPLAY_SDIN  _(7)
+
+#define DISPLAY_SET_DATA() DISPLAY_OUT |= DISPLAY_MODE
+#define DISPLAY_SET_CMD() DISPLAY_OUT &= ~DISPLAY_MODE
+
+#define DISPLAY_GOTO_COL(col) display_send_byte(0x80 | (col))
+#define DISPLAY_GOTO_ROW(row) display_send_byte(0x40 | (row))
+
+#define DISPLAY_START_TRANSMIT() DISPLAY_OUT &= ~DISPLAY_SCE
+#define DISPLAY_END_TRANSMIT() DISPLAY_OUT |= DISPLAY_SCE
+
+void display_init(void);
+void display_goto(unsigned char row, unsigned char col);
+void display_clear(void);
+void display_send_byte(unsigned char byte);
+// Data bytes from the current address, two per shift with SCE held low,
+// back to back (spi_send_burst()). DISPLAY_SET_DATA() first.
+void display_send_bytes(const unsigned char *bytes, unsigned int n);
+
+#endif
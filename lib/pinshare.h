@@ -0,0 +1,82 @@
+#ifndef PINSHARE_H_
+#define PINSHARE_H_
+
+#include <msp430.h>
+
+// Arbiter for a Port 1 pin shared between an active low input with a
+// pullup (a button) and an output (e.g. an LCD data line).
+//
+// PxREN stays set in both roles. The resistor is disconnected while the
+// pin is an output, so switching roles only touches PxDIR, PxOUT and
+// PxIFG. The input side owns the pin while it is held (button down); the
+// output side can only claim it in between.
+
+#define PINSHARE_INPUT  0
+#define PINSHARE_OUTPUT 1
+
+typedef struct
+{
+    unsigned char mask;           // Shared pin(s) on Port 1.
+    volatile unsigned char role;  // PINSHARE_INPUT or PINSHARE_OUTPUT.
+    volatile unsigned char held;  // Input is active (pin is low).
+} pinshare;
+
+// Start in the input role: pullup, interrupt on the high to low edge.
+static inline void pinshare_init(pinshare *p)
+{
+    p->role = PINSHARE_INPUT;
+    p->held = 0;
+    P1DIR &= ~p->mask;
+    P1OUT |= p->mask;
+    P1REN |= p->mask;
+    P1IES |= p->mask;
+    P1IFG &= ~p->mask;
+    P1IE |= p->mask;
+}
+
+// Record the input state seen by the caller (usually after debouncing)
+// and watch for the opposite edge.
+// Changing PxIES can set PxIFG, so the flag is cleared afterwards.
+static inline void pinshare_set_held(pinshare *p, unsigned char held)
+{
+    p->held = held;
+    if(held)
+        P1IES &= ~p->mask;
+    else
+        P1IES |= p->mask;
+    P1IFG &= ~p->mask;
+}
+
+// Switch the pin to the output role.
+// Returns 0 without touching the pin while the input side holds it.
+// The caller writes PxOUT for the pin's output level.
+static inline unsigned char pinshare_claim(pinshare *p)
+{
+    if(p->held)
+        return 0;
+    if(p->role != PINSHARE_OUTPUT)
+    {
+        // Edges caused by driving the pin are ignored from now on.
+        p->role = PINSHARE_OUTPUT;
+        P1DIR |= p->mask;
+    }
+    return 1;
+}
+
+// Give the pin back to the input side.
+// If the input went low while the pin was driven, PxIFG is set by
+// software so the pin interrupt still sees the edge.
+static inline void pinshare_release(pinshare *p)
+{
+    if(p->role != PINSHARE_OUTPUT)
+        return;
+    P1OUT |= p->mask; // Pullup again.
+    P1DIR &= ~p->mask;
+    // Flags set while the pin was an output came from our own writes.
+    P1IFG &= ~p->mask;
+    p->role = PINSHARE_INPUT;
+    if((!(P1IN & p->mask)) != p->held)
+        P1IFG |= p->mask;
+}
+
+#endif
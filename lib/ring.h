@@ -0,0 +1,71 @@
+#ifndef RING_H_
+#define RING_H_
+
+// Single producer, single consumer ring buffer for passing events between
+// an ISR and main() without dint()/eint().
+//
+// head is only written by the producer and tail only by the consumer.
+// Both are free running unsigned char counters, so every update is a
+// single byte write and (head - tail) is the fill level. size must be a
+// power of two no larger than 128.
+//
+// RING_DECLARE(name, type, size) declares the struct type name and
+// name_put(), name_get() and name_empty() for it:
+//
+//     RING_DECLARE(event_ring, unsigned char, 4)
+//     event_ring events;
+//
+//     event_ring_put(&events, e);      // ISR. Returns 0 if full.
+//     while(event_ring_get(&events, &e)) // main(). Returns 0 if empty.
+//         ...
+
+#ifdef __MSP430__
+// Single core, only keep the compiler from reordering.
+#define RING_BARRIER() __asm__ __volatile__ ("" ::: "memory")
+#else
+// Host builds run producer and consumer on different cores.
+#define RING_BARRIER() __sync_synchronize()
+#endif
+
+#define RING_DECLARE(name, type, size)                                      \
+typedef char name##_size_check                                              \
+    [(((size) & ((size) - 1)) == 0 && (size) <= 128) ? 1 : -1];             \
+                                                                            \
+typedef struct                                                              \
+{                                                                           \
+    volatile unsigned char head;                                            \
+    volatile unsigned char tail;                                            \
+    type buf[size];                                                         \
+} name;                                                                     \
+                                                                            \
+static inline unsigned char name##_put(name *r, type v)                     \
+{                                                                           \
+    unsigned char head = r->head;                                           \
+    if((unsigned char)(head - r->tail) == (size))                           \
+        return 0;                                                           \
+    r->buf[head & ((size) - 1)] = v;                                        \
+    /* Element has to be in place before the consumer can see it. */        \
+    RING_BARRIER();                                                         \
+    r->head = head + 1;                                                     \
+    return 1;                                                               \
+}                                                                           \
+                                                                            \
+static inline unsigned char name##_get(name *r, type *v)                    \
+{                                                                           \
+    unsigned char tail = r->tail;                                           \
+    if(tail == r->head)                                                     \
+        return 0;                                                           \
+    RING_BARRIER();                                                         \
+    *v = r->buf[tail & ((size) - 1)];                                       \
+    /* Element has to be read before the producer can reuse the slot. */   \
+    RING_BARRIER();                                                         \
+    r->tail = tail + 1;                                                     \
+    return 1;                                                               \
+}                                                                           \
+                                                                            \
+static inline unsigned char name##_empty(name *r)                           \
+{                                                                           \
+    return r->head == r->tail;                                              \
+}
+
+#endif
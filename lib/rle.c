@@ -0,0 +1,29 @@
+#include "rle.h"
+
+void rle_decode(const unsigned char *rle, unsigned int n,
+                void (*put)(unsigned char))
+{
+    const unsigned char *end = rle + n;
+    unsigned char c;
+
+    while(rle < end)
+    {
+        c = *rle++;
+        if(c & 0x80)
+        {
+            // Run, at least two.
+            c -= 0x80 - 2;
+            do
+                put(*rle);
+            while(--c);
+            rle++;
+        }
+        else
+        {
+            // Literal, c + 1 bytes.
+            do
+                put(*rle++);
+            while(c--);
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef RLE_H_
+#define RLE_H_
+
+// Run length packed assets from tools/asset.py --rle, unpacked a byte at
+// a time straight into the display, no buffer:
+//
+//     LCD_SET_INSTRUCTION();
+//     lcd_send_instruction(0x40); // CGRAM address 0.
+//     LCD_SET_DATA();
+//     rle_decode(digits_cgram, sizeof(digits_cgram), lcd_send_data);
+//
+// or for the PCD8544 between DISPLAY_START_TRANSMIT() and
+// DISPLAY_END_TRANSMIT() with spi_send_byte.
+//
+// A byte c < 0x80 is followed by c + 1 bytes as they are, c >= 0x80 by
+// one byte that is repeated c - 0x80 + 2 times.
+
+// Calls put with every byte unpacked from the n packed ones at rle.
+void rle_decode(const unsigned char *rle, unsigned int n,
+                void (*put)(unsigned char));
+
+#endif
@@ -0,0 +1,106 @@
+#include "spi.h"
+
+#include <msp430.h>
+
+#include "pcd8544.h"
+
+void spi_init(void)
+{
+    // Configure ports for SPI.
+    P1SEL |= DISPLAY_SCLK | DISPLAY_SDOUT | DISPLAY_SDIN;
+
+    // Initialize USI module (for SPI).
+    USICTL0 |= USISWRST;
+
+    // Data output enable.
+    // Master mode. MSB first. Enable clock, data in, data out.
+    USICTL0 |= USIOE | USIMST | USIPE5 | USIPE6 | USIPE7;
+
+    // No need for interrupts. Everything done with polling.
+
+    // Serial data sampled on positive edge of SCLK.
+    // Main clock used.
+    // Divided by spi_clock() above 4 MHz, which the display can handle.
+    USICKCTL |= USICKPL | USISSEL1;
+}
+
+void spi_clock(unsigned char mhz)
+{
+    unsigned char div = 0;
+
+    while((mhz >> div) > SPI_MAX_MHZ)
+        div++;
+    USICKCTL = (USICKCTL & ~USIDIV_7) | (div << 5);
+}
+
+void spi_send_byte(unsigned char byte)
+{
+    // Put data into tx register.
+    USISRL = byte;
+
+    // 8-bit shift register mode.
+    // USI bit count is 8.
+    USICNT = 8;
+
+    // Wait for transmission to finish.
+    while(!(USICTL1 & USIIFG))
+        ;
+}
+
+void spi_send_word(unsigned int word)
+{
+    USISR = word;
+
+    // 16-bit shift register mode, MSB first sends USISRH first.
+    USICNT = USI16B | 16;
+
+    while(!(USICTL1 & USIIFG))
+        ;
+}
+
+void spi_send_burst(const unsigned char *bytes, unsigned int n)
+{
+    unsigned int next;
+
+    if(n < 2)
+    {
+        if(n)
+            spi_send_byte(*bytes);
+        return;
+    }
+
+    // First word, then each one is loaded as soon as the last is out.
+    USISR = (bytes[0] << 8) | bytes[1];
+    USICNT = USI16B | 16;
+    bytes += 2;
+    n -= 2;
+
+    for(; n >= 4; n -= 4, bytes += 4)
+    {
+        next = (bytes[0] << 8) | bytes[1];
+        while(!(USICTL1 & USIIFG))
+            ;
+        USISR = next;
+        USICNT = USI16B | 16;
+
+        next = (bytes[2] << 8) | bytes[3];
+        while(!(USICTL1 & USIIFG))
+            ;
+        USISR = next;
+        USICNT = USI16B | 16;
+    }
+    if(n >= 2)
+    {
+        next = (bytes[0] << 8) | bytes[1];
+        while(!(USICTL1 & USIIFG))
+            ;
+        USISR = next;
+        USICNT = USI16B | 16;
+        bytes += 2;
+        n -= 2;
+    }
+    while(!(USICTL1 & USIIFG))
+        ;
+    if(n)
+        spi_send_byte(*bytes);
+}
@@ -0,0 +1,24 @@
+#ifndef SPI_H_
+#define SPI_H_
+
+// SCLK for the PCD8544, at most 4 Mhz. -DSPI_MAX_MHZ=2 leaves room for
+// a DCO running fast.
+#ifndef SPI_MAX_MHZ
+#define SPI_MAX_MHZ 4
+#endif
+
+void spi_init(void);
+void spi_send_byte(unsigned char byte);
+// Two bytes in one 16 bit shift, the high byte first.
+void spi_send_word(unsigned int word);
+// n bytes in back to back 16 bit shifts, four bytes per pass. Each word
+// is put together while the last one shifts out, so at 16 Mhz SCLK
+// hardly stops between words.
+void spi_send_burst(const unsigned char *bytes, unsigned int n);
+
+// Clock listener (clock.h): SCLK is SMCLK divided down to at most
+// SPI_MAX_MHZ with USIDIVx, 1 Mhz straight through, 8 Mhz / 2, 16 Mhz
+// / 4. Projects that run SMCLK above 4 Mhz have to register it.
+void spi_clock(unsigned char mhz);
+
+#endif
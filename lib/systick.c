@@ -0,0 +1,91 @@
+#include "systick.h"
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+// 12 kHz until calibrated.
+static volatile unsigned long tick_us = SYSTICK_CYCLES * 1000000UL / 12000;
+static volatile unsigned long now_us;
+// Split into seconds and the us in the current one.
+static volatile unsigned long seconds;
+static volatile unsigned long second_us;
+
+// Ticks left to measure, TAR at the first one.
+static volatile unsigned char cal_ticks;
+static unsigned int cal_start;
+
+static void __attribute__ ((__interrupt__(WDT_VECTOR))) systick_tick(void)
+{
+    unsigned long us = tick_us;
+
+    if(cal_ticks)
+    {
+        // Read first, so the latency is the same every tick.
+        unsigned int tar = TAR;
+        if(cal_ticks == SYSTICK_CAL_TICKS + 1)
+            cal_start = tar;
+        else if(cal_ticks == 1)
+            // TAR wraps at 16 bits.
+            tick_us = (unsigned long)((tar - cal_start) & 0xffff) *
+                      (8 / SYSTICK_CAL_TICKS);
+        cal_ticks--;
+    }
+
+    now_us += us;
+    second_us += us;
+    if(second_us >= 1000000)
+    {
+        second_us -= 1000000;
+        seconds++;
+    }
+
+    LPM3_EXIT;
+}
+
+void systick_init(void)
+{
+    BCSCTL3 = (BCSCTL3 & ~LFXT1S_3) | LFXT1S_2;
+    BCSCTL1 &= ~DIVA_3;
+    WDTCTL = WDTPW | WDTTMSEL | WDTCNTCL | WDTSSEL | SYSTICK_WDTIS;
+    IE1 |= WDTIE;
+}
+
+void systick_calibrate(void)
+{
+    // 8 us counts at 1 Mhz.
+    TACTL = TASSEL_2 | ID_3 | MC_2 | TACLR;
+    // The tick it starts in is partly gone, the measurement starts at
+    // the next one.
+    cal_ticks = SYSTICK_CAL_TICKS + 1;
+    // SMCLK has to keep Timer_A counting.
+    while(cal_ticks)
+        __bis_status_register(LPM0_bits);
+    TACTL = 0;
+}
+
+// The ISR can change a long between the two word reads, so read until
+// it is the same twice.
+static unsigned long read(volatile unsigned long *v)
+{
+    unsigned long a;
+
+    do
+        a = *v;
+    while(a != *v);
+    return a;
+}
+
+unsigned long systick_tick_us(void)
+{
+    return read(&tick_us);
+}
+
+unsigned long systick_us(void)
+{
+    return read(&now_us);
+}
+
+unsigned long systick_seconds(void)
+{
+    return read(&seconds);
+}
@@ -0,0 +1,56 @@
+#ifndef SYSTICK_H_
+#define SYSTICK_H_
+
+// System tick from the watchdog as an interval timer on ACLK from the
+// VLO, so time is kept in LPM3 with the DCO off and Timer_A is left to
+// the project. systick.c owns WDT_VECTOR.
+//
+// The VLO is anywhere from 4 to 20 kHz (12 kHz typical) and moves with
+// temperature and VCC, so the length of a tick is measured against the
+// DCO: systick_calibrate() counts SMCLK / 8 on Timer_A over
+// SYSTICK_CAL_TICKS ticks. Until then ticks are taken as 12 kHz ones.
+// Calling it again now and then follows the VLO as it drifts; the time
+// keeps counting meanwhile.
+//
+//     systick_init();       // DCO at its 1 Mhz calibration.
+//     eint();
+//     systick_calibrate();  // Borrows Timer_A for about 170 ms.
+//     while(1)
+//     {
+//         LPM3;
+//         if(systick_us() - last >= 500000)
+//         ...
+//     }
+//
+// Every tick wakes main() from LPM, so a loop like the one above checks
+// the time once per tick. The time goes up a tick at a time, each worth
+// what the last calibration measured.
+
+// WDT interval in VLO cycles: WDTIS1 512 (about 43 ms), WDTIS1 | WDTIS0
+// 64. Longer ones overflow TAR while calibrating at 4 kHz.
+#ifndef SYSTICK_WDTIS
+#define SYSTICK_WDTIS WDTIS1
+#endif
+#define SYSTICK_CYCLES ((SYSTICK_WDTIS) & WDTIS0 ? 64 : 512)
+
+// Ticks measured by systick_calibrate(), 1, 2 or 4 (8 with 64 cycle
+// ticks). 8 us resolution over all of them, which have to fit in
+// 65535 * 8 us at 4 kHz.
+#ifndef SYSTICK_CAL_TICKS
+#define SYSTICK_CAL_TICKS 4
+#endif
+
+// VLO as ACLK, the watchdog counting it and its interrupt enabled.
+void systick_init(void);
+// Measures the tick with SMCLK at 1 Mhz, sleeping in LPM0 until it is
+// done. Interrupts have to be enabled and Timer_A not in use; it is
+// stopped afterwards.
+void systick_calibrate(void);
+// Length of a tick in us, as last calibrated.
+unsigned long systick_tick_us(void);
+// Time since systick_init(), wrapping every 71 minutes. Use differences.
+unsigned long systick_us(void);
+// Whole seconds since systick_init().
+unsigned long systick_seconds(void);
+
+#endif
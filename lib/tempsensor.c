@@ -0,0 +1,112 @@
+#include "tempsensor.h"
+
+#include <msp430.h>
+
+// TLV layout, see slau144 chapter 24.
+#define TLV_START       0x10C0
+#define TLV_END         0x1100
+#define TAG_ADC10_1     0x10
+#define CAL_ADC_15T30   3 // Words after the tag and length.
+#define CAL_ADC_15T85   4
+#define CAL_ADC_25T30   6
+#define CAL_ADC_25T85   7
+
+// The simulator's msp430.h routes these through its registers.
+#ifndef TLV_BYTE
+#define TLV_BYTE(a) (*(const unsigned char *)(a))
+#define TLV_WORD(a) (*(const unsigned int *)(a))
+#endif
+
+// Typical codes at 30 and 85 C: 1023 * (0.00355 * T + 0.986) / Vref.
+#define TYPICAL_15T30 745
+#define TYPICAL_15T85 878
+#define TYPICAL_25T30 447
+#define TYPICAL_25T85 527
+
+static unsigned int base; // Code at table[0].
+static int table[TEMPSENSOR_KNOTS];
+
+// Address of the ADC10 calibration words, 0 if missing or the TLV
+// doesn't check out.
+static unsigned int find_adc_cal(void)
+{
+    unsigned int a;
+    unsigned int check = 0;
+
+    // Checksum is minus the XOR of all the words after it.
+    for(a = TLV_START + 2; a < TLV_END; a += 2)
+        check ^= TLV_WORD(a);
+    if((check + TLV_WORD(TLV_START)) & 0xffff)
+        return 0;
+
+    // Tag, length, data.
+    for(a = TLV_START + 2; a < TLV_END - 2; a += 2 + TLV_BYTE(a + 1))
+        if(TLV_BYTE(a) == TAG_ADC10_1)
+            return a + 2;
+    return 0;
+}
+
+unsigned char tempsensor_init(unsigned char flags)
+{
+    unsigned int cal = find_adc_cal();
+    unsigned char ref25 = flags & TEMPSENSOR_2_5V;
+    unsigned int t30 = ref25 ? TYPICAL_25T30 : TYPICAL_15T30;
+    unsigned int t85 = ref25 ? TYPICAL_25T85 : TYPICAL_15T85;
+    unsigned char i;
+
+    if(cal)
+    {
+        unsigned int c30 = TLV_WORD(cal + 2 * (ref25 ? CAL_ADC_25T30 :
+                                                       CAL_ADC_15T30));
+        unsigned int c85 = TLV_WORD(cal + 2 * (ref25 ? CAL_ADC_25T85 :
+                                                       CAL_ADC_15T85));
+        // Blank or nonsense.
+        if(c85 <= c30 || c85 > 1023)
+            cal = 0;
+        else
+        {
+            t30 = c30;
+            t85 = c85;
+        }
+    }
+
+    // Straight line through the two points, 55 C is 550 tenths.
+    base = t30 - (unsigned int)(700L * (t85 - t30) / 550);
+    for(i = 0; i < TEMPSENSOR_KNOTS; ++i)
+    {
+        long code = base + ((unsigned int)i << TEMPSENSOR_SHIFT);
+        long tenths = 300 + (code - t30) * 550 / (long)(t85 - t30);
+        if(flags & TEMPSENSOR_F)
+            tenths = 320 + tenths * 9 / 5;
+        table[i] = tenths;
+    }
+    return cal != 0;
+}
+
+int tempsensor_convert(unsigned int code)
+{
+    unsigned char i;
+    unsigned char frac;
+    unsigned char bit;
+    int step;
+    int sum = 0;
+
+    if(code <= base)
+        return table[0];
+    code -= base;
+    i = code >> TEMPSENSOR_SHIFT;
+    if(i >= TEMPSENSOR_KNOTS - 1)
+        return table[TEMPSENSOR_KNOTS - 1];
+
+    // table[i] + step * frac / 32, shift and add instead of a multiply.
+    frac = code & ((1 << TEMPSENSOR_SHIFT) - 1);
+    step = table[i + 1] - table[i];
+    for(bit = 1 << (TEMPSENSOR_SHIFT - 1); bit; bit >>= 1)
+    {
+        sum <<= 1;
+        if(frac & bit)
+            sum += step;
+    }
+    return table[i] + ((sum + (1 << (TEMPSENSOR_SHIFT - 1))) >>
+                       TEMPSENSOR_SHIFT);
+}
@@ -0,0 +1,32 @@
+#ifndef TEMPSENSOR_H_
+#define TEMPSENSOR_H_
+
+// ADC10 temperature sensor (INCH_10, 1.5 or 2.5 V reference) conversion.
+//
+// Uses the factory calibration in the TLV, the codes read at 30 and
+// 85 C with the same reference, when it's there and the TLV checksum is
+// good. Otherwise the
+// typical datasheet curve, which can be several degrees off.
+//
+// tempsensor_init() puts the temperature every 32 codes from -40 C in a
+// table, a conversion is then a table read and a 5 bit interpolation
+// without a multiply.
+
+// Flags for tempsensor_init().
+#define TEMPSENSOR_C    0x00 // Tenths of a degree Celsius.
+#define TEMPSENSOR_F    0x01 // Tenths of a degree Fahrenheit.
+#define TEMPSENSOR_2_5V 0x02 // Readings use the 2.5 V reference.
+
+// 32 codes per entry, -40 C to about 79 C (1.5 V) or 158 C (2.5 V).
+// Clamped outside.
+#define TEMPSENSOR_SHIFT 5
+#define TEMPSENSOR_KNOTS 10
+
+// Returns 1 if the factory calibration was found.
+unsigned char tempsensor_init(unsigned char flags);
+
+// code is ADC10MEM (or an average of readings), the result is in the unit
+// given to tempsensor_init().
+int tempsensor_convert(unsigned int code);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef TEXT_H_
+#define TEXT_H_
+
+// 5x7 text on the PCD8544 (pcd8544.h), straight to the display or into a
+// frame buffer.
+//
+// The font is in flash, one byte per column with bit 0 at the top, so a
+// glyph is 5 bytes of a bank. Characters are TEXT_WIDTH columns (the
+// glyph and a blank one), 14 to a line, 6 lines, lines on bank
+// boundaries. Characters outside ' ' to '~' draw as '?'.
+//
+//     char buf[6];
+//     text_utoa(score, buf, 5);
+//     text_goto(0, TEXT_COLS - 5);
+//     text_puts(buf);
+
+#define TEXT_FIRST ' '
+#define TEXT_LAST  '~'
+#define TEXT_GLYPHS (TEXT_LAST - TEXT_FIRST + 1)
+#define TEXT_GLYPH_WIDTH 5
+#define TEXT_WIDTH 6
+#define TEXT_COLS  14 // 84 / TEXT_WIDTH.
+#define TEXT_LINES 6
+
+extern const unsigned char text_font[TEXT_GLYPHS][TEXT_GLYPH_WIDTH];
+
+// Moves to a character cell (line 0-5, col 0-13) and selects data.
+void text_goto(unsigned char line, unsigned char col);
+
+// Sends s from the current address, one 16 bit shift per two columns
+// with SCE held low for the whole string. Wraps to the next line.
+void text_puts(const char *s);
+
+// Writes s into a frame buffer bank (column major, like the display) at
+// dst. Returns the column after it.
+unsigned char *text_blit(unsigned char *dst, const char *s);
+
+// Decimal n into buf, right aligned with spaces to width (0 for none),
+// and a terminating 0. buf needs max(width, 5) + 1 bytes. Subtracts
+// powers of ten instead of dividing, at most 32 subtractions. Returns the
+// length.
+unsigned char text_utoa(unsigned int n, char *buf, unsigned char width);
+
+#endif
@@ -0,0 +1,98 @@
+#include "trace.h"
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+#include "uart.h"
+
+static trace_rec trace_buf[TRACE_DEPTH];
+static trace_stat trace_stats[TRACE_IDS];
+static unsigned char trace_head = 0;
+static unsigned char trace_fill = 0;
+
+void trace_init(void)
+{
+    // Continuous mode if the timer is stopped. Clock source and divider
+    // are left to the project.
+    if(!(TACTL & (MC1 | MC0)))
+        TACTL |= MC1;
+
+    uart_init();
+}
+
+void trace_record(unsigned char id, unsigned int start, unsigned int due)
+{
+    unsigned int end = TAR;
+    unsigned int ticks = end - start;
+    unsigned int latency = start - due;
+
+    // Up mode wraps at TACCR0 instead of 0xffff.
+    if((TACTL & (MC1 | MC0)) == MC0)
+    {
+        if(end < start)
+            ticks += TACCR0 + 1;
+        if(start < due)
+            latency += TACCR0 + 1;
+    }
+    if(latency > 0xff)
+        latency = 0xff;
+
+    trace_rec *r = &trace_buf[trace_head++ & (TRACE_DEPTH - 1)];
+    if(trace_fill < TRACE_DEPTH)
+        trace_fill++;
+    r->id = id;
+    r->latency = latency;
+    r->ticks = ticks;
+
+    trace_stat *s = &trace_stats[id];
+    s->count++;
+    s->ticks_sum += ticks;
+    if(ticks > s->ticks_max)
+        s->ticks_max = ticks;
+    if(latency > s->latency_max)
+        s->latency_max = latency;
+}
+
+static void trace_send_word(unsigned int word)
+{
+    uart_send_byte(word);
+    uart_send_byte(word >> 8);
+}
+
+// Frame (little endian):
+// header, TRACE_IDS, number of records,
+// TRACE_IDS * (count, ticks_max, ticks_sum (4 bytes), latency_max),
+// records oldest first (id, latency, ticks).
+// Can be called from an ISR.
+void trace_dump(void)
+{
+    unsigned int sr = __read_status_register();
+    unsigned char i;
+    unsigned char n = trace_fill;
+
+    __dint();
+
+    uart_send_byte(TRACE_HEADER);
+    uart_send_byte(TRACE_IDS);
+    uart_send_byte(n);
+
+    for(i = 0; i < TRACE_IDS; ++i)
+    {
+        trace_send_word(trace_stats[i].count);
+        trace_send_word(trace_stats[i].ticks_max);
+        trace_send_word(trace_stats[i].ticks_sum);
+        trace_send_word(trace_stats[i].ticks_sum >> 16);
+        uart_send_byte(trace_stats[i].latency_max);
+    }
+
+    for(i = trace_head - n; i != trace_head; ++i)
+    {
+        trace_rec *r = &trace_buf[i & (TRACE_DEPTH - 1)];
+        uart_send_byte(r->id);
+        uart_send_byte(r->latency);
+        trace_send_word(r->ticks);
+    }
+
+    if(sr & GIE)
+        __eint();
+}
@@ -0,0 +1,72 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+// ISR duration and latency trace.
+//
+// Build with TRACE defined (make TRACE=1) to record Timer A timestamps,
+// otherwise every macro is empty. Timer A has to be running (TRACE_INIT()
+// starts it in continuous mode if it is stopped). Times are in TAR ticks.
+//
+//     TRACE_ENTER(id);          // First thing in the ISR.
+//     TRACE_ENTER_AT(id, due);  // Same, due is the TAR value the
+//                               // interrupt was requested at (0 for the
+//                               // TACCR0 ISR in up mode, TACCRx in
+//                               // continuous mode). Records latency too.
+//     TRACE_EXIT(id);           // Before every return.
+//
+// The pair also works around a dint()/eint() section (EXIT before eint()).
+// trace_record() must run with interrupts disabled.
+//
+// TRACE_DUMP() sends the trace out of UART_TX with the polled software
+// UART in uart.h (8N1, UART_BIT_CYCLES MCLK cycles per bit) with
+// interrupts disabled, so uart.c has to be built too.
+// tools/trace_decode.py reads it.
+
+#ifndef TRACE_DEPTH
+#define TRACE_DEPTH 8 // Newest records kept. Power of two.
+#endif
+
+#ifndef TRACE_IDS
+#define TRACE_IDS 4
+#endif
+
+#define TRACE_HEADER 0x54 // 'T'
+
+typedef struct
+{
+    unsigned char id;
+    unsigned char latency; // Saturates at 255.
+    unsigned int ticks;
+} trace_rec;
+
+typedef struct
+{
+    unsigned int count;
+    unsigned int ticks_max;
+    unsigned long ticks_sum;
+    unsigned char latency_max;
+} trace_stat;
+
+void trace_init(void);
+void trace_record(unsigned char id, unsigned int start, unsigned int due);
+void trace_dump(void);
+
+#ifdef TRACE
+#define TRACE_INIT() trace_init()
+#define TRACE_ENTER(id) unsigned int trace_start_##id = TAR
+#define TRACE_ENTER_AT(id, due) \
+    unsigned int trace_start_##id = TAR, trace_due_##id = (due)
+#define TRACE_EXIT(id) trace_record((id), trace_start_##id, trace_start_##id)
+#define TRACE_EXIT_AT(id) \
+    trace_record((id), trace_start_##id, trace_due_##id)
+#define TRACE_DUMP() trace_dump()
+#else
+#define TRACE_INIT() do { } while(0)
+#define TRACE_ENTER(id)
+#define TRACE_ENTER_AT(id, due)
+#define TRACE_EXIT(id) do { } while(0)
+#define TRACE_EXIT_AT(id) do { } while(0)
+#define TRACE_DUMP() do { } while(0)
+#endif
+
+#endif
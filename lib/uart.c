@@ -0,0 +1,28 @@
+#include "uart.h"
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+void uart_init(void)
+{
+    P1DIR |= UART_TX;
+    // Uart idle state is high.
+    P1OUT |= UART_TX;
+}
+
+void uart_send_byte(unsigned char byte)
+{
+    // Start bit, 8 data bits (lsb first), stop bit.
+    unsigned int frame = (0x100 | byte) << 1;
+    unsigned char i;
+    for(i = 0; i < 10; ++i)
+    {
+        if(frame & 1)
+            P1OUT |= UART_TX;
+        else
+            P1OUT &= ~UART_TX;
+        frame >>= 1;
+        // Loop overhead is about 10 cycles.
+        __delay_cycles(UART_BIT_CYCLES - 10);
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef UART_H_
+#define UART_H_
+
+// Polled software UART transmitter, 8N1 on P1, lsb first.
+//
+// The caller sets UART_TX up as an output, idle high (uart_init()), and
+// keeps interrupts off while a byte goes out if the timing matters.
+
+#ifndef UART_TX
+#define UART_TX (1 << 1) // Launchpad TXD.
+#endif
+
+#ifndef UART_BIT_CYCLES
+#define UART_BIT_CYCLES 104 // 9600 bps at 1 Mhz.
+#endif
+
+void uart_init(void);
+void uart_send_byte(unsigned char byte);
+
+#endif
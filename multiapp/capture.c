@@ -0,0 +1,223 @@
+// remote's IR capture as a task. The IR receiver's falling edge starts
+// 100 kHz sampling on TACCR0. Once the frame is over, TACCR0 sends it at
+// 9600 bps in remote's format (0x21, sample bytes, pre-trigger bytes),
+// so show_samples.py reads it too. Then the next edge is awaited.
+//
+// Sampling against the dispatcher and the other tasks' ISRs is checked by
+// sim/targets/bench_dispatch.c. There is no pre-trigger ring and no
+// replay: TA0.1 (irtx.h) would need the whole timer.
+//
+// RAM only has room for 64 bytes of capture, 5 ms as remote's bitmap.
+// The frame is kept as run lengths instead, samples of mark and space in
+// turn, and expanded into the bitmap as it is sent. That holds remote's
+// 15.2 ms (an NEC frame's 9 ms leader, its space and the first bits) as
+// long as it has at most CAPTURE_RUNS marks and spaces.
+
+#include <msp430.h>
+
+#include "dispatch.h"
+#include "tasks.h"
+
+#define UART_TX (1 << 6)
+
+// Timer_A ticks are 1 us.
+#define SAMPLE_TICKS 10  // 100 kHz.
+#define BIT_TICKS    104 // 9600 bps, 0.2% fast.
+
+#define HEADER_BYTES 3
+// remote's 190 sample bytes, 15.2 ms.
+#define CAPTURE_SAMPLES 1520
+#ifndef CAPTURE_RUNS
+#define CAPTURE_RUNS 32
+#endif
+// A frame ends after this many samples of space (5 ms), after
+// CAPTURE_SAMPLES or when run[] is full.
+#define IDLE_SAMPLES 500
+
+#define ARMED    0 // Waiting for an edge.
+#define SAMPLING 1
+#define FULL     2 // Waiting for capture_run() to send it.
+#define SENDING  3
+
+static volatile unsigned char state = ARMED;
+// Samples in each run, marks at even indexes. run[runs] is the one being
+// sampled.
+static volatile unsigned int run[CAPTURE_RUNS];
+static volatile unsigned char runs;
+static volatile unsigned int samples;
+// Samples missed since reset, see capture_sample().
+static volatile unsigned int missed;
+static volatile unsigned char dropped;
+// 0x21, sample bytes, no pre-trigger bytes.
+static unsigned char header[HEADER_BYTES] = {0x21};
+// Start bit, 8 data bits and stop bit, sent from bit 0.
+static volatile unsigned int uart_frame;
+static volatile unsigned char uart_bits = 0;
+static volatile unsigned char uart_index;
+static unsigned char frame_bytes;
+// Where the bitmap being sent is in run[].
+static unsigned char send_run;
+static unsigned int send_left;
+
+static void arm(void)
+{
+    runs = 0;
+    run[0] = 0;
+    samples = 0;
+    state = ARMED;
+    P1IFG &= ~IR_SENSOR;
+    P1IE |= IR_SENSOR;
+}
+
+static unsigned char edge(unsigned char pins)
+{
+    (void)pins;
+    // Don't interrupt while sampling. First sample one period from now.
+    P1IE &= ~IR_SENSOR;
+    TACCR0 = TAR + SAMPLE_TICKS;
+    TACCTL0 = CCIE;
+    state = SAMPLING;
+    return 0;
+}
+
+static unsigned char capture_done(void)
+{
+    TACCTL0 = 0;
+    if(dropped)
+    {
+        dropped = 0;
+        arm();
+        return 0;
+    }
+    state = FULL;
+    return DISPATCH_WAKE;
+}
+
+static unsigned char capture_sample(void)
+{
+    unsigned char space = (P1IN & IR_SENSOR) != 0;
+
+    TACCR0 += SAMPLE_TICKS;
+    // Held up past the next compare, TACCR0 at or behind TAR. The samples
+    // in between are lost, and the frame with them: it is sampled to its
+    // end and dropped, nothing is made up for them. dispatch.h keeps this
+    // from happening.
+    while((TACCR0 - TAR - 1) & 0x8000)
+    {
+        TACCR0 += SAMPLE_TICKS;
+        missed++;
+        dropped = 1;
+    }
+    // The level changed, the run is over.
+    if(space != (runs & 1))
+    {
+        if(++runs == CAPTURE_RUNS)
+            return capture_done();
+        run[runs] = 0;
+    }
+    run[runs]++;
+    if(++samples == CAPTURE_SAMPLES || (space && run[runs] == IDLE_SAMPLES))
+    {
+        runs++;
+        return capture_done();
+    }
+    return 0;
+}
+
+// The next 8 samples of the bitmap, space once the runs are used up.
+static unsigned char next_byte(void)
+{
+    unsigned char byte = 0xff;
+    unsigned char bit;
+
+    for(bit = 1; bit; bit <<= 1)
+    {
+        while(!send_left && send_run < runs)
+            send_left = run[send_run++];
+        if(!send_left)
+            break;
+        send_left--;
+        // run[send_run - 1] is a mark.
+        if(send_run & 1)
+            byte &= ~bit;
+    }
+    return byte;
+}
+
+static unsigned char send_bit(void)
+{
+    TACCR0 += BIT_TICKS;
+
+    if(!uart_bits)
+    {
+        // Stop bit of the last byte is done.
+        if(uart_index == frame_bytes)
+        {
+            TACCTL0 = 0;
+            arm();
+            return 0;
+        }
+        uart_frame = 0x200 | ((uart_index < HEADER_BYTES ?
+                               header[uart_index] : next_byte()) << 1);
+        uart_index++;
+        uart_bits = 10;
+    }
+
+    if(uart_frame & 1)
+        P1OUT |= UART_TX;
+    else
+        P1OUT &= ~UART_TX;
+    uart_frame >>= 1;
+    uart_bits--;
+    return 0;
+}
+
+static unsigned char tick(void)
+{
+    if(state == SAMPLING)
+        return capture_sample();
+    return send_bit();
+}
+
+void capture_init(void)
+{
+    // UART_TX is high while idle.
+    P1OUT |= UART_TX;
+    P1DIR |= UART_TX;
+
+    // No need to choose pullup. Built in pullup on ir receiver.
+    // Ir receiver output is active low.
+    P1DIR &= ~IR_SENSOR;
+    P1IES |= IR_SENSOR;
+
+    dispatch_port1(IR_SENSOR, PRIORITY_CAPTURE, edge);
+    dispatch_timer(DISPATCH_TACCR0, tick);
+    arm();
+}
+
+void capture_run(void)
+{
+    if(state != FULL)
+        return;
+
+    header[1] = (samples + 7) / 8;
+    frame_bytes = HEADER_BYTES + header[1];
+    send_run = 0;
+    send_left = 0;
+
+    uart_index = 0;
+    uart_bits = 0;
+    state = SENDING;
+    TACCR0 = TAR + BIT_TICKS;
+    TACCTL0 = CCIE;
+}
+
+unsigned char capture_idle(void)
+{
+    return state != FULL;
+}
+
+unsigned int capture_missed(void)
+{
+    return missed;
+}
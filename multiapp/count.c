@@ -0,0 +1,157 @@
+// interrupt_count as a task: presses counted in BCD, shown on the first
+// line a changed digit at a time.
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+#include "dispatch.h"
+#include "lcdqueue.h"
+#include "ring.h"
+#include "tasks.h"
+
+// Timer_A ticks are 1 us.
+#define DEBOUNCE_TICKS 20000 // 20 ms.
+#define RETRY_TICKS    1000  // 1 ms.
+#define SETTLE_TICKS   2000  // 2 ms.
+
+#define COUNT_DIGITS 4
+
+// Count after each press, newest last, only the newest is shown.
+// count_run() empties the ring on every display update. Should presses
+// come in faster than that, count_lost says the ring was full and count
+// has the newest one.
+RING_DECLARE(count_ring, unsigned int, 4)
+static count_ring counts;
+static volatile unsigned int count = 0;
+static volatile unsigned char count_lost = 0;
+
+// Count as it is on the display. lcdq_init_step() clears it.
+static char count_shown[COUNT_DIGITS] = {' ', ' ', ' ', ' '};
+
+static void count_queue(void)
+{
+    if(!count_ring_put(&counts, count))
+        count_lost = 1;
+}
+
+// Button edge (or software edge from pinshare_release()).
+static unsigned char press(unsigned char pins)
+{
+    (void)pins;
+
+    // Edge caused by the LCD driving D7.
+    if(lcdq_d7.role == PINSHARE_OUTPUT)
+        return 0;
+
+    if(!lcdq_d7.held)
+    {
+        count = __bcd_add_short(count, 1);
+        count_queue();
+    }
+    lcdq_d7.held = !lcdq_d7.held;
+
+    // Ignore bounces. The debounce timer looks at the pin again.
+    P1IE &= ~BUTTON;
+    TACCR1 = TAR + DEBOUNCE_TICKS;
+    TACCTL1 = CCIE;
+
+    return DISPATCH_WAKE;
+}
+
+// Sample the button once it has settled.
+static unsigned char debounce(void)
+{
+    // LCD owns the pin right now. pinshare_release() hands it back
+    // shortly, try again then.
+    if(lcdq_d7.role == PINSHARE_OUTPUT)
+    {
+        TACCR1 += RETRY_TICKS;
+        return 0;
+    }
+    // Pressed or released during the debounce window.
+    unsigned char held = !(P1IN & BUTTON);
+    unsigned char changed = held != lcdq_d7.held;
+    if(held && !lcdq_d7.held)
+    {
+        count = __bcd_add_short(count, 1);
+        count_queue();
+    }
+    pinshare_set_held(&lcdq_d7, held);
+    // Changed with no edge seen, so the pin may be bouncing right now.
+    // Sample again once that is over instead of letting a bounce in as
+    // the next edge.
+    if(changed)
+    {
+        TACCR1 += SETTLE_TICKS;
+        return DISPATCH_WAKE;
+    }
+    TACCTL1 = 0;
+    P1IE |= BUTTON;
+    // Changed again while switching edges.
+    if((!(P1IN & BUTTON)) != held)
+        P1IFG |= BUTTON;
+
+    return DISPATCH_WAKE;
+}
+
+// Queues the digits of bcd from the first one that differs from the
+// display, leading zeros blank.
+static void count_show(unsigned int bcd)
+{
+    char text[COUNT_DIGITS];
+    unsigned char first = COUNT_DIGITS;
+    unsigned char lead = 1;
+    unsigned char i;
+
+    // Top nibble first, shifted by a constant each time.
+    for(i = 0; i < COUNT_DIGITS; ++i, bcd <<= 4)
+    {
+        unsigned char digit = (bcd >> 12) & 0x0f;
+        lead &= !digit && i != COUNT_DIGITS - 1;
+        text[i] = lead ? ' ' : '0' + digit;
+        if(first == COUNT_DIGITS && text[i] != count_shown[i])
+            first = i;
+    }
+
+    if(first == COUNT_DIGITS)
+        return;
+    lcdq_put(0x80 | first);
+    for(i = first; i < COUNT_DIGITS; ++i)
+    {
+        lcdq_put(LCDQ_DATA | text[i]);
+        count_shown[i] = text[i];
+    }
+}
+
+void count_init(void)
+{
+    dispatch_port1(BUTTON, PRIORITY_COUNT, press);
+    dispatch_timer(DISPATCH_TACCR1, debounce);
+    // Zero to begin.
+    count_ring_put(&counts, 0);
+}
+
+// Shows the newest count once the display has taken everything before.
+void count_run(void)
+{
+    unsigned int bcd = 0;
+    unsigned char lost = count_lost;
+
+    if(!lcdq_idle() || (!count_ring_get(&counts, &bcd) && !lost))
+        return;
+    while(count_ring_get(&counts, &bcd))
+        ;
+    // Cleared before count is read, so a press in between shows up again
+    // next time round.
+    if(lost)
+    {
+        count_lost = 0;
+        bcd = count;
+    }
+    count_show(bcd);
+}
+
+unsigned char count_idle(void)
+{
+    return !lcdq_idle() || (count_ring_empty(&counts) && !count_lost);
+}
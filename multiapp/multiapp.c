@@ -0,0 +1,65 @@
+// interrupt_count, lcdtemp and remote's capture in one image, as tasks
+// (tasks.h) whose interrupts go through dispatch.h.
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+#include "boot.h"
+#include "clock.h"
+#include "delay.h"
+#include "lcdqueue.h"
+#include "tasks.h"
+
+#define eint() __eint()
+#define dint() __dint()
+
+// The ADC reference settles and the first measurement runs while the LCD
+// waits out its power on.
+static const boot_step boot_steps[] = {lcdq_init_step, temp_init_step};
+
+int main(void)
+{
+    // Disable watchdog timer.
+    WDTCTL = WDTPW | WDTHOLD;
+
+    // 8 Mhz for the 100 kHz sampling, every task runs at it.
+    clock_listen(delay_clock);
+    if(!clock_set(CLOCK_8MHZ))
+        while(1); // Trap if calibration values were erased.
+
+    // SMCLK / 8 = 1 Mhz, counting continuously. Shared by the tasks.
+    TACTL = TASSEL_2 | ID_3 | MC_2 | TACLR;
+
+    // P1.3 starts out as the button input. The LCD claims it per nibble.
+    pinshare_init(&lcdq_d7);
+
+    count_init();
+    capture_init();
+
+    // Enable global interrupt. The first measurement needs it, and the
+    // other tasks can go on while the LCD and the ADC start up.
+    eint();
+    boot_run(boot_steps, 2);
+
+    while(1)
+    {
+        count_run();
+        temp_run();
+        capture_run();
+
+        // Stops early if the button is down.
+        lcdq_flush();
+
+        // Sleep until a handler has something for a task, or the button
+        // lets go of D7. Checked with interrupts off so a wake up can't be
+        // missed before going to sleep.
+        dint();
+        if(count_idle() && temp_idle() && capture_idle() &&
+           (lcdq_idle() || lcdq_d7.held))
+            __bis_status_register(LPM0_bits | GIE);
+        else
+            eint();
+    }
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef TASKS_H_
+#define TASKS_H_
+
+// The tasks of one image, sharing Port 1 and Timer_A through dispatch.h.
+//
+// Each task has an init, called before interrupts are enabled, which sets
+// up its pins and registers its handlers, and a run, called from main()'s
+// loop, which does what its handlers left for it. main() sleeps when
+// every task is idle. An init that has to wait on its hardware is a step
+// for boot_run() (boot.h) instead, run next to the LCD's.
+//
+// Timer_A counts SMCLK / 8 = 1 Mhz continuously and each task moves its
+// own compare register:
+//
+//     TACCR0  capture  100 kHz sampling, then 9600 bps on UART_TX
+//     TACCR1  count    button debounce
+//     TACCR2  temp     measurement period
+//
+// Port 1: the LCD on P1.0-P1.5 (lcdqueue.h) with the button on D7 (P1.3),
+// UART_TX on P1.6 and the IR receiver on P1.7.
+
+#define IR_SENSOR (1 << 7)
+#define BUTTON    (1 << 3)
+
+// Port 1 handler priorities. The IR edge starts sampling, go first.
+#define PRIORITY_CAPTURE 0
+#define PRIORITY_COUNT   1
+
+// Press counter on the first line.
+void count_init(void);
+void count_run(void);
+unsigned char count_idle(void);
+
+// Temperature and VCC on the second line.
+unsigned int temp_init_step(void);
+void temp_run(void);
+unsigned char temp_idle(void);
+
+// IR capture, sent as remote's frames.
+void capture_init(void);
+void capture_run(void);
+unsigned char capture_idle(void);
+// Samples missed since reset, each dropped the frame it was in.
+unsigned int capture_missed(void);
+
+#endif
@@ -0,0 +1,99 @@
+// lcdtemp as a task: temperature and VCC on the second line, measured
+// every TEMP_PERIODS * 50 ms.
+
+#include <msp430.h>
+
+#include "adcscan.h"
+#include "dispatch.h"
+#include "lcdqueue.h"
+#include "tasks.h"
+#include "tempsensor.h"
+
+#define INTERNAL_REFERENCE_AND_GND SREF0
+
+// Timer_A ticks are 1 us.
+#define TEMP_TICKS   50000 // 50 ms.
+#define TEMP_PERIODS 10
+
+#define LINE_2 0x40
+
+// Scanned channels.
+#define TEMPERATURE 0
+#define SUPPLY      1
+static const adcscan_channel channels[] = {
+    {10, 4}, // Temperature sensor, 16 scans.
+    {11, 2}, // VCC/2, 4 scans.
+};
+
+static unsigned char periods = 0;
+// A round was started and isn't on the display yet.
+static volatile unsigned char measuring = 0;
+static unsigned char init_state = 0;
+
+static unsigned char period(void)
+{
+    TACCR2 += TEMP_TICKS;
+    if(++periods < TEMP_PERIODS || measuring)
+        return 0;
+    periods = 0;
+    measuring = 1;
+    // Its interrupt wakes main() when the round is done.
+    adcscan_start();
+    return 0;
+}
+
+static void temp_show(void)
+{
+    // Fahrenheit, rounded from tenths.
+    int n = (tempsensor_convert(adcscan_result(TEMPERATURE)) + 5) / 10;
+    // VCC in tenths of a volt: code * 2 * 2.5 V / 1024.
+    unsigned int v = (adcscan_result(SUPPLY) * 25 + 256) >> 9;
+
+    lcdq_put(0x80 | LINE_2);
+    lcdq_put(LCDQ_DATA | ('0' + n / 10));
+    lcdq_put(LCDQ_DATA | ('0' + n % 10));
+    lcdq_put(LCDQ_DATA | 0xdf);
+    lcdq_put(LCDQ_DATA | 'F');
+
+    lcdq_put(0x80 | (LINE_2 + 12));
+    lcdq_put(LCDQ_DATA | ('0' + v / 10));
+    lcdq_put(LCDQ_DATA | '.');
+    lcdq_put(LCDQ_DATA | ('0' + v % 10));
+    lcdq_put(LCDQ_DATA | 'V');
+}
+
+unsigned int temp_init_step(void)
+{
+    if(!init_state++)
+    {
+        // Temperature and VCC/2 against the 2.5 V reference (VCC/2 is
+        // above 1.5 V).
+        adcscan_init(channels, 2, INTERNAL_REFERENCE_AND_GND | REFON |
+                                  REF2_5V | ADC10SHT_3);
+        return 30; // Wait for reference to settle.
+    }
+    tempsensor_init(TEMPSENSOR_F | TEMPSENSOR_2_5V);
+
+    // First measurement right away, it is shown once the LCD is up.
+    measuring = 1;
+    adcscan_start();
+
+    dispatch_timer(DISPATCH_TACCR2, period);
+    TACCR2 = TAR + TEMP_TICKS;
+    TACCTL2 = CCIE;
+    init_state = 0;
+    return 0;
+}
+
+void temp_run(void)
+{
+    if(temp_idle())
+        return;
+    temp_show();
+    measuring = 0;
+}
+
+unsigned char temp_idle(void)
+{
+    return !measuring || !adcscan_done() || !lcdq_idle();
+}
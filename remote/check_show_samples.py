@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Checks that show_samples.py --no-plot prints every frame.
+
+Frames are written back to back, with trace frames and noise between
+them, once as a file and once through a pty in a single write, faster
+than they are printed. Exits non-zero if a frame is missing or out of
+order.
+
+    remote/check_show_samples.py
+"""
+
+import os
+import pty
+import re
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+from show_samples import HEADER, HEADER_PRE, SAMPLE_BYTES, TRACE_HEADER
+
+SCRIPT = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      'show_samples.py')
+FRAMES = 20
+TIMEOUT_S = 10
+
+
+def stream():
+    """FRAMES frames of both kinds and the sample counts expected for
+    them."""
+    data = bytearray()
+    expected = []
+    for n in range(FRAMES):
+        if n % 5 == 4:
+            data += bytes([HEADER]) + bytes([0xff]) * SAMPLE_BYTES
+            expected.append((SAMPLE_BYTES * 8, 0))
+        else:
+            size, pre = 10 + n, n % 3
+            data += bytes([HEADER_PRE, size, pre]) + bytes([0x0f]) * size
+            expected.append((size * 8, pre * 8))
+        if n % 7 == 3:
+            # One trace sample and one event, then a stray byte.
+            data += bytes([TRACE_HEADER, 1, 1]) + bytes(13) + b'\x00'
+    return bytes(data), expected
+
+
+def check(name, lines, expected):
+    got = [tuple(int(x) for x in m.groups()) for m in
+           (re.match(r'frame \d+: (\d+) samples \((\d+) pre-trigger\)', l)
+            for l in lines) if m]
+    if got != expected:
+        print('%s: %d of %d frames, expected %s, got %s' % (
+            name, len(got), len(expected), expected, got))
+        return False
+    print('%s: %d frames' % (name, len(got)))
+    return True
+
+
+def from_file(data, expected):
+    with tempfile.NamedTemporaryFile(suffix='.bin') as f:
+        f.write(data)
+        f.flush()
+        out = subprocess.run([sys.executable, SCRIPT, f.name, '--no-plot'],
+                             stdout=subprocess.PIPE, timeout=TIMEOUT_S,
+                             universal_newlines=True).stdout
+    return check('file', out.splitlines(), expected)
+
+
+def from_pty(data, expected):
+    master, slave = pty.openpty()
+    proc = subprocess.Popen([sys.executable, SCRIPT, os.ttyname(slave),
+                             '--no-plot'], stdout=subprocess.PIPE,
+                            universal_newlines=True)
+    lines = []
+    try:
+        # Let it open and set up the port before anything arrives.
+        time.sleep(0.5)
+        # Ends the readline() below if frames are missing.
+        timer = threading.Timer(TIMEOUT_S, proc.kill)
+        timer.start()
+        done = 0
+        while done < len(data):
+            done += os.write(master, data[done:])
+        # A port never ends, stop once every frame is printed.
+        while len(lines) < len(expected):
+            line = proc.stdout.readline()
+            if not line:
+                break
+            lines.append(line)
+        timer.cancel()
+    finally:
+        proc.kill()
+        proc.wait()
+        os.close(master)
+        os.close(slave)
+    return check('pty', lines, expected)
+
+
+def main():
+    data, expected = stream()
+    ok = from_file(data, expected)
+    ok &= from_pty(data, expected)
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == '__main__':
+    main()
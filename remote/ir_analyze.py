@@ -0,0 +1,448 @@
+#!/usr/bin/env python3
+"""Decodes recorded IR captures into a codes.txt table and a C header.
+
+Reads raw capture files (show_samples.py --record, sim/remote) and turns
+the sample bitmaps into mark/space run lengths. The receiver output is
+active low, so a mark is a run of 0 samples, 10 us each. Runs are
+clustered to find the bit timing and the coding:
+
+- pulse distance: one mark width, two space widths (NEC),
+- pulse width: two mark widths, one space width (Sony),
+- biphase: marks and spaces of one and two half bits (RC5).
+
+A first mark longer than any data mark is the leader, with the space
+after it. The last run of a capture is cut off by the end of the sample
+window and is dropped. Bits are written in the order received, '1' for
+the long width, like the hand made codes.txt. In the header bit 0 is
+the first bit received, and IR_PROTOCOL describes the timing for
+irtx_send() (lib/irtx.h) so remote can send the codes.
+
+    ir_analyze.py captures.bin ... [-o codes.txt] [--header ir_codes.h]
+    ir_analyze.py --bench 100000
+
+--names takes an existing codes.txt and reuses its names for codes it
+already lists. --bench decodes a synthetic corpus and prints the rates.
+"""
+
+import argparse
+import collections
+import os
+import re
+import sys
+import tempfile
+import time
+
+import numpy as np
+
+from show_samples import Framer, HEADER, SAMPLE_BYTES, SAMPLE_US
+
+# Widths within this ratio (plus the +-1 sample quantisation) of the
+# previous one are in the same cluster.
+CLUSTER_RATIO = 1.3
+# A first mark or space this much longer than the data ones is a leader.
+LEADER_RATIO = 1.5
+
+Timing = collections.namedtuple(
+    'Timing', 'coding leader_mark leader_space mark space unit')
+
+
+def load(paths, sample_bytes):
+    """Frames of all files as a (captures, bytes) uint8 array. Frames with
+    pre-trigger samples are cut to start at their first mark, like the
+    fixed 0x20 ones, and all are padded with space to the longest."""
+    fixed = []
+    cut = []
+    size = 1 + sample_bytes
+    for path in paths:
+        data = open(path, 'rb').read()
+        raw = np.frombuffer(data, np.uint8)
+        # Back to back 0x20 frames, as recorded: no framing needed.
+        if len(raw) % size == 0 and (raw[::size] == HEADER).all():
+            fixed.append(raw.reshape(-1, size)[:, 1:])
+            continue
+        framer = Framer(sample_bytes)
+        for frame in framer.feed(data):
+            bits = np.unpackbits(np.frombuffer(frame.data, np.uint8),
+                                 bitorder='little')
+            marks = np.flatnonzero(bits == 0)
+            if len(marks):
+                cut.append(bits[marks[0]:])
+        if framer.skipped:
+            print('%s: skipped %d bytes' % (path, framer.skipped),
+                  file=sys.stderr)
+    width = max([f.shape[1] for f in fixed] +
+                [(len(b) + 7) // 8 for b in cut] + [0])
+    frames = [np.pad(f, ((0, 0), (0, width - f.shape[1])),
+                     constant_values=0xff) for f in fixed]
+    if cut:
+        bits = np.ones((len(cut), width * 8), np.uint8)
+        for i, b in enumerate(cut):
+            bits[i, :len(b)] = b
+        frames.append(np.packbits(bits, axis=1, bitorder='little'))
+    if not frames:
+        return np.zeros((0, sample_bytes), np.uint8)
+    return np.concatenate(frames)
+
+
+class Runs(object):
+    """Run lengths of all captures as flat arrays: capture, position in
+    the capture, level and length in samples. The last run of every
+    capture is left out."""
+
+    def __init__(self, frames):
+        n, width = frames.shape
+        length = width * 8
+        # Level changes on the packed bytes: each sample against the one
+        # before it, carrying bit 7 over from the previous byte. Sample 0
+        # always starts a run.
+        carry = np.zeros_like(frames)
+        carry[:, 1:] = frames[:, :-1] >> 7
+        carry[:, 0] = frames[:, 0] & 1
+        change = frames ^ ((frames << 1) | carry)
+        change[:, 0] |= 1
+        # Only the few bytes with a change are unpacked.
+        at = np.flatnonzero(change)
+        bits = np.unpackbits(change.ravel()[at], bitorder='little')
+        sample = np.flatnonzero(bits)
+        at = at[sample >> 3]
+        row = at // width
+        col = (at % width) * 8 + (sample & 7)
+        # Run i ends where run i + 1 starts, or at the end of its row.
+        end = np.empty_like(col)
+        end[:-1] = col[1:]
+        last = np.empty(len(row), bool)
+        last[:-1] = row[1:] != row[:-1]
+        last[-1:] = True
+        end[last] = length
+        keep = ~last
+        first = np.searchsorted(row, np.arange(n))
+
+        self.count = n
+        self.row = row[keep]
+        self.index = (np.arange(len(row)) - first[row])[keep]
+        level = (frames[row, col >> 3] >> (col & 7).astype(np.uint8)) & 1
+        self.level = level[keep]
+        self.length = (end - col)[keep]
+
+    def select(self, mask):
+        return self.row[mask], self.length[mask]
+
+
+def clusters(lengths):
+    """Groups sorted widths at gaps. Returns [(centre, count)] in
+    samples, shortest first."""
+    counts = np.bincount(lengths) if len(lengths) else np.zeros(0, int)
+    widths = np.flatnonzero(counts)
+    groups = []
+    for w in widths:
+        if groups and w <= groups[-1][-1] * CLUSTER_RATIO + 1:
+            groups[-1].append(w)
+        else:
+            groups.append([w])
+    result = []
+    for g in groups:
+        c = counts[g]
+        result.append((float(np.dot(g, c)) / c.sum(), int(c.sum())))
+    # Stray widths (noise, glitches) don't make a cluster.
+    total = sum(c for _, c in result)
+    return [r for r in result if r[1] * 100 >= total]
+
+
+def two(cl):
+    """Short and long centre of a two width cluster list, or None."""
+    if len(cl) != 2:
+        return None
+    return cl[0][0], cl[1][0]
+
+
+def infer(runs):
+    """Timing and coding from the runs of all captures."""
+    mark = runs.level == 0
+    first_mark = mark & (runs.index == 0)
+    first_space = ~mark & (runs.index == 1)
+    rest = runs.index >= 2
+
+    data_marks = clusters(runs.length[mark & rest])
+    data_spaces = clusters(runs.length[~mark & rest])
+    if not data_marks or not data_spaces:
+        sys.exit('not enough runs to find the timing')
+
+    leader_mark = leader_space = None
+    lm = np.median(runs.length[first_mark]) if first_mark.any() else 0
+    ls = np.median(runs.length[first_space]) if first_space.any() else 0
+    if lm > data_marks[-1][0] * LEADER_RATIO:
+        leader_mark, leader_space = float(lm), float(ls)
+    if leader_mark is None:
+        # No leader: the first runs are data too.
+        data_marks = clusters(runs.length[mark])
+        data_spaces = clusters(runs.length[~mark & (runs.index >= 1)])
+
+    m, s = two(data_marks), two(data_spaces)
+    unit = min(data_marks[0][0], data_spaces[0][0])
+    if m and s and abs(m[1] / m[0] - 2) < 0.4 and abs(s[1] / s[0] - 2) < 0.4:
+        return Timing('biphase', leader_mark, leader_space, m, s, unit)
+    if s and len(data_marks) == 1:
+        return Timing('pulse distance', leader_mark, leader_space,
+                      (data_marks[0][0],), s, unit)
+    if m and len(data_spaces) == 1:
+        return Timing('pulse width', leader_mark, leader_space,
+                      m, (data_spaces[0][0],), unit)
+    if len(data_marks) == 1 and len(data_spaces) == 1:
+        sys.exit('one mark and one space width (%s, %s): need captures '
+                 'with both bit values' % (describe(data_marks),
+                                           describe(data_spaces)))
+    sys.exit('no coding fits: marks %s, spaces %s' % (
+        describe(data_marks), describe(data_spaces)))
+
+
+def split(row, chars, count):
+    """One string per capture from characters sorted by capture."""
+    ends = np.cumsum(np.bincount(row, minlength=count))
+    text = chars.astype(np.uint8).tobytes().decode()
+    starts = np.concatenate(([0], ends[:-1]))
+    return [text[a:b] for a, b in zip(starts, ends)]
+
+
+def decode(runs, timing):
+    """Bit string of every capture."""
+    skip = 2 if timing.leader_mark is not None else 0
+    data = runs.index >= skip
+    mark = runs.level == 0
+    if timing.coding == 'biphase':
+        return decode_biphase(runs, timing, data)
+    if timing.coding == 'pulse distance':
+        sel, width = data & ~mark, timing.space
+    else:
+        sel, width = data & mark, timing.mark
+    row, length = runs.select(sel)
+    chars = np.where(length > (width[0] + width[1]) / 2, ord('1'), ord('0'))
+    return split(row, chars, runs.count)
+
+
+def decode_biphase(runs, timing, data):
+    """Manchester: each run is one or two half bits, a bit is a space
+    then a mark for 1 and a mark then a space for 0 (RC5 on the active
+    low receiver output)."""
+    row, length = runs.select(data)
+    level = runs.level[data]
+    halves = np.rint(length / timing.unit).clip(1, 2).astype(np.intp)
+    hrow = np.repeat(row, halves)
+    hlevel = np.repeat(level, halves)
+    # Half bit position within its capture, to pair them up.
+    first = np.searchsorted(hrow, hrow)
+    pos = np.arange(len(hrow)) - first
+    # A capture starting on a mark has lost the leading space half.
+    lead = np.zeros(runs.count, np.intp)
+    starts = np.flatnonzero(pos == 0)
+    lead[hrow[starts]] = hlevel[starts] == 0
+    pos = pos + lead[hrow]
+    second = (pos & 1) == 1
+    chars = np.where(hlevel[second] == 0, ord('1'), ord('0'))
+    bits = split(hrow[second], chars, runs.count)
+    # A final 0 ends in a space that ran into the idle level and was
+    # dropped with the last run.
+    odd = np.bincount(hrow, minlength=runs.count) + lead
+    for i in np.flatnonzero(odd & 1):
+        bits[i] += '0'
+    return bits
+
+
+def read_names(path):
+    names = {}
+    for line in open(path):
+        m = re.match(r'\s*(\S+)\s*=\s*([01]+)\s*$', line)
+        if m:
+            names[m.group(2)] = m.group(1)
+    return names
+
+
+def us(samples):
+    return int(round(samples * SAMPLE_US))
+
+
+def describe(cl):
+    return ', '.join('%d us x%d' % (us(c), n) for c, n in cl)
+
+
+def table(codes, names):
+    """[(name, bits, captures)] most common first."""
+    result = []
+    unnamed = 0
+    for bits, n in codes.most_common():
+        if not bits:
+            continue
+        name = names.get(bits)
+        if name is None:
+            unnamed += 1
+            name = 'code%d' % unnamed
+        result.append((name, bits, n))
+    return result
+
+
+def write_codes(path, rows):
+    with open(path, 'w') as f:
+        for name, bits, _ in rows:
+            f.write('%5s = %s\n' % (name, bits))
+
+
+def write_header(path, rows, timing, captures):
+    guard = re.sub(r'\W', '_', os.path.basename(path)).upper() + '_'
+    bits = max(len(b) for _, b, _ in rows)
+    suffix = 'UL' if bits > 16 else ''
+    lines = ['// Generated by ir_analyze.py from %d captures.' % captures,
+             '#ifndef %s' % guard, '#define %s' % guard, '',
+             '// %s coding, times in us. Bit 0 is received first.' %
+             timing.coding.capitalize()]
+
+    def define(name, value):
+        lines.append('#define %-16s %s' % (name, value))
+
+    if timing.leader_mark is not None:
+        define('IR_LEADER_MARK', us(timing.leader_mark))
+    if timing.leader_space is not None:
+        define('IR_LEADER_SPACE', us(timing.leader_space))
+    if timing.coding == 'biphase':
+        define('IR_HALF_BIT', us(timing.unit))
+    elif timing.coding == 'pulse distance':
+        define('IR_MARK', us(timing.mark[0]))
+        define('IR_SPACE_0', us(timing.space[0]))
+        define('IR_SPACE_1', us(timing.space[1]))
+    else:
+        define('IR_MARK_0', us(timing.mark[0]))
+        define('IR_MARK_1', us(timing.mark[1]))
+        define('IR_SPACE', us(timing.space[0]))
+    define('IR_BITS', bits)
+    if timing.coding != 'biphase':
+        marks = timing.mark * 2 if len(timing.mark) == 1 else timing.mark
+        spaces = timing.space * 2 if len(timing.space) == 1 else timing.space
+        lines.append('// irtx_protocol for irtx_send(), see lib/irtx.h.')
+        define('IR_PROTOCOL', '{%d, %d, %d, %d, %d, %d}' % (
+            us(timing.leader_mark or 0), us(timing.leader_space or 0),
+            us(marks[0]), us(marks[1]), us(spaces[0]), us(spaces[1])))
+    lines.append('')
+    digits = (bits + 3) // 4
+    for value, name in sorted((int(code[::-1], 2), name)
+                              for name, code, _ in rows):
+        define('IR_' + re.sub(r'\W', '_', name.replace('+', '_up')
+                              .replace('-', '_down')).upper(),
+               '0x%0*x%s' % (digits, value, suffix))
+    lines += ['', '#endif', '']
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def analyze(frames):
+    """Returns timing, bit strings and the seconds each step took."""
+    steps = []
+    t = time.perf_counter()
+    runs = Runs(frames)
+    steps.append(('run lengths', time.perf_counter() - t))
+    t = time.perf_counter()
+    timing = infer(runs)
+    steps.append(('clustering', time.perf_counter() - t))
+    t = time.perf_counter()
+    bits = decode(runs, timing)
+    steps.append(('decoding', time.perf_counter() - t))
+    return runs, timing, bits, steps
+
+
+def synthetic(codes, count, sample_bytes, seed=1):
+    """count pulse distance captures of random codes as raw frames, with
+    +-40 us of jitter. Short enough timing for 15 bits to fit 16 ms."""
+    rng = np.random.default_rng(seed)
+    pick = rng.integers(len(codes), size=count)
+    width = max(len(c) for c in codes)
+    bits = np.array([[c == '1' for c in code.ljust(width, '0')]
+                     for code in codes])[pick]
+    # Leader, then mark/space per bit, final mark and idle.
+    runs = 2 + 2 * width + 2
+    length = np.empty((count, runs))
+    length[:, 0], length[:, 1] = 2000, 1000
+    length[:, 2:-2:2] = 250
+    length[:, 3:-2:2] = np.where(bits, 500, 250)
+    length[:, -2], length[:, -1] = 250, 1e6
+    length += rng.uniform(-40, 40, length.shape)
+    samples = sample_bytes * 8
+    # Sample the edges, clipped to the capture window.
+    edges = np.minimum(np.rint(np.cumsum(length, axis=1) / SAMPLE_US),
+                       samples).astype(np.intp)
+    sizes = np.diff(edges, prepend=0).ravel()
+    level = np.tile(np.arange(runs) & 1, count).astype(np.uint8)
+    samples_ = np.repeat(level, sizes).reshape(count, samples)
+    packed = np.packbits(samples_, axis=1, bitorder='little')
+    raw = np.empty((count, 1 + sample_bytes), np.uint8)
+    raw[:, 0] = HEADER
+    raw[:, 1:] = packed
+    return raw.tobytes(), [codes[i] for i in pick]
+
+
+def bench(count, sample_bytes, names):
+    codes = sorted(names) or ['100000110100010', '100001110100010']
+    t = time.perf_counter()
+    data, expected = synthetic(codes, count, sample_bytes)
+    print('generated %d captures in %.2f s' % (count,
+                                                time.perf_counter() - t))
+    # Read back from a file, like a recording.
+    with tempfile.NamedTemporaryFile(suffix='.bin') as f:
+        f.write(data)
+        f.flush()
+        t = time.perf_counter()
+        frames = load([f.name], sample_bytes)
+        steps = [('loading', time.perf_counter() - t)]
+    runs, timing, bits, more = analyze(frames)
+    steps += more
+    total = sum(s for _, s in steps)
+    for name, s in steps:
+        print('%-12s %7.3f s' % (name, s))
+    print('%-12s %7.3f s, %d captures/s' % ('total', total, count / total))
+    wrong = sum(a != b for a, b in zip(bits, expected))
+    print('%s, %d of %d decoded wrong' % (timing.coding, wrong, count))
+    return wrong == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('captures', nargs='*', help='raw capture files')
+    parser.add_argument('--samples', type=int, default=SAMPLE_BYTES,
+                        help='sample bytes per frame (160 with TRACE=1)')
+    parser.add_argument('-o', '--output', metavar='FILE',
+                        help='write a codes.txt table')
+    parser.add_argument('--header', metavar='FILE',
+                        help='write a C header with the timing and codes')
+    parser.add_argument('--names', metavar='FILE',
+                        help='codes.txt to take names from')
+    parser.add_argument('--bench', type=int, metavar='N',
+                        help='time a synthetic corpus of N captures')
+    args = parser.parse_args()
+
+    names = read_names(args.names) if args.names else {}
+    if args.bench:
+        sys.exit(0 if bench(args.bench, args.samples, names) else 1)
+    if not args.captures:
+        parser.error('no capture files')
+
+    frames = load(args.captures, args.samples)
+    if not len(frames):
+        sys.exit('no captures found')
+    runs, timing, bits, steps = analyze(frames)
+    total = sum(s for _, s in steps)
+    print('%d captures, %d runs, %.0f captures/s' %
+          (len(frames), len(runs.length), len(frames) / max(total, 1e-9)))
+    print('coding: %s' % timing.coding)
+    if timing.leader_mark is not None:
+        print('leader: %d us mark, %d us space' % (
+            us(timing.leader_mark), us(timing.leader_space)))
+    print('marks:  %s' % ', '.join('%d us' % us(m) for m in timing.mark))
+    print('spaces: %s' % ', '.join('%d us' % us(s) for s in timing.space))
+
+    rows = table(collections.Counter(bits), names)
+    for name, code, n in rows:
+        print('%5s = %s  (%d)' % (name, code, n))
+    if args.output:
+        write_codes(args.output, rows)
+    if args.header:
+        write_header(args.header, rows, timing, len(frames))
+
+
+if __name__ == '__main__':
+    main()
@@ -1,12 +1,23 @@
 #include <msp430.h>
 #include <intrinsics.h>
 
+#include "clock.h"
+#include "delay.h"
+#include "irtx.h"
+#include "ring.h"
+#include "trace.h"
+
 #define eint()    __eint()
 #define dint()    __dint()
 
 #define UART_TX   (1 << 1)
+#define BUTTON    (1 << 3)
 #define IR_SENSOR (1 << 4)
 
+// Trace ids.
+#define TRACE_START_SAMPLE 0
+#define TRACE_ADD_POINT    1
+
 #if 0
 // Assumes n > 0.
 // Assumes a 8 Mhz clock.
@@ -40,44 +51,140 @@ static void delay_ms(register unsigned int n)
 }
 #endif
 
+#ifdef TRACE
+// Leave room for the trace buffers.
+#define NUM_SAMPLES 161
+#else
 #define NUM_SAMPLES 201
-// First byte is the header.
-volatile unsigned char sample[NUM_SAMPLES] = {0x20};
-// Already have one byte (header).
-volatile unsigned int sample_index = 1;
+#endif
+// Frame header: 0x21, sample bytes after the header, pre-trigger bytes.
+#define HEADER_BYTES 3
+// Samples before the ir sensor's first edge, in bytes at 100 kHz (64
+// samples, 640 us by default). Power of two from 4 to 32.
+#ifndef PRETRIGGER_BYTES
+#define PRETRIGGER_BYTES 8
+#endif
+// While waiting for an edge the pin is sampled at 100 kHz / 4 into a
+// ring of 2 * PRETRIGGER_BYTES bits, which covers the pre-trigger bytes.
+#define PRETRIGGER_DIVIDE 4
+#define PRETRIGGER_BITS (2 * PRETRIGGER_BYTES)
+typedef char pretrigger_check[((PRETRIGGER_BYTES & (PRETRIGGER_BYTES - 1))
+                               == 0 && PRETRIGGER_BYTES >= 4 &&
+                               PRETRIGGER_BYTES <= 32) ? 1 : -1];
+#define FIRST_SAMPLE (HEADER_BYTES + PRETRIGGER_BYTES)
+// A frame ends after this many samples of space (5 ms), or when
+// sample[] is full.
+#ifndef IDLE_SAMPLES
+#define IDLE_SAMPLES 500
+#endif
+
+volatile unsigned char sample[NUM_SAMPLES] = {0x21};
+volatile unsigned int sample_index = FIRST_SAMPLE;
 volatile unsigned char sample_bit_index = 0;
+// Samples of space in a row.
+volatile unsigned int idle = 0;
+// 0 while armed (low rate into pretrigger[]), 1 while capturing.
+volatile unsigned char sampling = 0;
+volatile unsigned char pretrigger[PRETRIGGER_BITS / 8];
+volatile unsigned char pretrigger_index = 0;
+// TAR when the edge came, timer ticks after the last pretrigger sample.
+volatile unsigned int trigger_ticks;
+// Bytes in the frame being sent, header included.
+volatile unsigned int frame_bytes;
 volatile unsigned char bit_to_send = 0;
 volatile unsigned int transmit_index = 0;
 volatile unsigned char transmit_bit_index = 1;
 volatile unsigned char transmit = 0;
-volatile unsigned char transmitting = 0;
+// Completed captures waiting to be sent.
+RING_DECLARE(capture_ring, unsigned char, 2)
+capture_ring captures;
 #define START_BIT 0
 #define DATA_BIT 1
 #define STOP_BIT 2
 volatile unsigned char transmit_state = START_BIT;
+// Timer periods for the current clock, in cycles. Up mode counts 0 to
+// TACCR0, so TACCR0 gets one less.
+unsigned int sample_period;
+unsigned int bit_period;
+// Button pressed, send once the timer is free.
+volatile unsigned char send_ir = 0;
+// sample[] holds a capture that can be replayed.
+unsigned char learned = 0;
+
+#ifdef IR_CODE
+// make IR_CODE=IR_POWER sends that code from ir_codes.h (written by
+// ir_analyze.py --header) instead of replaying the last capture.
+#include "ir_codes.h"
+static const irtx_protocol protocol = IR_PROTOCOL;
+#endif
 
-// Ir receiver interrupt on high to low transition.
+// Sampling needs 8 Mhz, see add_point().
+static void clock_changed(unsigned char mhz)
+{
+    // 100 kHz sampling, 9600 bps.
+    sample_period = 10 * mhz;
+    bit_period = 104 * mhz + mhz / 6;
+}
+
+// Ir receiver interrupt on high to low transition, or the button.
 static void __attribute__ ((__interrupt__(PORT1_VECTOR))) start_sample(void)
 {
-    // Don't interrupt while sampling.
-    P1IE &= ~IR_SENSOR;
-    // Start timer to capture signal.
-    // Sampling rate = 100 kHz.
-    // 2x ir transmission of ~ 40 kHz.
-    // Nyquist theorem.
-    TACCR0 = 80;
+    TRACE_ENTER(TRACE_START_SAMPLE);
+
+    if(P1IFG & P1IE & BUTTON)
+    {
+        // Ignore bounces until main has sent.
+        P1IE &= ~BUTTON;
+        P1IFG &= ~BUTTON;
+        send_ir = 1;
+        __bic_status_register_on_exit(LPM0_bits);
+    }
+
+    if(P1IFG & P1IE & IR_SENSOR)
+    {
+        // Where the edge is between pretrigger samples.
+        trigger_ticks = TAR;
+        // Don't interrupt while sampling.
+        P1IE &= ~IR_SENSOR;
+        // Switch the timer to capture signal, first sample one period
+        // from now.
+        // Sampling rate = 100 kHz.
+        // 2x ir transmission of ~ 40 kHz.
+        // Nyquist theorem.
+        TACCR0 = sample_period - 1;
+        TACTL |= TACLR;
+        sampling = 1;
+    }
+
+    TRACE_EXIT(TRACE_START_SAMPLE);
 }
 
 // Sample pin or transmit.
+// Has to finish within 80 cycles (one sample period at 8 Mhz) while
+// sampling, and 104 cycles (one bit at 1 Mhz) while transmitting.
 static void __attribute__ ((__interrupt__(TIMER0_A0_VECTOR))) add_point(void)
 {
-    if(!transmit)
+    // Up mode: TAR counts from 0 after the TACCR0 match.
+    TRACE_ENTER_AT(TRACE_ADD_POINT, 0);
+
+    if(!transmit && !sampling)
+    {
+        // Armed, keep the last PRETRIGGER_BITS samples.
+        unsigned char bit = 1 << (pretrigger_index & 7);
+        if(P1IN & IR_SENSOR)
+            pretrigger[pretrigger_index >> 3] |= bit;
+        else
+            pretrigger[pretrigger_index >> 3] &= ~bit;
+        pretrigger_index = (pretrigger_index + 1) & (PRETRIGGER_BITS - 1);
+    }
+    else if(!transmit)
     {
+        unsigned char level = (P1IN & IR_SENSOR) >> 4;
+
         if(sample_bit_index == 0)
             sample[sample_index] = 0;
 
-        sample[sample_index] |=
-            ((P1IN & IR_SENSOR) >> 4) << sample_bit_index++;
+        sample[sample_index] |= level << sample_bit_index++;
 
         if(sample_bit_index == 8)
         {
@@ -85,12 +192,21 @@ static void __attribute__ ((__interrupt__(TIMER0_A0_VECTOR))) add_point(void)
             sample_bit_index = 0;
         }
 
+        if(!level)
+            idle = 0;
+        else
+            idle++;
+
         // Done sampling.
-        if(sample_index == NUM_SAMPLES)
+        if(sample_index == NUM_SAMPLES || idle == IDLE_SAMPLES)
         {
             TACCR0 = 0;
+            // Rest of a partial byte is space.
+            if(sample_bit_index)
+                sample[sample_index++] |= 0xff << sample_bit_index;
             // Can transmit now.
-            transmitting = 1;
+            capture_ring_put(&captures, 1);
+            __bic_status_register_on_exit(LPM0_bits);
         }
     }
     else
@@ -125,35 +241,100 @@ static void __attribute__ ((__interrupt__(TIMER0_A0_VECTOR))) add_point(void)
             P1OUT |= UART_TX;
             transmit_state = START_BIT;
             // All bits done.
-            if(transmit_index == NUM_SAMPLES)
+            if(transmit_index == frame_bytes)
             {
                 TACCR0 = 0;
-                // Already have header byte.
-                sample_index = 1;
+                sample_index = FIRST_SAMPLE;
                 sample_bit_index = 0;
-                // Wait for another sample sequence.
+                // Main switches back to 8 Mhz and waits for another
+                // sample sequence.
                 transmit = 0;
-                P1IFG &= ~IR_SENSOR;
-                P1IE |= IR_SENSOR;
+                __bic_status_register_on_exit(LPM0_bits);
             }
             break;
         default:
             break;
         }
     }
+
+    TRACE_EXIT_AT(TRACE_ADD_POINT);
+}
+
+// Low rate sampling into pretrigger[] until the ir sensor's edge.
+static void arm(void)
+{
+    sampling = 0;
+    idle = 0;
+    TACCR0 = sample_period * PRETRIGGER_DIVIDE - 1;
+    P1IFG &= ~IR_SENSOR;
+    P1IE |= IR_SENSOR;
+}
+
+static void put_sample(unsigned int i, unsigned char level)
+{
+    if(level)
+        sample[i >> 3] |= 1 << (i & 7);
+    else
+        sample[i >> 3] &= ~(1 << (i & 7));
+}
+
+// Fills the pre-trigger bytes on the capture's 100 kHz grid, backwards
+// from the first captured sample: the edge (one period before it),
+// space back to the last pretrigger sample, then the pretrigger samples
+// PRETRIGGER_DIVIDE times each. Then the header.
+static void finish_frame(void)
+{
+    unsigned int i = FIRST_SAMPLE * 8;
+    unsigned char fill = trigger_ticks / sample_period;
+    unsigned char ring = pretrigger_index;
+
+    put_sample(--i, 0);
+    while(fill--)
+        put_sample(--i, 1);
+    while(i > HEADER_BYTES * 8)
+    {
+        unsigned char n;
+        unsigned char level;
+
+        ring = (ring - 1) & (PRETRIGGER_BITS - 1);
+        level = pretrigger[ring >> 3] >> (ring & 7) & 1;
+        for(n = 0; n < PRETRIGGER_DIVIDE && i > HEADER_BYTES * 8; ++n)
+            put_sample(--i, level);
+    }
+
+    frame_bytes = sample_index;
+    sample[1] = frame_bytes - HEADER_BYTES;
+    sample[2] = PRETRIGGER_BYTES;
+}
+
+// Replays the last capture, or sends IR_CODE, on IRTX_PIN. Called with
+// the timer stopped and the ir sensor interrupt off.
+static void transmit_ir(void)
+{
+    irtx_start();
+#ifdef IR_CODE
+    irtx_send(&protocol, IR_CODE, IR_BITS);
+#else
+    if(learned)
+        irtx_replay(sample + HEADER_BYTES, (frame_bytes - HEADER_BYTES) * 8,
+                    10);
+#endif
+    irtx_stop();
 }
 
 int main(void)
 {
+    unsigned char i;
+
     // Disable watchdog timer.
     WDTCTL = WDTPW | WDTHOLD;
 
-    // Calibrate main clock to 8Mhz.
-    if(CALBC1_8MHZ == 0xff || CALDCO_8MHZ == 0xff)
+    // Calibrate main clock to 8Mhz for sampling. Transmitting runs at
+    // 1 Mhz, so both need calibration values.
+    clock_listen(clock_changed);
+    clock_listen(delay_clock);
+    if(!clock_set(CLOCK_1MHZ) || !clock_set(CLOCK_8MHZ))
         while(1); // Trap if calibration values were erased.
-    DCOCTL = 0; // Choose lowest DCO clock and MODx values.
-    BCSCTL1 = CALBC1_8MHZ;
-    DCOCTL = CALDCO_8MHZ;
 
     // Pin interrupt used to detect ir signal.
 
@@ -162,10 +343,18 @@ int main(void)
     // No need to choose pullup. Built in pullup on ir receiver.
     // Ir sensor detected on high to low transition.
     P1IES |= IR_SENSOR;
-    // Enable interrupt on ir sensor pin.
-    P1IE |= IR_SENSOR;
-    // Clear existing interrupts for ir sensor.
-    P1IFG &= ~IR_SENSOR;
+    // Interrupt on the ir sensor pin is enabled by arm().
+
+    for(i = 0; i < sizeof(pretrigger); ++i)
+        pretrigger[i] = 0xff;
+
+    // Button (S2) to send, pulled up, interrupt on press.
+    P1DIR &= ~BUTTON;
+    P1OUT |= BUTTON;
+    P1REN |= BUTTON;
+    P1IES |= BUTTON;
+    P1IFG &= ~BUTTON;
+    P1IE |= BUTTON;
 
     // Timer used for sampling and uart.
 
@@ -184,26 +373,76 @@ int main(void)
     // Uart transmit pin is high by default.
     P1OUT |= UART_TX;
 
+    // Trace is sent on UART_TX between captures.
+    TRACE_INIT();
+
     // Enable global interrupt.
     eint();
+    arm();
 
     while(1)
     {
-        if(transmitting)
+        unsigned char capture;
+
+        // Sleep until a capture is done or the button is pressed.
+        if(!capture_ring_get(&captures, &capture))
         {
-            // Start transmitting from first byte and bit.
-            transmit_index = 0;
-            transmit_bit_index = 1;
-            // First bit is always the same.
-            bit_to_send = 0;
-            // Set to transmit data.
-            transmit = 1;
-            // Currently transmitting, don't enter this code until
-            // another sample read.
-            transmitting = 0;
-            // 9600 bps at 8 Mhz.
-            TACCR0 = 833;
+            // Checked again with interrupts off so the wake up can't
+            // happen before going to sleep.
+            dint();
+            // Not while capturing, the capture is sent first.
+            if(send_ir && !sampling)
+            {
+                // Don't capture our own transmission.
+                P1IE &= ~IR_SENSOR;
+                eint();
+                transmit_ir();
+                // Let the button settle before taking presses again.
+                delay_ms(50);
+                send_ir = 0;
+                P1IFG &= ~BUTTON;
+                P1IE |= BUTTON;
+                arm();
+            }
+            else if(capture_ring_empty(&captures))
+                __bis_status_register(LPM0_bits | GIE);
+            else
+                eint();
+            continue;
         }
+
+        finish_frame();
+
+        // Timer is stopped, UART_TX is free. Trace is sent at 8 Mhz
+        // (UART_BIT_CYCLES).
+        TRACE_DUMP();
+
+        // Nothing to sample until the frame is sent.
+        clock_set(CLOCK_1MHZ);
+
+        // Start transmitting from first byte and bit.
+        transmit_index = 0;
+        transmit_bit_index = 1;
+        // First bit of the header.
+        bit_to_send = sample[0] & 1;
+        // Set to transmit data.
+        transmit = 1;
+        // 9600 bps.
+        TACCR0 = bit_period - 1;
+
+        // Sleep until the last stop bit.
+        dint();
+        while(transmit)
+        {
+            __bis_status_register(LPM0_bits | GIE);
+            dint();
+        }
+        eint();
+
+        // Wait for another sample sequence.
+        learned = 1;
+        clock_set(CLOCK_8MHZ);
+        arm();
     }
 
     return 0;
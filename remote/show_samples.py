@@ -1,47 +1,301 @@
-import serial
-from matplotlib import pylab as plt
-
-NUM_SAMPLES = 200
-
-def serial_initialize():
-    ser = serial.Serial(port='COM5') # Open COM5 (9600 8N1).
-    print 'Reading on port: %s' % ser.portstr # Check which port was open.
-    return ser
-
-def sample_read(ser):
-    header = ord(ser.read()) # Block until header byte.
-    if header != 0x20:
-       return None
-    print '[OK] Header read.'
-    # Store all samples.
-    # Extra item so plot diplays correctly.
-    sample = [0]
-    for i in xrange(NUM_SAMPLES):
-        # Add this point to sample.
-        # One byte equals eight points.
-        points = ord(ser.read())
-        for j in xrange(8):
-            print '[OK] Sample point (%d) read.' % (i * 8 + j)
-            sample.append((points >> j) & 0x1)
-    return sample
-
-def sample_display(sample):
-    if sample == None:
-        return
-    # Split data into time and sample axis.
-    x, y = zip(*enumerate(sample))
-    # Plot data.
-    fig = plt.figure()
-    ax = fig.add_subplot(111)
-    ax.step(x, y)
-    ax.set_ylim(-1, 2)
-    plt.draw()
+#!/usr/bin/env python3
+"""Live viewer for the IR captures remote sends over its software UART.
+
+A reader thread pulls whatever the port has in bulk, cuts it into
+capture frames and puts them in a small ring. A frame is 0x21, the
+number of sample bytes, the number of those that are pre-trigger, then
+the sample bytes: eight samples per byte LSB first, 10 us apart, 1 for
+space. Older firmware sends 0x20 and a fixed 200 bytes (--samples).
+Trace frames from make TRACE=1 ('T', see tools/trace_decode.py) are
+skipped.
+
+The plot is one persistent figure whose trace is redrawn by blitting at
+the display rate, so a slow redraw never holds up the port. Time 0 is
+the trigger, pre-trigger samples are at negative times.
+
+    show_samples.py /dev/ttyACM0 --record captures.bin
+    show_samples.py captures.bin --no-plot
+
+The source can also be a file of raw bytes, e.g. from --record or from
+sim/remote; files are read to the end and the last frame stays shown.
+With --no-plot every frame gets its line, none are dropped;
+check_show_samples.py checks that over a file and a pty.
+"""
+
+import argparse
+import collections
+import os
+import select
+import sys
+import threading
+import time
+
+HEADER = 0x20
+# Variable length frames with pre-trigger samples.
+HEADER_PRE = 0x21
+TRACE_HEADER = 0x54
+SAMPLE_US = 10
+# 0x20 frames: remote.c NUM_SAMPLES - 1, 160 bytes when built with
+# TRACE=1.
+SAMPLE_BYTES = 200
+
+# raw is the frame as received, pre the number of pre-trigger samples at
+# the start of data.
+Frame = collections.namedtuple('Frame', 'raw pre data')
+
+
+class Port(object):
+    """Bulk reads from a serial port, a pty or a file. read() returns b''
+    on timeout and None at the end of a file."""
+
+    def __init__(self, path, baud, timeout=0.05):
+        self.timeout = timeout
+        self.ser = None
+        self.fd = None
+        self.f = None
+        if os.path.isfile(path):
+            self.f = open(path, 'rb')
+            return
+        try:
+            import serial
+        except ImportError:
+            self.fd = self._open_tty(path, baud)
+            return
+        self.ser = serial.Serial(port=path, baudrate=baud, timeout=timeout)
+
+    @staticmethod
+    def _open_tty(path, baud):
+        # No pyserial, POSIX only: raw 8N1 through termios.
+        import termios
+        import tty
+        fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, 'B%d' % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        return fd
+
+    def read(self):
+        if self.f is not None:
+            return self.f.read(65536) or None
+        if self.ser is not None:
+            return self.ser.read(max(1, self.ser.in_waiting))
+        ready, _, _ = select.select([self.fd], [], [], self.timeout)
+        if not ready:
+            return b''
+        try:
+            return os.read(self.fd, 65536)
+        except OSError:
+            return None  # pty closed by the other side.
+
+    def close(self):
+        if self.f is not None:
+            self.f.close()
+        elif self.ser is not None:
+            self.ser.close()
+        else:
+            os.close(self.fd)
+
+
+class Framer(object):
+    """Cuts a byte stream into capture frames, resynchronising on headers
+    and skipping trace frames."""
+
+    def __init__(self, sample_bytes):
+        self.sample_bytes = sample_bytes
+        self.buf = bytearray()
+        self.skipped = 0
+
+    def feed(self, data):
+        """Returns the complete Frames in data."""
+        self.buf += data
+        frames = []
+        while self.buf:
+            head = self.buf[0]
+            if head == HEADER:
+                if len(self.buf) < 1 + self.sample_bytes:
+                    break
+                size = 1 + self.sample_bytes
+                frames.append(Frame(bytes(self.buf[:size]), 0,
+                                    bytes(self.buf[1:size])))
+                del self.buf[:size]
+            elif head == HEADER_PRE and len(self.buf) >= 3 and \
+                    0 < self.buf[1] and self.buf[2] < self.buf[1]:
+                size = 3 + self.buf[1]
+                if len(self.buf) < size:
+                    break
+                frames.append(Frame(bytes(self.buf[:size]), self.buf[2] * 8,
+                                    bytes(self.buf[3:size])))
+                del self.buf[:size]
+            elif head == HEADER_PRE and len(self.buf) < 3:
+                break
+            elif head == TRACE_HEADER and len(self.buf) >= 3 and \
+                    0 < self.buf[1] <= 16 and self.buf[2] <= 128:
+                size = 3 + 9 * self.buf[1] + 4 * self.buf[2]
+                if len(self.buf) < size:
+                    break
+                del self.buf[:size]
+            elif head == TRACE_HEADER and len(self.buf) < 3:
+                break
+            else:
+                self.skipped += 1
+                del self.buf[0]
+        return frames
+
+
+def samples(frame):
+    """Sample levels of a frame, eight per byte, LSB first."""
+    return [(b >> i) & 1 for b in frame for i in range(8)]
+
+
+def edges(levels):
+    return sum(1 for a, b in zip(levels, levels[1:]) if a != b)
+
+
+class Reader(threading.Thread):
+    """Reads the port and queues (arrival time, count, Frame) in a ring.
+    Keeps only the newest frames when the viewer falls behind, all of them
+    with depth None."""
+
+    def __init__(self, port, framer, record=None, depth=8):
+        threading.Thread.__init__(self)
+        self.daemon = True
+        self.port = port
+        self.framer = framer
+        self.record = record
+        self.ring = collections.deque(maxlen=depth)
+        self.received = 0
+        self.done = threading.Event()
+        self.stop = threading.Event()
+
+    def run(self):
+        try:
+            while not self.stop.is_set():
+                data = self.port.read()
+                if data is None:
+                    break
+                for frame in self.framer.feed(data):
+                    now = time.time()
+                    if self.record is not None:
+                        self.record.write(frame.raw)
+                        self.record.flush()
+                    self.received += 1
+                    self.ring.append((now, self.received, frame))
+        finally:
+            self.done.set()
+
+    def latest(self):
+        """Newest queued frame, dropping older ones, or None."""
+        item = None
+        while self.ring:
+            item = self.ring.popleft()
+        return item
+
+    def take(self):
+        """Oldest queued frame or None."""
+        return self.ring.popleft() if self.ring else None
+
+
+def run_text(reader):
+    """Prints a line per frame, for headless use."""
+    while True:
+        # Read before taking: the last frame is queued before done is set.
+        done = reader.done.is_set()
+        item = reader.take()
+        if item is not None:
+            t, n, frame = item
+            levels = samples(frame.data)
+            print('frame %d: %d samples (%d pre-trigger), %d edges, shown '
+                  '%.1f ms after the last byte' % (
+                      n, len(levels), frame.pre, edges(levels),
+                      (time.time() - t) * 1000))
+            sys.stdout.flush()
+        elif done:
+            break
+        else:
+            time.sleep(0.01)
+
+
+def run_plot(reader, sample_bytes, refresh):
+    from matplotlib import animation
+    from matplotlib import pyplot as plt
+
+    fig, ax = plt.subplots()
+    line, = ax.plot([], [], drawstyle='steps-post', animated=True)
+    label = ax.text(0.01, 0.95, 'waiting for a capture', animated=True,
+                    transform=ax.transAxes, va='top')
+    # Time 0 is the trigger.
+    span = [0.0, sample_bytes * 8 * SAMPLE_US / 1000.0]
+    ax.set_xlim(*span)
+    ax.set_ylim(-0.5, 1.5)
+    ax.set_xlabel('ms')
+    ax.set_yticks([0, 1])
+
+    def update(_):
+        item = reader.latest()
+        if item is None:
+            return []
+        t, count, frame = item
+        levels = samples(frame.data)
+        x = [(i - frame.pre) * SAMPLE_US / 1000.0
+             for i in range(len(levels) + 1)]
+        line.set_data(x, levels + levels[-1:])
+        label.set_text('frame %d, %d edges, %d skipped bytes, lag %.0f ms'
+                       % (count, edges(levels), reader.framer.skipped,
+                          (time.time() - t) * 1000))
+        if x[0] < span[0] or x[-1] > span[1]:
+            # Axes changes need a full redraw, blitting keeps the old
+            # background.
+            span[0], span[1] = min(span[0], x[0]), max(span[1], x[-1])
+            ax.set_xlim(*span)
+            fig.canvas.draw_idle()
+        return [line, label]
+
+    def init():
+        return [line, label]
+
+    # Kept referenced until the window closes.
+    anim = animation.FuncAnimation(fig, update, init_func=init, blit=True,
+                                   interval=1000.0 / refresh,
+                                   cache_frame_data=False)
     plt.show()
+    return anim
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('source', help='serial port or file with raw bytes')
+    parser.add_argument('--baud', type=int, default=9600)
+    parser.add_argument('--samples', type=int, default=SAMPLE_BYTES,
+                        help='sample bytes in 0x20 frames (160 with '
+                        'TRACE=1)')
+    parser.add_argument('--record', metavar='FILE',
+                        help='append every frame, header included')
+    parser.add_argument('--refresh', type=float, default=60,
+                        help='plot updates per second')
+    parser.add_argument('--no-plot', action='store_true',
+                        help='print a line per frame instead')
+    args = parser.parse_args()
+
+    port = Port(args.source, args.baud)
+    record = open(args.record, 'ab') if args.record else None
+    # The text output keeps up with the port, the plot shows the newest.
+    reader = Reader(port, Framer(args.samples), record,
+                    None if args.no_plot else 8)
+    reader.start()
+    try:
+        if args.no_plot:
+            run_text(reader)
+        else:
+            run_plot(reader, args.samples, args.refresh)
+    except KeyboardInterrupt:
+        pass
+    reader.stop.set()
+    reader.join(1)
+    if record is not None:
+        record.close()
+
 
-ser = serial_initialize()
-# Continually read samples.
-while 1:
-    # Collect sample from serial port.
-    sample = sample_read(ser)
-    # Display latest sample.
-    sample_display(sample)
+if __name__ == '__main__':
+    main()
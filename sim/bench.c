@@ -0,0 +1,114 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+
+static double begin_us;
+static double end_us;
+static double end_mhz;
+static unsigned long begin_bus;
+static unsigned long end_bus;
+static int begun;
+static int ended;
+
+static struct
+{
+    const char *key;
+    double value;
+} fields[BENCH_FIELDS];
+static int num_fields;
+
+void bench_begin(unsigned long bus)
+{
+    bench_begin_at(sim_time_us(), bus);
+}
+
+void bench_begin_at(double us, unsigned long bus)
+{
+    begin_us = us;
+    begin_bus = bus;
+    begun = 1;
+}
+
+void bench_end(unsigned long bus)
+{
+    end_us = sim_time_us();
+    end_mhz = sim_mclk_hz() / 1e6;
+    end_bus = bus;
+    ended = begun;
+}
+
+void bench_set(const char *key, double value)
+{
+    int i;
+    for(i = 0; i < num_fields; ++i)
+        if(!strcmp(fields[i].key, key))
+            break;
+    if(i == BENCH_FIELDS)
+        return;
+    if(i == num_fields)
+        num_fields++;
+    fields[i].key = key;
+    fields[i].value = value;
+}
+
+void bench_estimate(void)
+{
+    bench_set("estimate", 1);
+}
+
+// Runs the case, returns its violations.
+static int case_run(int (*app)(void), double seconds, void (*done)(void))
+{
+    begun = ended = 0;
+    num_fields = 0;
+    int violations = sim_run(app, seconds);
+    if(done)
+        done();
+    return violations;
+}
+
+// The fields and the end of the line.
+static void print_fields(void)
+{
+    int i;
+
+    for(i = 0; i < num_fields; ++i)
+        printf(", \"%s\": %.10g", fields[i].key, fields[i].value);
+    printf("}\n");
+    fflush(stdout);
+}
+
+int bench_run(const char *name, int (*app)(void), double seconds,
+              void (*done)(void))
+{
+    int violations = case_run(app, seconds, done);
+    if(!ended)
+    {
+        fprintf(stderr, "%s: never ended\n", name);
+        return 0;
+    }
+
+    double us = end_us - begin_us;
+    printf("{\"name\": \"%s\", \"us\": %.3f, \"cycles\": %.0f, "
+           "\"bus_bytes\": %lu", name, us, us * end_mhz, end_bus - begin_bus);
+    print_fields();
+    return !violations;
+}
+
+int bench_check(const char *name, int (*app)(void), double seconds,
+                void (*done)(void))
+{
+    int violations = case_run(app, seconds, done);
+    if(!num_fields)
+    {
+        fprintf(stderr, "%s: checked nothing\n", name);
+        return 0;
+    }
+
+    printf("{\"name\": \"%s\"", name);
+    print_fields();
+    return !violations;
+}
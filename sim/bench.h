@@ -0,0 +1,53 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+// Benchmark cases on the simulator, collected by tools/bench.py.
+//
+// Each case runs from reset in its own sim_run() and prints one JSON
+// line:
+//
+//     {"name": "lcddemo/display_clear", "us": 4300.000, "cycles": 4300,
+//      "bus_bytes": 506}
+//
+// us is the simulated time from bench_begin() to the last bench_end(),
+// cycles the MCLK cycles in it at the clock bench_end() saw. Only what
+// the simulator models takes time (register accesses, delays, interrupts,
+// LPM, see sim.h): pure computation measures 0. A case that is only
+// computation either charges its instructions with sim_cycles(), as an
+// estimate (bench_estimate()), or runs with bench_check(), which prints
+// just its fields:
+//
+//     {"name": "lcddemo/text_utoa", "errors": 0}
+
+#define BENCH_FIELDS 8
+
+// Marks the measured part of a case, from the case's app or a device.
+// bus is the bus device's byte count at that point. bench_end() can be
+// called again to move the end.
+void bench_begin(unsigned long bus);
+void bench_end(unsigned long bus);
+
+// bench_begin() back at us, e.g. sim_irq_us() in an interrupt handler.
+void bench_begin_at(double us, unsigned long bus);
+
+// Extra field for the case, e.g. an error or a result to check.
+void bench_set(const char *key, double value);
+
+// Marks the case's us and cycles as estimates, counted by hand from the
+// source and charged with sim_cycles(): they don't follow the code when
+// it changes. tools/bench.py shows them but neither gates them nor keeps
+// them in the baseline. From the case's app or done.
+void bench_estimate(void);
+
+// Runs app for at most seconds, then done (if not 0) which can add
+// fields. Prints the case. Returns 0 if the case had violations or never
+// called bench_end().
+int bench_run(const char *name, int (*app)(void), double seconds,
+              void (*done)(void));
+
+// bench_run() for a case that measures nothing, with no us, cycles or
+// bus_bytes. Returns 0 if the case had violations or set no field.
+int bench_check(const char *name, int (*app)(void), double seconds,
+                void (*done)(void));
+
+#endif
@@ -0,0 +1,27 @@
+#include "delay.h"
+
+#include "sim.h"
+
+// ../lib/delay.c for the simulator. Same cycle counts as the assembly
+// loops, so the time depends on MCLK the same way, and on delay_clock()
+// having been told about clock changes.
+
+unsigned char delay_mhz = 1;
+unsigned char delay_shift = 0;
+
+void delay_clock(unsigned char mhz)
+{
+    delay_mhz = mhz;
+    for(delay_shift = 0; (1 << delay_shift) < mhz; ++delay_shift)
+        ;
+}
+
+void delay_us(register unsigned int n)
+{
+    sim_cycles(((unsigned long)n << delay_shift) + 4 * delay_shift);
+}
+
+void delay_ms(register unsigned int n)
+{
+    sim_cycles((1000UL * delay_mhz + 6) * n);
+}
@@ -0,0 +1,322 @@
+#include "energy.h"
+
+#include <link.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+// Vector numbers.
+#include "include/msp430.h"
+
+#define PS 1e-12
+
+// Batteries for the life estimate, capacity in mAh.
+static const struct
+{
+    const char *name;
+    double mah;
+} batteries[] = {{"CR2032", 225}, {"2xAA", 2500}};
+
+static const char *const mode_names[ENERGY_MODES] =
+    {"active", "lpm0", "lpm1", "lpm2", "lpm3", "lpm4"};
+static const char *const sleep_names[ENERGY_MODES] =
+    {"", "(lpm0)", "(lpm1)", "(lpm2)", "(lpm3)", "(lpm4)"};
+static const char *const peripheral_names[ENERGY_PERIPHERALS] =
+    {"adc10", "ref", "sensor", "timer_a", "usi", "wdt"};
+
+// Datasheet figures at 3 V in uA. Timer_A, USI and the watchdog have no
+// figure of their own: what they cost is the clock they keep running,
+// which the mode figures already include.
+static const double peripheral_ua[ENERGY_PERIPHERALS] = {600, 250, 60};
+
+typedef struct
+{
+    double ps;
+    double charge; // uA ps.
+} bucket;
+
+static double total_ps;
+static double total_charge;
+static bucket modes[ENERGY_MODES];
+static bucket peripherals[ENERGY_PERIPHERALS];
+// Active time per interrupt vector, main at 0.
+static bucket contexts[1 + 32 / 2];
+
+// Per function profile. Slot 0 collects time outside instrumented code.
+#define MAX_FUNCTIONS 512
+#define MAX_DEPTH 64
+
+static struct
+{
+    void *fn;
+    bucket b;
+} functions[MAX_FUNCTIONS];
+static bucket sleeping[ENERGY_MODES];
+static int stack[MAX_DEPTH];
+static int depth;
+
+void energy_reset(void)
+{
+    total_ps = total_charge = 0;
+    memset(modes, 0, sizeof(modes));
+    memset(peripherals, 0, sizeof(peripherals));
+    memset(contexts, 0, sizeof(contexts));
+    memset(functions, 0, sizeof(functions));
+    memset(sleeping, 0, sizeof(sleeping));
+    depth = 0;
+}
+
+static double mode_ua(const energy_state *s)
+{
+    switch(s->mode)
+    {
+    case ENERGY_ACTIVE:
+        // 300 uA at 1 Mhz, 4.2 mA at 16 Mhz.
+        return 40 + 260 * s->mclk_mhz;
+    case ENERGY_LPM0:
+    case ENERGY_LPM1:
+        // 56 uA with the DCO at 1 Mhz.
+        return 20 + 36 * s->dco_mhz;
+    case ENERGY_LPM2:
+        return 22;
+    case ENERGY_LPM3:
+        return s->lfxt ? 0.9 : 0.6;
+    default:
+        return 0.1;
+    }
+}
+
+static void add(bucket *b, double ps, double charge)
+{
+    b->ps += ps;
+    b->charge += charge;
+}
+
+void energy_add(const energy_state *s, unsigned long long ps)
+{
+    double scale = sim_vcc / 3;
+    double ua = mode_ua(s) * scale;
+    int i;
+
+    if(!ps)
+        return;
+    for(i = 0; i < ENERGY_PERIPHERALS; ++i)
+    {
+        if(!(s->on & (1 << i)))
+            continue;
+        double p = (i < 3 ? peripheral_ua[i] : 0) * scale;
+        add(&peripherals[i], ps, p * ps);
+        ua += p;
+    }
+
+    double charge = ua * ps;
+    total_ps += ps;
+    total_charge += charge;
+    add(&modes[s->mode], ps, charge);
+    if(s->mode != ENERGY_ACTIVE)
+    {
+        add(&sleeping[s->mode], ps, charge);
+        return;
+    }
+    add(&contexts[s->vector < 0 ? 0 : 1 + s->vector / 2], ps, charge);
+    add(&functions[depth && depth <= MAX_DEPTH ? stack[depth - 1] : 0].b,
+        ps, charge);
+}
+
+// Instrumentation hooks.
+
+static int function_slot(void *fn)
+{
+    unsigned int i = ((uintptr_t)fn >> 4) % (MAX_FUNCTIONS - 1) + 1;
+    unsigned int n;
+    for(n = 1; n < MAX_FUNCTIONS; ++n)
+    {
+        if(functions[i].fn == fn)
+            return i;
+        if(!functions[i].fn)
+        {
+            functions[i].fn = fn;
+            return i;
+        }
+        i = i % (MAX_FUNCTIONS - 1) + 1;
+    }
+    return 0;
+}
+
+void __cyg_profile_func_enter(void *fn, void *site)
+{
+    (void)site;
+    if(depth < MAX_DEPTH)
+        stack[depth] = function_slot(fn);
+    depth++;
+}
+
+void __cyg_profile_func_exit(void *fn, void *site)
+{
+    (void)fn;
+    (void)site;
+    if(depth)
+        depth--;
+}
+
+// Function names from the executable's symbol table.
+
+static char *image;
+static const ElfW(Sym) *syms;
+static size_t num_syms;
+static const char *strs;
+static uintptr_t bias;
+
+static void load_symbols(void)
+{
+    FILE *f = fopen("/proc/self/exe", "rb");
+    long size;
+    size_t i;
+
+    if(!f)
+        return;
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    rewind(f);
+    image = malloc(size);
+    if(!image || fread(image, 1, size, f) != (size_t)size)
+    {
+        fclose(f);
+        return;
+    }
+    fclose(f);
+
+    const ElfW(Ehdr) *eh = (const ElfW(Ehdr) *)image;
+    const ElfW(Shdr) *sh = (const ElfW(Shdr) *)(image + eh->e_shoff);
+    for(i = 0; i < eh->e_shnum; ++i)
+    {
+        if(sh[i].sh_type != SHT_SYMTAB)
+            continue;
+        syms = (const ElfW(Sym) *)(image + sh[i].sh_offset);
+        num_syms = sh[i].sh_size / sizeof(ElfW(Sym));
+        strs = image + sh[sh[i].sh_link].sh_offset;
+    }
+
+    // Load address, for position independent executables.
+    for(i = 0; i < num_syms; ++i)
+        if(!strcmp(strs + syms[i].st_name, "energy_report"))
+            bias = (uintptr_t)energy_report - syms[i].st_value;
+}
+
+static const char *symbol(void *fn)
+{
+    static char hex[2 + 2 * sizeof(void *) + 1];
+    uintptr_t a = (uintptr_t)fn - bias;
+    size_t i;
+
+    for(i = 0; i < num_syms; ++i)
+    {
+        if(ELF64_ST_TYPE(syms[i].st_info) != STT_FUNC ||
+           syms[i].st_value != a)
+            continue;
+        const char *name = strs + syms[i].st_name;
+        return strcmp(name, "sim_app_main") ? name : "main";
+    }
+    snprintf(hex, sizeof(hex), "%p", fn);
+    return hex;
+}
+
+// Report.
+
+static const char *vector_name(int v)
+{
+    switch(v)
+    {
+    case 0: return "main";
+    case 1 + PORT1_VECTOR / 2: return "port1";
+    case 1 + PORT2_VECTOR / 2: return "port2";
+    case 1 + USI_VECTOR / 2: return "usi";
+    case 1 + ADC10_VECTOR / 2: return "adc10";
+    case 1 + TIMERA1_VECTOR / 2: return "timera1";
+    case 1 + TIMERA0_VECTOR / 2: return "timera0";
+    case 1 + WDT_VECTOR / 2: return "wdt";
+    default: return "?";
+    }
+}
+
+static void row(FILE *f, const char *name, const bucket *b)
+{
+    fprintf(f, "  %-28s %12.3f ms %12.3f uJ %6.2f%%\n", name,
+            b->ps * PS * 1e3, b->charge * PS * sim_vcc,
+            total_charge ? 100 * b->charge / total_charge : 0);
+}
+
+typedef struct
+{
+    const char *name;
+    const bucket *b;
+} named;
+
+static int by_name(const void *a, const void *b)
+{
+    return strcmp(((const named *)a)->name, ((const named *)b)->name);
+}
+
+double energy_average_ua(void)
+{
+    return total_ps ? total_charge / total_ps : 0;
+}
+
+void energy_report(FILE *f, double seconds)
+{
+    static named rows[MAX_FUNCTIONS + ENERGY_MODES];
+    double ua = total_ps ? total_charge / total_ps : 0;
+    int n = 0;
+    int i;
+
+    if(!image)
+        load_symbols();
+
+    fprintf(f, "run %.3f s at %.2f V, chip only\n", seconds, sim_vcc);
+    fprintf(f, "average %.3f uA, %.3f uW\n", ua, ua * sim_vcc);
+    for(i = 0; i < (int)(sizeof(batteries) / sizeof(batteries[0])); ++i)
+        fprintf(f, "%s %.0f mAh: %.1f days\n", batteries[i].name,
+                batteries[i].mah,
+                ua ? batteries[i].mah * 1e3 / ua / 24 : 0);
+
+    fprintf(f, "\nmode\n");
+    for(i = 0; i < ENERGY_MODES; ++i)
+        if(modes[i].ps)
+            row(f, mode_names[i], &modes[i]);
+
+    fprintf(f, "\ncontext (active)\n");
+    for(i = 0; i < (int)(sizeof(contexts) / sizeof(contexts[0])); ++i)
+        if(contexts[i].ps)
+            row(f, vector_name(i), &contexts[i]);
+
+    fprintf(f, "\nperipheral on\n");
+    for(i = 0; i < ENERGY_PERIPHERALS; ++i)
+        if(peripherals[i].ps)
+            row(f, peripheral_names[i], &peripherals[i]);
+
+    // By name so that reports of two builds diff line by line.
+    for(i = 0; i < MAX_FUNCTIONS; ++i)
+    {
+        if(!functions[i].b.ps)
+            continue;
+        rows[n].name = i ? symbol(functions[i].fn) : "(not instrumented)";
+        rows[n].b = &functions[i].b;
+        // symbol() reuses its buffer for unnamed functions.
+        if(rows[n].name[0] == '0')
+            rows[n].name = strdup(rows[n].name);
+        n++;
+    }
+    for(i = 0; i < ENERGY_MODES; ++i)
+    {
+        if(!sleeping[i].ps)
+            continue;
+        rows[n].name = sleep_names[i];
+        rows[n].b = &sleeping[i];
+        n++;
+    }
+    qsort(rows, n, sizeof(rows[0]), by_name);
+    fprintf(f, "\nfunction\n");
+    for(i = 0; i < n; ++i)
+        row(f, rows[i].name, rows[i].b);
+}
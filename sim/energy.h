@@ -0,0 +1,59 @@
+#ifndef ENERGY_H_
+#define ENERGY_H_
+
+#include <stdio.h>
+
+// Supply current model and energy accounting, fed by sim.c.
+//
+// Currents are typical MSP430G2x31/G2x52 datasheet figures at 3 V,
+// scaled with VCC. They cover the chip only: leds and other loads on the
+// pins are not counted.
+//
+// Firmware built with -finstrument-functions is also profiled per
+// function: time with the CPU on goes to the innermost function being
+// run, LPM time to the mode.
+
+// Operating modes, indexes into the mode table.
+enum
+{
+    ENERGY_ACTIVE,
+    ENERGY_LPM0,
+    ENERGY_LPM1,
+    ENERGY_LPM2,
+    ENERGY_LPM3,
+    ENERGY_LPM4,
+    ENERGY_MODES
+};
+
+// Peripherals that are on.
+#define ENERGY_ADC10  0x01 // Converting.
+#define ENERGY_REF    0x02 // REFON.
+#define ENERGY_SENSOR 0x04 // ADC10ON with the temperature sensor selected.
+#define ENERGY_TIMER  0x08 // Timer_A counting.
+#define ENERGY_USI    0x10 // USI out of reset.
+#define ENERGY_WDT    0x20 // Watchdog counting.
+#define ENERGY_PERIPHERALS 6
+
+typedef struct
+{
+    int mode;
+    int vector;      // Interrupt being served, -1 in main.
+    unsigned int on; // ENERGY_* peripheral bits.
+    double mclk_mhz;
+    double dco_mhz;
+    int lfxt;        // ACLK from a 32 kHz crystal, not the VLO.
+} energy_state;
+
+// The -finstrument-functions hooks. sim.c also calls them around ISR
+// entry and exit so those cycles go to the ISR.
+void __cyg_profile_func_enter(void *fn, void *site);
+void __cyg_profile_func_exit(void *fn, void *site);
+
+void energy_reset(void);
+// Accounts ps picoseconds spent in state s.
+void energy_add(const energy_state *s, unsigned long long ps);
+void energy_report(FILE *f, double seconds);
+// Average supply current so far in uA, for harness checks.
+double energy_average_ua(void);
+
+#endif
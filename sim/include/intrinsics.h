@@ -0,0 +1,27 @@
+#ifndef SIM_INTRINSICS_H_
+#define SIM_INTRINSICS_H_
+
+// Host replacement for mspgcc's <intrinsics.h>, implemented in ../sim.c.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void __eint(void);
+void __dint(void);
+void __nop(void);
+unsigned int __read_status_register(void);
+void __write_status_register(unsigned int sr);
+void __bis_status_register(unsigned int bits);
+void __bic_status_register(unsigned int bits);
+void __bis_status_register_on_exit(unsigned int bits);
+void __bic_status_register_on_exit(unsigned int bits);
+void __delay_cycles(unsigned long cycles);
+unsigned int __bcd_add_short(unsigned int a, unsigned int b);
+unsigned long __bcd_add_long(unsigned long a, unsigned long b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
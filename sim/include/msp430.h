@@ -0,0 +1,440 @@
+#ifndef SIM_MSP430_H_
+#define SIM_MSP430_H_
+
+// Host replacement for <msp430.h> used by the simulator build.
+//
+// Covers the MSP430G2231/G2452 peripherals modelled in ../sim.c. Every
+// register access goes through sim_reg8()/sim_reg16(), which lets the
+// simulator see writes, update read-only state (P1IN, TAIV, ...) and
+// advance time. Word registers are 16 bits wide even though int is 32
+// bits on the host.
+//
+// Interrupt handlers declared with __attribute__((__interrupt__(VEC)))
+// are placed in section sim_isr_<VEC>, where the simulator finds them.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+volatile unsigned char *sim_reg8(unsigned int addr);
+volatile unsigned short *sim_reg16(unsigned int addr);
+void sim_adc10sa(volatile void *block);
+
+#ifdef __cplusplus
+// The firmware main, renamed by the Makefile. C++ firmware gets C linkage
+// from this declaration so the harness can call it.
+int sim_app_main(void);
+}
+#endif
+
+#define SIM_STR_(x) #x
+#define SIM_STR(x) SIM_STR_(x)
+#define __interrupt__(vec) section("sim_isr_" SIM_STR(vec)), used
+
+#define SFR_8BIT(addr)  (*sim_reg8(addr))
+#define SFR_16BIT(addr) (*sim_reg16(addr))
+
+#define BIT0 0x0001
+#define BIT1 0x0002
+#define BIT2 0x0004
+#define BIT3 0x0008
+#define BIT4 0x0010
+#define BIT5 0x0020
+#define BIT6 0x0040
+#define BIT7 0x0080
+#define BIT8 0x0100
+#define BIT9 0x0200
+#define BITA 0x0400
+#define BITB 0x0800
+#define BITC 0x1000
+#define BITD 0x2000
+#define BITE 0x4000
+#define BITF 0x8000
+
+// Status register.
+#define C       0x0001
+#define Z       0x0002
+#define N       0x0004
+#define V       0x0100
+#define GIE     0x0008
+#define CPUOFF  0x0010
+#define OSCOFF  0x0020
+#define SCG0    0x0040
+#define SCG1    0x0080
+
+#define LPM0_bits (CPUOFF)
+#define LPM1_bits (SCG0 | CPUOFF)
+#define LPM2_bits (SCG1 | CPUOFF)
+#define LPM3_bits (SCG1 | SCG0 | CPUOFF)
+#define LPM4_bits (SCG1 | SCG0 | OSCOFF | CPUOFF)
+
+#define LPM0      __bis_status_register(LPM0_bits)
+#define LPM0_EXIT __bic_status_register_on_exit(LPM0_bits)
+#define LPM3      __bis_status_register(LPM3_bits)
+#define LPM3_EXIT __bic_status_register_on_exit(LPM3_bits)
+#define LPM4      __bis_status_register(LPM4_bits)
+#define LPM4_EXIT __bic_status_register_on_exit(LPM4_bits)
+
+// Special function registers.
+#define IE1  SFR_8BIT(0x0000)
+#define IFG1 SFR_8BIT(0x0002)
+#define WDTIE   0x01
+#define OFIE    0x02
+#define WDTIFG  0x01
+#define OFIFG   0x02
+
+// Watchdog timer+.
+#define WDTCTL SFR_16BIT(0x0120)
+#define WDTPW    0x5A00
+#define WDTHOLD  0x0080
+#define WDTNMIES 0x0040
+#define WDTNMI   0x0020
+#define WDTTMSEL 0x0010
+#define WDTCNTCL 0x0008
+#define WDTSSEL  0x0004
+#define WDTIS1   0x0002
+#define WDTIS0   0x0001
+// Interval timer from SMCLK (1 Mhz assumed in the names).
+#define WDT_MDLY_32   (WDTPW | WDTTMSEL | WDTCNTCL)
+#define WDT_MDLY_8    (WDTPW | WDTTMSEL | WDTCNTCL | WDTIS0)
+#define WDT_MDLY_0_5  (WDTPW | WDTTMSEL | WDTCNTCL | WDTIS1)
+#define WDT_MDLY_0_064 (WDTPW | WDTTMSEL | WDTCNTCL | WDTIS1 | WDTIS0)
+// Interval timer from ACLK (32768 Hz assumed in the names).
+#define WDT_ADLY_1000 (WDTPW | WDTTMSEL | WDTCNTCL | WDTSSEL)
+#define WDT_ADLY_250  (WDTPW | WDTTMSEL | WDTCNTCL | WDTSSEL | WDTIS0)
+#define WDT_ADLY_16   (WDTPW | WDTTMSEL | WDTCNTCL | WDTSSEL | WDTIS1)
+#define WDT_ADLY_1_9  (WDTPW | WDTTMSEL | WDTCNTCL | WDTSSEL | WDTIS1 | WDTIS0)
+
+// Basic clock module+.
+#define DCOCTL  SFR_8BIT(0x0056)
+#define BCSCTL1 SFR_8BIT(0x0057)
+#define BCSCTL2 SFR_8BIT(0x0058)
+#define BCSCTL3 SFR_8BIT(0x0053)
+
+#define MOD0 0x01
+#define MOD1 0x02
+#define MOD2 0x04
+#define MOD3 0x08
+#define MOD4 0x10
+#define DCO0 0x20
+#define DCO1 0x40
+#define DCO2 0x80
+
+#define RSEL0  0x01
+#define RSEL1  0x02
+#define RSEL2  0x04
+#define RSEL3  0x08
+#define DIVA0  0x10
+#define DIVA1  0x20
+#define XTS    0x40
+#define XT2OFF 0x80
+#define DIVA_0 0x00
+#define DIVA_1 0x10
+#define DIVA_2 0x20
+#define DIVA_3 0x30
+
+#define DIVS0  0x02
+#define DIVS1  0x04
+#define SELS   0x08
+#define DIVM0  0x10
+#define DIVM1  0x20
+#define SELM0  0x40
+#define SELM1  0x80
+#define DIVS_0 0x00
+#define DIVS_1 0x02
+#define DIVS_2 0x04
+#define DIVS_3 0x06
+#define DIVM_0 0x00
+#define DIVM_1 0x10
+#define DIVM_2 0x20
+#define DIVM_3 0x30
+#define SELM_0 0x00
+#define SELM_2 0x80
+#define SELM_3 0xC0
+
+#define LFXT1OF 0x01
+#define XT2OF   0x02
+#define XCAP0   0x04
+#define XCAP1   0x08
+#define LFXT1S0 0x10
+#define LFXT1S1 0x20
+#define XCAP_0  0x00
+#define XCAP_1  0x04
+#define XCAP_2  0x08
+#define XCAP_3  0x0C
+#define LFXT1S_0 0x00
+#define LFXT1S_2 0x20
+#define LFXT1S_3 0x30
+
+// Calibration data in the TLV segment (info memory A).
+#define TLV_BYTE(addr) SFR_8BIT(addr)
+#define TLV_WORD(addr) SFR_16BIT(addr)
+#define CALDCO_16MHZ SFR_8BIT(0x10F8)
+#define CALBC1_16MHZ SFR_8BIT(0x10F9)
+#define CALDCO_12MHZ SFR_8BIT(0x10FA)
+#define CALBC1_12MHZ SFR_8BIT(0x10FB)
+#define CALDCO_8MHZ  SFR_8BIT(0x10FC)
+#define CALBC1_8MHZ  SFR_8BIT(0x10FD)
+#define CALDCO_1MHZ  SFR_8BIT(0x10FE)
+#define CALBC1_1MHZ  SFR_8BIT(0x10FF)
+
+// Port 1 and 2.
+#define P1IN  SFR_8BIT(0x0020)
+#define P1OUT SFR_8BIT(0x0021)
+#define P1DIR SFR_8BIT(0x0022)
+#define P1IFG SFR_8BIT(0x0023)
+#define P1IES SFR_8BIT(0x0024)
+#define P1IE  SFR_8BIT(0x0025)
+#define P1SEL SFR_8BIT(0x0026)
+#define P1REN SFR_8BIT(0x0027)
+#define P1SEL2 SFR_8BIT(0x0041)
+#define P2IN  SFR_8BIT(0x0028)
+#define P2OUT SFR_8BIT(0x0029)
+#define P2DIR SFR_8BIT(0x002A)
+#define P2IFG SFR_8BIT(0x002B)
+#define P2IES SFR_8BIT(0x002C)
+#define P2IE  SFR_8BIT(0x002D)
+#define P2SEL SFR_8BIT(0x002E)
+#define P2REN SFR_8BIT(0x002F)
+
+// Timer_A.
+#define TAIV    SFR_16BIT(0x012E)
+#define TACTL   SFR_16BIT(0x0160)
+#define TACCTL0 SFR_16BIT(0x0162)
+#define TACCTL1 SFR_16BIT(0x0164)
+#define TACCTL2 SFR_16BIT(0x0166)
+#define TAR     SFR_16BIT(0x0170)
+#define TACCR0  SFR_16BIT(0x0172)
+#define TACCR1  SFR_16BIT(0x0174)
+#define TACCR2  SFR_16BIT(0x0176)
+#define TA0IV    TAIV
+#define TA0CTL   TACTL
+#define TA0CCTL0 TACCTL0
+#define TA0CCTL1 TACCTL1
+#define TA0CCTL2 TACCTL2
+#define TA0R     TAR
+#define TA0CCR0  TACCR0
+#define TA0CCR1  TACCR1
+#define TA0CCR2  TACCR2
+
+#define TASSEL1 0x0200
+#define TASSEL0 0x0100
+#define ID1     0x0080
+#define ID0     0x0040
+#define MC1     0x0020
+#define MC0     0x0010
+#define TACLR   0x0004
+#define TAIE    0x0002
+#define TAIFG   0x0001
+#define TASSEL_0 0x0000
+#define TASSEL_1 0x0100
+#define TASSEL_2 0x0200
+#define TASSEL_3 0x0300
+#define ID_0    0x0000
+#define ID_1    0x0040
+#define ID_2    0x0080
+#define ID_3    0x00C0
+#define MC_0    0x0000
+#define MC_1    0x0010
+#define MC_2    0x0020
+#define MC_3    0x0030
+
+#define CM1     0x8000
+#define CM0     0x4000
+#define CCIS1   0x2000
+#define CCIS0   0x1000
+#define SCS     0x0800
+#define SCCI    0x0400
+#define CAP     0x0100
+#define OUTMOD2 0x0080
+#define OUTMOD1 0x0040
+#define OUTMOD0 0x0020
+#define CCIE    0x0010
+#define CCI     0x0008
+#define OUT     0x0004
+#define COV     0x0002
+#define CCIFG   0x0001
+#define OUTMOD_0 0x0000
+#define OUTMOD_1 0x0020
+#define OUTMOD_2 0x0040
+#define OUTMOD_3 0x0060
+#define OUTMOD_4 0x0080
+#define OUTMOD_5 0x00A0
+#define OUTMOD_6 0x00C0
+#define OUTMOD_7 0x00E0
+#define CM_0 0x0000
+#define CM_1 0x4000
+#define CM_2 0x8000
+#define CM_3 0xC000
+#define CCIS_0 0x0000
+#define CCIS_1 0x1000
+#define CCIS_2 0x2000
+#define CCIS_3 0x3000
+
+#define TAIV_NONE    0x0000
+#define TAIV_TACCR1  0x0002
+#define TAIV_TACCR2  0x0004
+#define TAIV_TAIFG   0x000A
+
+// USI.
+#define USICTL0  SFR_8BIT(0x0078)
+#define USICTL1  SFR_8BIT(0x0079)
+#define USICKCTL SFR_8BIT(0x007A)
+#define USICNT   SFR_8BIT(0x007B)
+#define USISRL   SFR_8BIT(0x007C)
+#define USISRH   SFR_8BIT(0x007D)
+#define USICTL   SFR_16BIT(0x0078)
+#define USICCTL  SFR_16BIT(0x007A)
+#define USISR    SFR_16BIT(0x007C)
+
+#define USIPE7   0x80
+#define USIPE6   0x40
+#define USIPE5   0x20
+#define USILSB   0x10
+#define USIMST   0x08
+#define USIGE    0x04
+#define USIOE    0x02
+#define USISWRST 0x01
+
+#define USICKPH   0x80
+#define USII2C    0x40
+#define USISTTIE  0x20
+#define USIIE     0x10
+#define USIAL     0x08
+#define USISTP    0x04
+#define USISTTIFG 0x02
+#define USIIFG    0x01
+
+#define USIDIV2  0x80
+#define USIDIV1  0x40
+#define USIDIV0  0x20
+#define USISSEL2 0x10
+#define USISSEL1 0x08
+#define USISSEL0 0x04
+#define USICKPL  0x02
+#define USISWCLK 0x01
+#define USIDIV_0 0x00
+#define USIDIV_1 0x20
+#define USIDIV_2 0x40
+#define USIDIV_3 0x60
+#define USIDIV_4 0x80
+#define USIDIV_5 0xA0
+#define USIDIV_6 0xC0
+#define USIDIV_7 0xE0
+#define USISSEL_0 0x00
+#define USISSEL_1 0x04
+#define USISSEL_2 0x08
+#define USISSEL_3 0x0C
+#define USISSEL_4 0x10
+#define USISSEL_5 0x14
+#define USISSEL_6 0x18
+#define USISSEL_7 0x1C
+
+#define USISCLREL 0x80
+#define USI16B    0x40
+#define USIIFGCC  0x20
+
+// ADC10.
+#define ADC10DTC0 SFR_8BIT(0x0048)
+#define ADC10DTC1 SFR_8BIT(0x0049)
+#define ADC10AE0  SFR_8BIT(0x004A)
+#define ADC10CTL0 SFR_16BIT(0x01B0)
+#define ADC10CTL1 SFR_16BIT(0x01B2)
+#define ADC10MEM  SFR_16BIT(0x01B4)
+#define ADC10SA   SFR_16BIT(0x01BC)
+// Starts the DTC at block, an array of unsigned int. Host pointers don't
+// fit ADC10SA, so firmware that uses the DTC sets it with this.
+#define ADC10SA_SET(block) sim_adc10sa(block)
+
+#define ADC10SC   0x0001
+#define ENC       0x0002
+#define ADC10IFG  0x0004
+#define ADC10IE   0x0008
+#define ADC10ON   0x0010
+#define REFON     0x0020
+#define REF2_5V   0x0040
+#define MSC       0x0080
+#define REFBURST  0x0100
+#define REFOUT    0x0200
+#define ADC10SR   0x0400
+#define ADC10SHT0 0x0800
+#define ADC10SHT1 0x1000
+#define SREF0     0x2000
+#define SREF1     0x4000
+#define SREF2     0x8000
+#define ADC10SHT_0 0x0000
+#define ADC10SHT_1 0x0800
+#define ADC10SHT_2 0x1000
+#define ADC10SHT_3 0x1800
+#define SREF_0    0x0000
+#define SREF_1    0x2000
+#define SREF_2    0x4000
+#define SREF_3    0x6000
+
+#define ADC10BUSY  0x0001
+#define CONSEQ0    0x0002
+#define CONSEQ1    0x0004
+#define ADC10SSEL0 0x0008
+#define ADC10SSEL1 0x0010
+#define ADC10DIV0  0x0020
+#define ADC10DIV1  0x0040
+#define ADC10DIV2  0x0080
+#define ISSH       0x0100
+#define ADC10DF    0x0200
+#define SHS0       0x0400
+#define SHS1       0x0800
+#define INCH0      0x1000
+#define INCH1      0x2000
+#define INCH2      0x4000
+#define INCH3      0x8000
+#define CONSEQ_0   0x0000
+#define CONSEQ_1   0x0002
+#define CONSEQ_2   0x0004
+#define CONSEQ_3   0x0006
+#define ADC10SSEL_0 0x0000
+#define ADC10SSEL_1 0x0008
+#define ADC10SSEL_2 0x0010
+#define ADC10SSEL_3 0x0018
+#define ADC10DIV_0 0x0000
+#define ADC10DIV_1 0x0020
+#define ADC10DIV_2 0x0040
+#define ADC10DIV_3 0x0060
+#define ADC10DIV_4 0x0080
+#define ADC10DIV_5 0x00A0
+#define ADC10DIV_6 0x00C0
+#define ADC10DIV_7 0x00E0
+#define SHS_0      0x0000
+#define SHS_1      0x0400
+#define INCH_0     0x0000
+#define INCH_1     0x1000
+#define INCH_2     0x2000
+#define INCH_3     0x3000
+#define INCH_4     0x4000
+#define INCH_5     0x5000
+#define INCH_6     0x6000
+#define INCH_7     0x7000
+#define INCH_8     0x8000
+#define INCH_9     0x9000
+#define INCH_10    0xA000
+#define INCH_11    0xB000
+
+#define ADC10TB    0x08
+#define ADC10CT    0x04
+#define ADC10B1    0x02
+#define ADC10FETCH 0x01
+
+// Interrupt vectors (offset from 0xFFE0).
+#define PORT1_VECTOR       4
+#define PORT2_VECTOR       6
+#define USI_VECTOR         8
+#define ADC10_VECTOR       10
+#define TIMERA1_VECTOR     16
+#define TIMERA0_VECTOR     18
+#define TIMER0_A1_VECTOR   16
+#define TIMER0_A0_VECTOR   18
+#define WDT_VECTOR         20
+#define COMPARATORA_VECTOR 22
+#define NMI_VECTOR         28
+#define RESET_VECTOR       30
+
+#endif
@@ -0,0 +1,1658 @@
+#include "sim.h"
+
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bit and vector names only, the register macros aren't used here.
+#include "include/msp430.h"
+#include "energy.h"
+
+typedef unsigned long long ps_t; // Picoseconds.
+#define NEVER (~0ULL)
+#define US ((ps_t)1000000)
+
+// Register addresses.
+#define A_IE1       0x0000
+#define A_IFG1      0x0002
+#define A_P1IN      0x0020
+#define A_P1OUT     0x0021
+#define A_P1DIR     0x0022
+#define A_P1IFG     0x0023
+#define A_P1IES     0x0024
+#define A_P1IE      0x0025
+#define A_P1SEL     0x0026
+#define A_P1REN     0x0027
+#define A_P2IFG     0x002B
+#define A_P2IE      0x002D
+#define A_BCSCTL3   0x0053
+#define A_DCOCTL    0x0056
+#define A_BCSCTL1   0x0057
+#define A_BCSCTL2   0x0058
+#define A_USICTL0   0x0078
+#define A_USICTL1   0x0079
+#define A_USICKCTL  0x007A
+#define A_USICNT    0x007B
+#define A_USISRL    0x007C
+#define A_USISRH    0x007D
+#define A_WDTCTL    0x0120
+#define A_TAIV      0x012E
+#define A_TACTL     0x0160
+#define A_TACCTL0   0x0162
+#define A_TAR       0x0170
+#define A_TACCR0    0x0172
+#define A_ADC10CTL0 0x01B0
+#define A_ADC10CTL1 0x01B2
+#define A_ADC10MEM  0x01B4
+#define A_ADC10SA   0x01BC
+#define A_ADC10DTC0 0x0048
+#define A_ADC10DTC1 0x0049
+#define A_TLV       0x10C0
+#define A_CAL       0x10F8
+
+// Calibration constants programmed into the simulated TLV, (DCOCTL,
+// BCSCTL1) for 16, 12, 8 and 1 Mhz.
+static const unsigned char cal[4][2] =
+    {{0x95, 0x8F}, {0x9E, 0x8E}, {0x92, 0x8D}, {0xB5, 0x86}};
+static const double cal_hz[4] = {16e6, 12e6, 8e6, 1e6};
+
+double sim_temp_c = 25.0;
+double sim_temp_offset = 0;
+int sim_tlv_adc = 1;
+void (*sim_isr_done)(int vector, double irq_us);
+void (*sim_access)(unsigned int addr);
+double sim_vcc = 3.3;
+double sim_vlo_hz = 12000;
+double sim_adc_volts[8];
+
+static unsigned char mem[0x10000] __attribute__ ((aligned(2)));
+// Last value the simulator knows about, firmware writes differ from it.
+static unsigned char shadow[0x10000] __attribute__ ((aligned(2)));
+static unsigned int last_addr;
+static unsigned char last_size;
+
+static ps_t now;
+static ps_t deadline;
+static jmp_buf run_end;
+static int running;
+
+static unsigned int sr;
+static unsigned int isr_sr[8];
+static int isr_vec[8];
+static ps_t isr_since[8]; // When the interrupt being served was requested.
+static int isr_depth;
+
+static double dco_hz;
+static double mclk_ps;
+static double smclk_ps; // 0 when gated.
+static double aclk_ps;
+
+static unsigned char pins;
+static unsigned char ext_mask;
+static unsigned char ext_level;
+static sim_device *devices;
+
+static unsigned char ta_out[3];
+static int ta_down;
+static ps_t ta_due = NEVER;
+static ps_t ta_match[3]; // When each TACCRn last matched TAR.
+
+static int usi_edge; // 0: next edge leads, 1: trails.
+static unsigned char usi_sclk;
+static unsigned char usi_sdo;
+static unsigned char usi_src_count;
+static ps_t usi_due = NEVER;
+
+static ps_t adc_due = NEVER;
+static ps_t ref_on_at;
+static unsigned int adc_chan;  // Channel being converted.
+static int adc_next = -1;      // Next channel of a sequence without MSC,
+                               // waiting for ADC10SC.
+static unsigned int *dtc_block; // From ADC10SA_SET().
+static unsigned int dtc_index;  // Transfers since ADC10SA was written.
+
+static ps_t wdt_due = NEVER;
+
+typedef struct
+{
+    ps_t t;
+    void (*fn)(void *arg);
+    void *arg;
+} sim_event;
+
+#define MAX_EVENTS 256
+static sim_event events[MAX_EVENTS];
+static int num_events;
+
+static void run_until(ps_t t);
+static void pins_update(void);
+static void access(unsigned int addr, unsigned char size);
+static void sync(void);
+
+// Memory.
+
+static unsigned char r8(unsigned int a)
+{
+    return mem[a];
+}
+
+static unsigned int r16(unsigned int a)
+{
+    return *(uint16_t *)&mem[a];
+}
+
+static void w8(unsigned int a, unsigned char v)
+{
+    mem[a] = shadow[a] = v;
+}
+
+static void w16(unsigned int a, unsigned int v)
+{
+    *(uint16_t *)&mem[a] = *(uint16_t *)&shadow[a] = v;
+}
+
+static unsigned int old16(unsigned int a)
+{
+    return *(uint16_t *)&shadow[a];
+}
+
+static void keep(unsigned int a, unsigned char size)
+{
+    memcpy(&shadow[a], &mem[a], size);
+}
+
+static void restore(unsigned int a, unsigned char size)
+{
+    memcpy(&mem[a], &shadow[a], size);
+}
+
+static ps_t ps(double cycles, double period)
+{
+    return (ps_t)(cycles * period + 0.5);
+}
+
+// Violations.
+
+#define MAX_KINDS 64
+#define PRINT_PER_KIND 5
+
+static struct
+{
+    const char *who;
+    const char *fmt;
+    int count;
+} kinds[MAX_KINDS];
+static int num_kinds;
+static int violations;
+
+void sim_violation(const char *who, const char *fmt, ...)
+{
+    int i;
+    for(i = 0; i < num_kinds; ++i)
+        if(kinds[i].fmt == fmt && !strcmp(kinds[i].who, who))
+            break;
+    if(i == num_kinds && num_kinds < MAX_KINDS)
+    {
+        kinds[i].who = who;
+        kinds[i].fmt = fmt;
+        kinds[i].count = 0;
+        num_kinds++;
+    }
+
+    violations++;
+    if(i < MAX_KINDS && kinds[i].count++ >= PRINT_PER_KIND)
+        return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "[%10.3f ms] %s: ", now / 1e9, who);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+int sim_violations(void)
+{
+    return violations;
+}
+
+static void end_run(void)
+{
+    longjmp(run_end, 1);
+}
+
+// Basic clock module.
+
+static double dco_freq(unsigned char rsel, unsigned char dcoctl)
+{
+    int i;
+    for(i = 0; i < 4; ++i)
+        if(dcoctl == cal[i][0] && rsel == (cal[i][1] & 0x0f))
+            return cal_hz[i];
+
+    // Roughly 35% per RSEL step and 8% per DCO step, around 1 Mhz.
+    double dco = (dcoctl >> 5) + (dcoctl & 0x1f) / 32.0;
+    double dco_1mhz = (cal[3][0] >> 5) + (cal[3][0] & 0x1f) / 32.0;
+    double f = 1e6;
+    for(i = rsel; i < (cal[3][1] & 0x0f); ++i)
+        f /= 1.35;
+    for(i = cal[3][1] & 0x0f; i < rsel; ++i)
+        f *= 1.35;
+    while(dco < dco_1mhz - 0.5)
+        f /= 1.08, dco += 1;
+    while(dco > dco_1mhz + 0.5)
+        f *= 1.08, dco -= 1;
+    return f;
+}
+
+static void ta_schedule(void);
+static void wdt_schedule(void);
+static void wdt_clock_changed(void);
+static void usi_schedule(void);
+
+static void clocks_update(void)
+{
+    unsigned char bc1 = r8(A_BCSCTL1);
+    unsigned char bc2 = r8(A_BCSCTL2);
+    unsigned char bc3 = r8(A_BCSCTL3);
+    double lf = ((bc3 & LFXT1S_3) == LFXT1S_2) ? sim_vlo_hz : 32768.0;
+
+    dco_hz = dco_freq(bc1 & 0x0f, r8(A_DCOCTL));
+    double mclk = ((bc2 & SELM1) ? lf : dco_hz) / (1 << ((bc2 >> 4) & 3));
+    double smclk = ((bc2 & SELS) ? lf : dco_hz) / (1 << ((bc2 >> 1) & 3));
+    double aclk = lf / (1 << ((bc1 >> 4) & 3));
+
+    double m = 1e12 / mclk;
+    double s = (sr & SCG1) ? 0 : 1e12 / smclk;
+    double a = (sr & OSCOFF) ? 0 : 1e12 / aclk;
+    if(m == mclk_ps && s == smclk_ps && a == aclk_ps)
+        return;
+    mclk_ps = m;
+    smclk_ps = s;
+    aclk_ps = a;
+    ta_schedule();
+    wdt_clock_changed();
+    usi_schedule();
+}
+
+// The last access's write is only applied on the next one, a clock
+// register's included.
+double sim_mclk_hz(void)
+{
+    sync();
+    return 1e12 / mclk_ps;
+}
+
+double sim_smclk_hz(void)
+{
+    sync();
+    return smclk_ps ? 1e12 / smclk_ps : 0;
+}
+
+// Port 1.
+
+static unsigned char pins_compute(void)
+{
+    unsigned char dir = r8(A_P1DIR);
+    unsigned char out = r8(A_P1OUT);
+    unsigned char sel = r8(A_P1SEL);
+    unsigned char ren = r8(A_P1REN);
+    unsigned char usi = r8(A_USICTL0);
+
+    unsigned char enable = dir & ~sel;
+    unsigned char level = out & enable;
+
+    // TA0.0 on P1.1 and P1.5, TA0.1 on P1.2 and P1.6.
+    unsigned char ta = sel & dir & (BIT1 | BIT5 | BIT2 | BIT6);
+    enable |= ta;
+    if(ta_out[0])
+        level |= ta & (BIT1 | BIT5);
+    if(ta_out[1])
+        level |= ta & (BIT2 | BIT6);
+
+    // USI pins take over P1.5 to P1.7.
+    if(usi & USIPE5)
+    {
+        enable &= ~BIT5;
+        level &= ~BIT5;
+        if(usi & USIMST)
+        {
+            enable |= BIT5;
+            level |= usi_sclk ? BIT5 : 0;
+        }
+    }
+    if(usi & USIPE6)
+    {
+        enable &= ~BIT6;
+        level &= ~BIT6;
+        if(usi & USIOE)
+        {
+            enable |= BIT6;
+            level |= usi_sdo ? BIT6 : 0;
+        }
+    }
+    if(usi & USIPE7)
+    {
+        enable &= ~BIT7;
+        level &= ~BIT7;
+    }
+
+    // Inputs: external drive, then pull resistor. Floating pins read low
+    // so that devices don't see edges when the pins become outputs.
+    unsigned char in = (ext_level & ext_mask) | (~ext_mask & ren & out);
+    return level | (in & ~enable);
+}
+
+static void pins_update(void)
+{
+    if(!running)
+        return;
+
+    unsigned char old = pins;
+    pins = pins_compute();
+    w8(A_P1IN, pins);
+    if(pins == old)
+        return;
+
+    unsigned char rising = ~old & pins;
+    unsigned char falling = old & ~pins;
+    unsigned char ies = r8(A_P1IES);
+    unsigned char edge = ((rising & ~ies) | (falling & ies)) & ~r8(A_P1SEL);
+    if(edge)
+        w8(A_P1IFG, r8(A_P1IFG) | edge);
+
+    sim_device *d;
+    for(d = devices; d; d = d->next)
+        d->pins(d, old, pins);
+}
+
+void sim_attach(sim_device *dev)
+{
+    dev->next = devices;
+    devices = dev;
+}
+
+void sim_detach(sim_device *dev)
+{
+    sim_device **d;
+    for(d = &devices; *d; d = &(*d)->next)
+    {
+        if(*d == dev)
+        {
+            *d = dev->next;
+            return;
+        }
+    }
+}
+
+void sim_drive(unsigned char mask, unsigned char level)
+{
+    ext_mask |= mask;
+    ext_level = (ext_level & ~mask) | (level & mask);
+    pins_update();
+}
+
+void sim_release(unsigned char mask)
+{
+    ext_mask &= ~mask;
+    pins_update();
+}
+
+unsigned char sim_port1(void)
+{
+    return pins;
+}
+
+// USI, SPI master only.
+
+static void usi_clock(void);
+
+static double usi_src_ps(void)
+{
+    switch((r8(A_USICKCTL) >> 2) & 7)
+    {
+    case 1:
+        return aclk_ps;
+    case 2:
+    case 3:
+        return smclk_ps;
+    default:
+        // SCLK, USISWCLK and TACCRx edges are counted as they come.
+        return 0;
+    }
+}
+
+static unsigned char usi_msb(void)
+{
+    unsigned int sr16 = r16(A_USISRL);
+    if(r8(A_USICTL0) & USILSB)
+        return sr16 & 1;
+    if(r8(A_USICNT) & USI16B)
+        return (sr16 >> 15) & 1;
+    return (sr16 >> 7) & 1;
+}
+
+static void usi_schedule(void)
+{
+    double src = usi_src_ps();
+    if(!(r8(A_USICNT) & 0x1f) || !src)
+    {
+        usi_due = NEVER;
+        return;
+    }
+    // Two SCLK edges per divided clock period.
+    usi_due = now + ps((1 << (r8(A_USICKCTL) >> 5)) / 2.0, src);
+}
+
+static void usi_start(void)
+{
+    unsigned char ctl0 = r8(A_USICTL0);
+    if(!(r8(A_USICNT) & 0x1f) || (ctl0 & USISWRST))
+        return;
+    if(!(ctl0 & USIMST))
+    {
+        sim_violation("usi", "slave mode is not modelled");
+        return;
+    }
+    if(!(r8(A_USICNT) & USIIFGCC))
+        w8(A_USICTL1, r8(A_USICTL1) & ~USIIFG);
+    usi_edge = 0;
+    usi_src_count = 0;
+    // Data is captured on the first edge with USICKPH, so it has to be
+    // out before it.
+    if(r8(A_USICTL1) & USICKPH)
+    {
+        usi_sdo = usi_msb();
+        pins_update();
+    }
+    usi_schedule();
+}
+
+// One SCLK edge.
+static void usi_clock(void)
+{
+    unsigned char ckctl = r8(A_USICKCTL);
+    unsigned char ctl0 = r8(A_USICTL0);
+    unsigned char ctl1 = r8(A_USICTL1);
+    unsigned char cnt = r8(A_USICNT);
+    int capture = (usi_edge == 0) == !!(ctl1 & USICKPH);
+
+    if(!(cnt & 0x1f))
+        return;
+
+    // Leading edge goes away from the idle level.
+    usi_sclk = usi_edge ? (ckctl & USICKPL) != 0 : !(ckctl & USICKPL);
+
+    if(capture)
+    {
+        unsigned int in = (ctl0 & USIPE7) ? (pins >> 7) & 1 : 0;
+        if(cnt & USI16B)
+        {
+            unsigned int sr16 = r16(A_USISRL);
+            if(ctl0 & USILSB)
+                sr16 = (sr16 >> 1) | (in << 15);
+            else
+                sr16 = (sr16 << 1) | in;
+            w16(A_USISRL, sr16);
+        }
+        else
+        {
+            unsigned char sr8 = r8(A_USISRL);
+            if(ctl0 & USILSB)
+                sr8 = (sr8 >> 1) | (in << 7);
+            else
+                sr8 = (sr8 << 1) | in;
+            w8(A_USISRL, sr8);
+        }
+    }
+    else
+    {
+        usi_sdo = usi_msb();
+    }
+
+    if(usi_edge)
+    {
+        cnt = (cnt & ~0x1f) | ((cnt & 0x1f) - 1);
+        w8(A_USICNT, cnt);
+        if(!(cnt & 0x1f))
+            w8(A_USICTL1, r8(A_USICTL1) | USIIFG);
+    }
+    usi_edge = !usi_edge;
+    pins_update();
+}
+
+static void usi_fire(void)
+{
+    usi_clock();
+    usi_schedule();
+}
+
+// A rising edge of an edge counted source.
+static void usi_source_edge(void)
+{
+    if(!(r8(A_USICNT) & 0x1f))
+        return;
+    if(++usi_src_count < (1 << (r8(A_USICKCTL) >> 5)))
+        return;
+    usi_src_count = 0;
+    usi_clock();
+    usi_clock();
+}
+
+// Timer_A.
+
+static double ta_period(void)
+{
+    unsigned int ctl = r16(A_TACTL);
+    double src;
+    switch(ctl & TASSEL_3)
+    {
+    case TASSEL_1:
+        src = aclk_ps;
+        break;
+    case TASSEL_2:
+        src = smclk_ps;
+        break;
+    default:
+        // TACLK and INCLK pins aren't modelled.
+        return 0;
+    }
+    return src * (1 << ((ctl >> 6) & 3));
+}
+
+static void ta_schedule(void)
+{
+    unsigned int mc = r16(A_TACTL) & MC_3;
+    double period = ta_period();
+    // Up and up/down modes stop with TACCR0 == 0.
+    if(!mc || !period || (mc != MC_2 && !r16(A_TACCR0)))
+        ta_due = NEVER;
+    else
+        ta_due = now + ps(1, period);
+}
+
+static void ta_set_out(int n, unsigned char level)
+{
+    if(ta_out[n] == level)
+        return;
+    ta_out[n] = level;
+    // USISSEL 5 to 7 count TACCR0 to 2 rising edges.
+    if(level && ((r8(A_USICKCTL) >> 2) & 7) == 5 + n)
+        usi_source_edge();
+    pins_update();
+}
+
+static void ta_output(int n, int equ_n, int equ_0)
+{
+    unsigned char out = ta_out[n];
+    switch(r16(A_TACCTL0 + 2 * n) & OUTMOD_7)
+    {
+    case OUTMOD_1:
+        if(equ_n) out = 1;
+        break;
+    case OUTMOD_2:
+        if(equ_n) out = !out;
+        if(equ_0) out = 0;
+        break;
+    case OUTMOD_3:
+        if(equ_n) out = 1;
+        if(equ_0) out = 0;
+        break;
+    case OUTMOD_4:
+        if(equ_n) out = !out;
+        break;
+    case OUTMOD_5:
+        if(equ_n) out = 0;
+        break;
+    case OUTMOD_6:
+        if(equ_n) out = !out;
+        if(equ_0) out = 1;
+        break;
+    case OUTMOD_7:
+        if(equ_n) out = 0;
+        if(equ_0) out = 1;
+        break;
+    default:
+        return;
+    }
+    ta_set_out(n, out);
+}
+
+static void ta_fire(void)
+{
+    unsigned int ctl = r16(A_TACTL);
+    unsigned int tar = r16(A_TAR);
+    unsigned int ccr0 = r16(A_TACCR0);
+    int wrapped = 0;
+    int n;
+
+    switch(ctl & MC_3)
+    {
+    case MC_1:
+        if(tar >= ccr0)
+            tar = 0, wrapped = 1;
+        else
+            tar++;
+        break;
+    case MC_2:
+        tar = (tar + 1) & 0xffff;
+        wrapped = !tar;
+        break;
+    case MC_3:
+        if(ta_down && tar)
+        {
+            if(!--tar)
+                ta_down = 0, wrapped = 1;
+        }
+        else if(++tar >= ccr0)
+        {
+            tar = ccr0;
+            ta_down = 1;
+        }
+        break;
+    }
+    w16(A_TAR, tar);
+    if(wrapped)
+        w16(A_TACTL, ctl | TAIFG);
+
+    int equ0 = tar == ccr0;
+    for(n = 0; n < 3; ++n)
+    {
+        unsigned int cctl = r16(A_TACCTL0 + 2 * n);
+        int equ = tar == r16(A_TACCR0 + 2 * n);
+        if(cctl & CAP)
+            continue;
+        if(equ)
+        {
+            w16(A_TACCTL0 + 2 * n, cctl | CCIFG);
+            ta_match[n] = now;
+        }
+        if(equ || equ0)
+            ta_output(n, equ, n ? equ0 : 0);
+    }
+
+    ta_schedule();
+}
+
+// Reading or writing TAIV clears the highest pending flag.
+static void taiv_access(void)
+{
+    unsigned int v = 0;
+    unsigned int c1 = r16(A_TACCTL0 + 2);
+    unsigned int c2 = r16(A_TACCTL0 + 4);
+    unsigned int ctl = r16(A_TACTL);
+
+    if((c1 & (CCIE | CCIFG)) == (CCIE | CCIFG))
+    {
+        v = TAIV_TACCR1;
+        w16(A_TACCTL0 + 2, c1 & ~CCIFG);
+    }
+    else if((c2 & (CCIE | CCIFG)) == (CCIE | CCIFG))
+    {
+        v = TAIV_TACCR2;
+        w16(A_TACCTL0 + 4, c2 & ~CCIFG);
+    }
+    else if((ctl & (TAIE | TAIFG)) == (TAIE | TAIFG))
+    {
+        v = TAIV_TAIFG;
+        w16(A_TACTL, ctl & ~TAIFG);
+    }
+    w16(A_TAIV, v);
+}
+
+static int ta1_pending(void)
+{
+    int n;
+    for(n = 1; n < 3; ++n)
+        if((r16(A_TACCTL0 + 2 * n) & (CCIE | CCIFG)) == (CCIE | CCIFG))
+            return 1;
+    return (r16(A_TACTL) & (TAIE | TAIFG)) == (TAIE | TAIFG);
+}
+
+// ADC10, all four conversion modes, and the DTC.
+
+static double adc_input(unsigned int inch)
+{
+    if(inch < 8)
+        return sim_adc_volts[inch];
+    if(inch == 10)
+        return 0.00355 * sim_temp_c + 0.986 + sim_temp_offset;
+    if(inch == 11)
+        return sim_vcc / 2;
+    return 0;
+}
+
+static int adc_internal_ref(unsigned int ctl0)
+{
+    return ((ctl0 >> 13) & 3) == 1;
+}
+
+// Converts adc_chan.
+static void adc_convert(void)
+{
+    static const unsigned char sht[] = {4, 8, 16, 64};
+    unsigned int ctl0 = r16(A_ADC10CTL0);
+    unsigned int ctl1 = r16(A_ADC10CTL1);
+    double clk;
+
+    if(!(ctl0 & ADC10ON))
+    {
+        sim_violation("adc10", "conversion started with ADC10ON clear");
+        return;
+    }
+
+    switch(ctl1 & ADC10SSEL_3)
+    {
+    case 0:
+        clk = 1e12 / 5e6; // ADC10OSC, 3.7 to 6.3 Mhz.
+        break;
+    case ADC10SSEL0:
+        clk = aclk_ps;
+        break;
+    case ADC10SSEL1:
+        clk = mclk_ps;
+        break;
+    default:
+        clk = smclk_ps;
+        break;
+    }
+    clk *= ((ctl1 >> 5) & 7) + 1;
+
+    double sample = sht[(ctl0 >> 11) & 3] * clk;
+    if(adc_chan == 10 && sample < 30e6)
+        sim_violation("adc10", "temperature sensor sampled for %.1f us, "
+                      "needs 30 us", sample / 1e6);
+    if(adc_internal_ref(ctl0))
+    {
+        if(!(ctl0 & REFON))
+            sim_violation("adc10", "internal reference is off");
+        else if(now - ref_on_at < 30 * US)
+            sim_violation("adc10", "reference used %.1f us after REFON, "
+                          "needs 30 us", (now - ref_on_at) / 1e6);
+    }
+
+    w16(A_ADC10CTL1, ctl1 | ADC10BUSY);
+    adc_due = now + ps(sht[(ctl0 >> 11) & 3] + 13, clk);
+}
+
+// Trigger: a sequence starts at INCH and counts down to A0.
+static void adc_start(void)
+{
+    adc_chan = r16(A_ADC10CTL1) >> 12;
+    adc_next = -1;
+    adc_convert();
+}
+
+// Moves a result to the DTC block. Returns 1 if the DTC is enabled,
+// ADC10IFG is then only set when a block is full.
+static int dtc_transfer(unsigned int code)
+{
+    unsigned char n = r8(A_ADC10DTC1);
+    unsigned char dtc0 = r8(A_ADC10DTC0);
+    unsigned int size = (dtc0 & ADC10TB) ? 2 * n : n;
+
+    if(!n)
+        return 0;
+    if(!dtc_block)
+    {
+        sim_violation("adc10", "DTC enabled before ADC10SA_SET()");
+        return 1;
+    }
+    // One-block mode without ADC10CT stops after the block.
+    if(dtc_index >= size)
+        return 1;
+
+    dtc_block[dtc_index++] = code;
+    if(dtc_index % n)
+        return 1;
+
+    w16(A_ADC10CTL0, r16(A_ADC10CTL0) | ADC10IFG);
+    if(dtc0 & ADC10TB)
+        w8(A_ADC10DTC0, (dtc_index == n) ? (dtc0 | ADC10B1) :
+                                           (dtc0 & ~ADC10B1));
+    if((dtc0 & ADC10CT) && dtc_index == size)
+        dtc_index = 0;
+    return 1;
+}
+
+// ADC10SA_SET() in include/msp430.h. The host address of the block
+// doesn't fit ADC10SA, which reads 0x0200 instead.
+void sim_adc10sa(volatile void *block)
+{
+    access(A_ADC10SA, 2);
+    last_size = 0;
+    w16(A_ADC10SA, 0x0200);
+    dtc_block = (unsigned int *)block;
+    dtc_index = 0;
+}
+
+volatile unsigned int *sim_adc10_block(void)
+{
+    return dtc_block;
+}
+
+static void adc_fire(void)
+{
+    unsigned int ctl0 = r16(A_ADC10CTL0);
+    unsigned int ctl1 = r16(A_ADC10CTL1);
+    double ref = sim_vcc;
+
+    if(adc_internal_ref(ctl0))
+        ref = (ctl0 & REFON) ? ((ctl0 & REF2_5V) ? 2.5 : 1.5) : 0;
+
+    double v = adc_input(adc_chan);
+    long code = ref > 0 ? (long)(1023 * v / ref + 0.5) : 1023;
+    if(code > 1023)
+        code = 1023;
+    if(code < 0)
+        code = 0;
+    if(ctl1 & ADC10DF)
+        code = ((code - 512) << 6) & 0xffff;
+
+    adc_due = NEVER;
+    w16(A_ADC10MEM, code);
+    if(!dtc_transfer(code))
+        w16(A_ADC10CTL0, ctl0 | ADC10IFG);
+
+    // Sequences run down to A0 even if ENC is cleared, repeat modes go
+    // again while ENC is set. The next conversion starts by itself with
+    // MSC, otherwise on the next ADC10SC.
+    int next = -1;
+    if((ctl1 & CONSEQ0) && adc_chan > 0)
+        next = adc_chan - 1;
+    else if((ctl1 & CONSEQ1) && (ctl0 & ENC))
+        next = ctl1 >> 12;
+
+    if(next < 0)
+        w16(A_ADC10CTL1, ctl1 & ~ADC10BUSY);
+    else if(ctl0 & MSC)
+    {
+        adc_chan = next;
+        adc_convert();
+    }
+    else if(ctl1 & CONSEQ0)
+        adc_next = next; // Stays busy.
+    else
+        w16(A_ADC10CTL1, ctl1 & ~ADC10BUSY);
+}
+
+// WDT+.
+
+static const unsigned int wdt_counts[] = {32768, 8192, 512, 64};
+
+// Clock period wdt_due was worked out with.
+static double wdt_clk_ps;
+
+static double wdt_clk(void)
+{
+    return (r16(A_WDTCTL) & WDTSSEL) ? aclk_ps : smclk_ps;
+}
+
+// Starts the interval over.
+static void wdt_schedule(void)
+{
+    unsigned int ctl = r16(A_WDTCTL);
+    double clk = wdt_clk();
+    wdt_clk_ps = clk;
+    if((ctl & WDTHOLD) || !clk)
+        wdt_due = NEVER;
+    else
+        wdt_due = now + ps(wdt_counts[ctl & 3], clk);
+}
+
+// Other clocks changing (SMCLK stopping in LPM3) leave the count alone.
+static void wdt_clock_changed(void)
+{
+    if(wdt_clk() != wdt_clk_ps)
+        wdt_schedule();
+}
+
+static void wdt_fire(void)
+{
+    unsigned int ctl = r16(A_WDTCTL);
+
+    if(!(ctl & WDTTMSEL))
+    {
+        sim_violation("wdt", "watchdog expired, PUC");
+        end_run();
+    }
+    w8(A_IFG1, r8(A_IFG1) | WDTIFG);
+    // The next interval from this one's end, however late it was seen.
+    wdt_due += ps(wdt_counts[ctl & 3], wdt_clk_ps);
+}
+
+// Register writes, seen on the next access.
+
+static void reg_write(unsigned int a)
+{
+    unsigned int v;
+
+    switch(a)
+    {
+    case A_P1IN:
+        restore(a, 1);
+        break;
+    case A_P1OUT:
+    case A_P1DIR:
+    case A_P1SEL:
+    case A_P1REN:
+        keep(a, 1);
+        pins_update();
+        break;
+    case A_DCOCTL:
+    case A_BCSCTL1:
+    case A_BCSCTL2:
+    case A_BCSCTL3:
+        keep(a, 1);
+        clocks_update();
+        break;
+    case A_USICTL0:
+        v = r8(a);
+        keep(a, 1);
+        if(v & USISWRST)
+        {
+            usi_due = NEVER;
+            usi_sclk = (r8(A_USICKCTL) & USICKPL) != 0;
+        }
+        pins_update();
+        break;
+    case A_USICKCTL:
+        v = shadow[a];
+        keep(a, 1);
+        if(!(r8(A_USICNT) & 0x1f))
+            usi_sclk = (r8(a) & USICKPL) != 0;
+        if(((r8(a) >> 2) & 7) == 4 && !(v & USISWCLK) && (r8(a) & USISWCLK))
+            usi_source_edge();
+        pins_update();
+        break;
+    case A_USICNT:
+        keep(a, 1);
+        usi_start();
+        break;
+    case A_WDTCTL:
+        v = r16(a);
+        if((v >> 8) != (WDTPW >> 8))
+        {
+            sim_violation("wdt", "WDTCTL written without WDTPW, PUC");
+            end_run();
+        }
+        w16(a, 0x6900 | (v & 0xff & ~WDTCNTCL));
+        wdt_schedule();
+        break;
+    case A_TACTL:
+        v = r16(a);
+        if(v & TACLR)
+        {
+            v &= ~TACLR;
+            w16(A_TAR, 0);
+            ta_down = 0;
+        }
+        w16(a, v);
+        if(((v ^ old16(a)) & (TASSEL_3 | ID_3 | MC_3)) || ta_due == NEVER)
+            ta_schedule();
+        break;
+    case A_TACCR0:
+        keep(a, 2);
+        if(ta_due == NEVER || !r16(a))
+            ta_schedule();
+        break;
+    case A_TACCTL0:
+    case A_TACCTL0 + 2:
+    case A_TACCTL0 + 4:
+        keep(a, 2);
+        v = r16(a);
+        if(!(v & OUTMOD_7))
+            ta_set_out((a - A_TACCTL0) / 2, (v & OUT) != 0);
+        break;
+    case A_ADC10CTL0:
+        v = r16(a);
+        if((v & REFON) && (!(old16(a) & REFON) ||
+                           ((v ^ old16(a)) & REF2_5V)))
+            ref_on_at = now;
+        w16(a, v & ~ADC10SC);
+        if((v & (ENC | ADC10SC)) != (ENC | ADC10SC))
+            break;
+        if(!(r16(A_ADC10CTL1) & ADC10BUSY))
+            adc_start();
+        else if(adc_next >= 0 && adc_due == NEVER)
+        {
+            adc_chan = adc_next;
+            adc_next = -1;
+            adc_convert();
+        }
+        break;
+    case A_ADC10CTL1:
+        if(old16(a) != r16(a) && (r16(A_ADC10CTL0) & ENC) &&
+           ((old16(a) ^ r16(a)) & ~ADC10BUSY))
+        {
+            sim_violation("adc10", "ADC10CTL1 changed with ENC set");
+            restore(a, 2);
+        }
+        else
+            keep(a, 2);
+        break;
+    case A_ADC10MEM:
+        restore(a, 2);
+        break;
+    case A_ADC10SA:
+        sim_violation("adc10", "ADC10SA written directly, use ADC10SA_SET()");
+        keep(a, 2);
+        break;
+    default:
+        if(a >= 0x200)
+        {
+            sim_violation("cpu", "write to flash at 0x%04x", a);
+            restore(a, 1);
+        }
+        else
+        {
+            keep(a, a >= 0x100 ? 2 : 1);
+        }
+        break;
+    }
+}
+
+static void sync(void)
+{
+    unsigned int a = last_addr;
+    unsigned char n = last_size;
+    last_size = 0;
+
+    if(!n || !memcmp(&mem[a], &shadow[a], n))
+        return;
+    // Word peripherals live at 0x100 to 0x1ff.
+    if(a >= 0x100 && a < 0x200)
+    {
+        reg_write(a & ~1);
+        return;
+    }
+    if(mem[a] != shadow[a])
+        reg_write(a);
+    if(n == 2 && mem[a + 1] != shadow[a + 1])
+        reg_write(a + 1);
+}
+
+static void access(unsigned int addr, unsigned char size)
+{
+    if(sim_access)
+        sim_access(addr);
+    sync();
+    run_until(now + ps(4, mclk_ps));
+    if(addr == A_TAIV)
+        taiv_access();
+    last_addr = addr;
+    last_size = size;
+}
+
+volatile unsigned char *sim_reg8(unsigned int addr)
+{
+    access(addr, 1);
+    return &mem[addr];
+}
+
+volatile unsigned short *sim_reg16(unsigned int addr)
+{
+    if(addr & 1)
+        sim_violation("cpu", "word access at odd address 0x%04x", addr);
+    access(addr & ~1, 2);
+    return (volatile unsigned short *)&mem[addr & ~1];
+}
+
+// Interrupts.
+
+typedef void (*isr_fn)(void);
+
+// Handlers are put in section sim_isr_<vector> by include/msp430.h.
+#define SIM_ISR(n) extern char __start_sim_isr_##n[] __attribute__ ((weak));
+SIM_ISR(4) SIM_ISR(6) SIM_ISR(8) SIM_ISR(10) SIM_ISR(16) SIM_ISR(18)
+SIM_ISR(20) SIM_ISR(22) SIM_ISR(28)
+
+static isr_fn isr_lookup(int vec)
+{
+    char *p;
+    switch(vec)
+    {
+    case 4: p = __start_sim_isr_4; break;
+    case 6: p = __start_sim_isr_6; break;
+    case 8: p = __start_sim_isr_8; break;
+    case 10: p = __start_sim_isr_10; break;
+    case 16: p = __start_sim_isr_16; break;
+    case 18: p = __start_sim_isr_18; break;
+    case 20: p = __start_sim_isr_20; break;
+    case 22: p = __start_sim_isr_22; break;
+    case 28: p = __start_sim_isr_28; break;
+    default: p = 0; break;
+    }
+    return (isr_fn)p;
+}
+
+// Vectors by priority, highest first.
+static const int irq_order[] =
+{
+    WDT_VECTOR, TIMERA0_VECTOR, TIMERA1_VECTOR, ADC10_VECTOR, USI_VECTOR,
+    PORT2_VECTOR, PORT1_VECTOR,
+};
+#define IRQS (sizeof(irq_order) / sizeof(irq_order[0]))
+
+// When each vector's request came up, NEVER while there is none. Seen
+// whether GIE is set or not, so waiting for an ISR or a dint() section
+// counts.
+static ps_t irq_since[IRQS];
+
+// A flag with its enable bit set.
+static int irq_requested(int vec)
+{
+    switch(vec)
+    {
+    case WDT_VECTOR:
+        return (r8(A_IE1) & WDTIE) && (r8(A_IFG1) & WDTIFG);
+    case TIMERA0_VECTOR:
+        return (r16(A_TACCTL0) & (CCIE | CCIFG)) == (CCIE | CCIFG);
+    case TIMERA1_VECTOR:
+        return ta1_pending();
+    case ADC10_VECTOR:
+        return (r16(A_ADC10CTL0) & (ADC10IE | ADC10IFG)) ==
+               (ADC10IE | ADC10IFG);
+    case USI_VECTOR:
+        return (r8(A_USICTL1) & USIIE) && (r8(A_USICTL1) & USIIFG);
+    case PORT2_VECTOR:
+        return (r8(A_P2IE) & r8(A_P2IFG)) != 0;
+    case PORT1_VECTOR:
+        return (r8(A_P1IE) & r8(A_P1IFG)) != 0;
+    }
+    return 0;
+}
+
+static void irq_note(void)
+{
+    unsigned int i;
+    for(i = 0; i < IRQS; ++i)
+    {
+        if(!irq_requested(irq_order[i]))
+            irq_since[i] = NEVER;
+        else if(irq_since[i] == NEVER)
+            irq_since[i] = now;
+    }
+}
+
+// Highest priority pending request as an index into irq_order, -1 if
+// none.
+static int irq_pending(void)
+{
+    unsigned int i;
+    for(i = 0; i < IRQS; ++i)
+        if(irq_since[i] != NEVER)
+            return i;
+    return -1;
+}
+
+static void set_sr(unsigned int v)
+{
+    unsigned int old = sr;
+    sr = v;
+    if((old ^ sr) & (SCG1 | SCG0 | OSCOFF))
+        clocks_update();
+}
+
+static void dispatch(int irq)
+{
+    int vec = irq_order[irq];
+    isr_fn isr = isr_lookup(vec);
+    if(!isr)
+    {
+        sim_violation("cpu", "no handler for vector %d", vec);
+        end_run();
+    }
+    if(isr_depth == sizeof(isr_sr) / sizeof(isr_sr[0]))
+    {
+        sim_violation("cpu", "interrupts nested too deep");
+        end_run();
+    }
+
+    // Single source flags are reset when the interrupt is accepted.
+    switch(vec)
+    {
+    case WDT_VECTOR:
+        w8(A_IFG1, r8(A_IFG1) & ~WDTIFG);
+        break;
+    case TIMERA0_VECTOR:
+        w16(A_TACCTL0, r16(A_TACCTL0) & ~CCIFG);
+        break;
+    case ADC10_VECTOR:
+        w16(A_ADC10CTL0, r16(A_ADC10CTL0) & ~ADC10IFG);
+        break;
+    }
+
+    isr_vec[isr_depth] = vec;
+    isr_since[isr_depth] = irq_since[irq];
+    irq_since[irq] = NEVER;
+    isr_sr[isr_depth++] = sr;
+    set_sr(sr & SCG0);
+    __cyg_profile_func_enter((void *)isr, 0);
+    run_until(now + ps(6, mclk_ps));
+    isr();
+    sync();
+    run_until(now + ps(5, mclk_ps));
+    __cyg_profile_func_exit((void *)isr, 0);
+    set_sr(isr_sr[--isr_depth]);
+    if(sim_isr_done)
+        sim_isr_done(vec, isr_since[isr_depth] / 1e6);
+}
+
+static void irq_check(void)
+{
+    int irq;
+    irq_note();
+    while((sr & GIE) && (irq = irq_pending()) >= 0)
+    {
+        dispatch(irq);
+        irq_note();
+    }
+}
+
+// Energy.
+
+static void energy_state_get(energy_state *s)
+{
+    unsigned int ctl0 = r16(A_ADC10CTL0);
+
+    if(!(sr & CPUOFF))
+        s->mode = ENERGY_ACTIVE;
+    else if(sr & OSCOFF)
+        s->mode = ENERGY_LPM4;
+    else
+        s->mode = ENERGY_LPM0 + ((sr & SCG0) ? 1 : 0) + ((sr & SCG1) ? 2 : 0);
+    s->vector = isr_depth ? isr_vec[isr_depth - 1] : -1;
+
+    s->on = 0;
+    if(adc_due != NEVER)
+        s->on |= ENERGY_ADC10;
+    if(ctl0 & REFON)
+        s->on |= ENERGY_REF;
+    if((ctl0 & ADC10ON) && (r16(A_ADC10CTL1) >> 12) == 10)
+        s->on |= ENERGY_SENSOR;
+    if(ta_due != NEVER)
+        s->on |= ENERGY_TIMER;
+    if(!(r8(A_USICTL0) & USISWRST))
+        s->on |= ENERGY_USI;
+    if(wdt_due != NEVER)
+        s->on |= ENERGY_WDT;
+
+    s->mclk_mhz = 1e6 / mclk_ps;
+    s->dco_mhz = dco_hz / 1e6;
+    s->lfxt = (r8(A_BCSCTL3) & LFXT1S_3) != LFXT1S_2;
+}
+
+// Moves time forward to t, accounting for the energy used on the way.
+static void advance(ps_t t)
+{
+    energy_state s;
+    if(t <= now)
+        return;
+    energy_state_get(&s);
+    energy_add(&s, t - now);
+    now = t;
+}
+
+// Scheduler.
+
+void sim_at(double t_us, void (*fn)(void *arg), void *arg)
+{
+    ps_t t = (ps_t)(t_us * 1e6);
+    int i;
+    if(num_events == MAX_EVENTS)
+    {
+        fprintf(stderr, "sim: too many events\n");
+        exit(1);
+    }
+    for(i = num_events; i > 0 && events[i - 1].t > t; --i)
+        events[i] = events[i - 1];
+    events[i].t = t;
+    events[i].fn = fn;
+    events[i].arg = arg;
+    num_events++;
+}
+
+static ps_t next_due(void)
+{
+    ps_t due = ta_due;
+    if(usi_due < due)
+        due = usi_due;
+    if(adc_due < due)
+        due = adc_due;
+    if(wdt_due < due)
+        due = wdt_due;
+    if(num_events && events[0].t < due)
+        due = events[0].t;
+    return due;
+}
+
+static void fire(ps_t t)
+{
+    if(num_events && events[0].t <= t)
+    {
+        sim_event e = events[0];
+        memmove(events, events + 1, --num_events * sizeof(events[0]));
+        e.fn(e.arg);
+    }
+    else if(usi_due <= t)
+        usi_fire();
+    else if(ta_due <= t)
+        ta_fire();
+    else if(adc_due <= t)
+        adc_fire();
+    else if(wdt_due <= t)
+        wdt_fire();
+}
+
+static void run_until(ps_t t)
+{
+    for(;;)
+    {
+        irq_check();
+        ps_t due = next_due();
+        if(due > t)
+            break;
+        if(due > deadline)
+        {
+            advance(deadline);
+            end_run();
+        }
+        advance(due);
+        fire(due);
+    }
+    if(t > deadline)
+    {
+        advance(deadline);
+        end_run();
+    }
+    advance(t);
+}
+
+// CPU is off until an ISR clears CPUOFF on exit.
+static void cpu_sleep(void)
+{
+    while(sr & CPUOFF)
+    {
+        ps_t due = next_due();
+        if(due == NEVER)
+        {
+            advance(deadline);
+            end_run();
+        }
+        run_until(due);
+    }
+}
+
+void sim_cycles(unsigned long n)
+{
+    sync();
+    run_until(now + ps(n, mclk_ps));
+}
+
+double sim_time_us(void)
+{
+    return now / 1e6;
+}
+
+double sim_irq_us(void)
+{
+    return isr_depth ? isr_since[isr_depth - 1] / 1e6 : -1;
+}
+
+int sim_vector(void)
+{
+    return isr_depth ? isr_vec[isr_depth - 1] : -1;
+}
+
+double sim_irq_waiting_us(int vector)
+{
+    unsigned int i;
+
+    irq_note();
+    for(i = 0; i < IRQS; ++i)
+        if(irq_order[i] == vector)
+            return irq_since[i] == NEVER ? -1 : irq_since[i] / 1e6;
+    return -1;
+}
+
+double sim_compare_us(int n)
+{
+    return ta_match[n] == NEVER ? -1 : ta_match[n] / 1e6;
+}
+
+// Intrinsics.
+
+void __eint(void)
+{
+    sync();
+    sr |= GIE;
+    run_until(now + ps(1, mclk_ps));
+}
+
+void __dint(void)
+{
+    sync();
+    sr &= ~GIE;
+    run_until(now + ps(1, mclk_ps));
+}
+
+void __nop(void)
+{
+    sim_cycles(1);
+}
+
+unsigned int __read_status_register(void)
+{
+    sync();
+    return sr;
+}
+
+void __write_status_register(unsigned int v)
+{
+    sync();
+    set_sr(v);
+    run_until(now + ps(1, mclk_ps));
+    cpu_sleep();
+}
+
+void __bis_status_register(unsigned int bits)
+{
+    __write_status_register(sr | bits);
+}
+
+void __bic_status_register(unsigned int bits)
+{
+    __write_status_register(sr & ~bits);
+}
+
+void __bis_status_register_on_exit(unsigned int bits)
+{
+    if(!isr_depth)
+        sim_violation("cpu", "status register change on exit outside an ISR");
+    else
+        isr_sr[isr_depth - 1] |= bits;
+}
+
+void __bic_status_register_on_exit(unsigned int bits)
+{
+    if(!isr_depth)
+        sim_violation("cpu", "status register change on exit outside an ISR");
+    else
+        isr_sr[isr_depth - 1] &= ~bits;
+}
+
+void __delay_cycles(unsigned long cycles)
+{
+    sim_cycles(cycles);
+}
+
+static unsigned long bcd_add(unsigned long a, unsigned long b, int digits)
+{
+    unsigned long r = 0;
+    unsigned int carry = 0;
+    int i;
+    for(i = 0; i < digits; ++i)
+    {
+        unsigned int d = ((a >> (4 * i)) & 0xf) + ((b >> (4 * i)) & 0xf) +
+                         carry;
+        carry = d > 9;
+        if(carry)
+            d -= 10;
+        r |= (unsigned long)(d & 0xf) << (4 * i);
+    }
+    return r;
+}
+
+unsigned int __bcd_add_short(unsigned int a, unsigned int b)
+{
+    sim_cycles(1);
+    return bcd_add(a, b, 4);
+}
+
+unsigned long __bcd_add_long(unsigned long a, unsigned long b)
+{
+    sim_cycles(2);
+    return bcd_add(a, b, 8);
+}
+
+// Run control.
+
+// ADC10 code of the temperature sensor at t C with an ideal converter.
+static unsigned int tlv_temp(double t, double ref)
+{
+    return (unsigned int)(1023 * (0.00355 * t + 0.986 + sim_temp_offset) /
+                          ref + 0.5);
+}
+
+// TLV as on a G2452: empty tag, ADC10 calibration (unless sim_tlv_adc is
+// 0), DCO calibration, checksum.
+static void tlv(void)
+{
+    unsigned int adc[8] = {0x8000, 0, 0x8000, 0, 0, 0x8000, 0, 0};
+    unsigned int check = 0;
+    unsigned int a;
+    int i;
+
+    mem[A_TLV + 2] = 0xfe;
+    mem[A_TLV + 3] = 0x16;
+    if(sim_tlv_adc)
+    {
+        adc[3] = tlv_temp(30, 1.5);
+        adc[4] = tlv_temp(85, 1.5);
+        adc[6] = tlv_temp(30, 2.5);
+        adc[7] = tlv_temp(85, 2.5);
+        mem[0x10DA] = 0x10;
+        mem[0x10DB] = 0x10;
+        for(i = 0; i < 8; ++i)
+            w16(0x10DC + 2 * i, adc[i]);
+    }
+    else
+    {
+        // One empty tag up to the DCO calibration.
+        mem[A_TLV + 3] = 0x32;
+    }
+    mem[0x10F6] = 0x01;
+    mem[0x10F7] = 0x08;
+    for(i = 0; i < 4; ++i)
+    {
+        mem[A_CAL + 2 * i] = cal[i][0];
+        mem[A_CAL + 2 * i + 1] = cal[i][1];
+    }
+
+    for(a = A_TLV + 2; a < 0x1100; a += 2)
+        check ^= r16(a);
+    w16(A_TLV, -check & 0xffff);
+}
+
+static void reset(void)
+{
+    unsigned int i;
+
+    memset(mem, 0, sizeof(mem));
+    memset(shadow, 0, sizeof(shadow));
+    // Blank flash reads 0xff.
+    memset(mem + A_TLV, 0xff, 0x10000 - A_TLV);
+    tlv();
+    memcpy(shadow + A_TLV, mem + A_TLV, 0x10000 - A_TLV);
+
+    // Power up clear values.
+    w16(A_WDTCTL, 0x6900);
+    w8(A_DCOCTL, 0x60);
+    w8(A_BCSCTL1, 0x87);
+    w8(A_BCSCTL3, 0x05);
+    w8(A_USICTL0, USISWRST);
+    w8(A_USICTL1, USIIFG);
+    w8(A_USICKCTL, USISWCLK);
+
+    last_size = 0;
+    now = 0;
+    sr = 0;
+    isr_depth = 0;
+    for(i = 0; i < IRQS; ++i)
+        irq_since[i] = NEVER;
+    ta_down = 0;
+    memset(ta_out, 0, sizeof(ta_out));
+    ta_due = usi_due = adc_due = NEVER;
+    ta_match[0] = ta_match[1] = ta_match[2] = NEVER;
+    adc_next = -1;
+    dtc_block = 0;
+    dtc_index = 0;
+    usi_sclk = 0;
+    usi_sdo = 0;
+    ref_on_at = 0;
+    mclk_ps = smclk_ps = aclk_ps = 0;
+    energy_reset();
+    clocks_update();
+    wdt_schedule();
+
+    pins = pins_compute();
+    w8(A_P1IN, pins);
+}
+
+// Energy report to $SIM_ENERGY, - for stdout.
+static void energy_write(void)
+{
+    const char *path = getenv("SIM_ENERGY");
+    FILE *f;
+
+    if(!path || !*path)
+        return;
+    f = strcmp(path, "-") ? fopen(path, "w") : stdout;
+    if(!f)
+    {
+        perror(path);
+        return;
+    }
+    energy_report(f, now / 1e12);
+    if(f != stdout)
+        fclose(f);
+}
+
+int sim_run(int (*app)(void), double seconds)
+{
+    int i;
+
+    reset();
+    deadline = (ps_t)(seconds * 1e12);
+    running = 1;
+    if(!setjmp(run_end))
+    {
+        app();
+        fprintf(stderr, "sim: main returned at %.3f ms\n", now / 1e9);
+    }
+    sync();
+    running = 0;
+    energy_write();
+
+    if(violations)
+    {
+        fprintf(stderr, "sim: %d violations\n", violations);
+        for(i = 0; i < num_kinds; ++i)
+            fprintf(stderr, "  %6d  %s: %s\n",
+                    kinds[i].count, kinds[i].who, kinds[i].fmt);
+    }
+    return violations;
+}
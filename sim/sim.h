@@ -0,0 +1,107 @@
+#ifndef SIM_H_
+#define SIM_H_
+
+// Host-side MSP430G2xx simulator.
+//
+// Firmware is compiled for the host against include/msp430.h with main
+// renamed to sim_app_main (see Makefile) and linked with a harness that
+// attaches virtual devices and calls sim_run().
+//
+// Modelled at register level: Port 1, Timer_A (up/continuous/up-down,
+// compare and output units, TAIV), USI in SPI master mode, ADC10 (all
+// four conversion modes, DTC, temperature sensor, VCC/2, internal
+// reference), WDT+, the basic clock module and the TLV. Interrupts are dispatched
+// by priority when GIE is set, and LPM sleeps until one clears the
+// LPM bits on exit.
+//
+// Time only advances on register accesses (4 MCLK cycles each),
+// delay_us()/delay_ms()/__delay_cycles(), ISR entry/exit and LPM. A loop
+// that touches none of those never sees an interrupt.
+
+#include <stdarg.h>
+
+// A device on Port 1. pins() is called with the old and new pin levels
+// every time any of them change.
+typedef struct sim_device
+{
+    const char *name;
+    void (*pins)(struct sim_device *dev, unsigned char old, unsigned char now);
+    struct sim_device *next;
+} sim_device;
+
+void sim_attach(sim_device *dev);
+void sim_detach(sim_device *dev);
+
+// Runs app (the firmware main) for at most seconds of simulated time.
+// Returns the number of violations reported. With SIM_ENERGY set in the
+// environment, writes an energy report there at the end (see energy.h).
+int sim_run(int (*app)(void), double seconds);
+
+// Current simulated time.
+double sim_time_us(void);
+
+// From an ISR (or a handler it calls): when its interrupt was requested,
+// flag and enable both set, so sim_time_us() - sim_irq_us() is the
+// latency so far. -1 outside an ISR.
+double sim_irq_us(void);
+
+// Vector of the ISR being run (or that called the handler being run),
+// -1 outside one.
+int sim_vector(void);
+
+// Called when an ISR has returned, exit cycles included, with its vector
+// and when it was requested. For harness checks on whole handlers.
+extern void (*sim_isr_done)(int vector, double irq_us);
+
+// Called before every register access with its address, the access's
+// cycles not done yet. E.g. to charge the instructions leading up to it
+// with sim_cycles(), or to time when a handler samples a pin.
+extern void (*sim_access)(unsigned int addr);
+
+// When vector's interrupt was requested if it still is, flag and enable
+// set, -1 if not. E.g. whether an ISR polling the flag will see it.
+double sim_irq_waiting_us(int vector);
+
+// When TACCRn last matched TAR in compare mode, -1 before. From its
+// handler, sim_time_us() - sim_compare_us(n) is how late it is.
+double sim_compare_us(int n);
+
+// The block ADC10SA_SET() gave the DTC, 0 before.
+volatile unsigned int *sim_adc10_block(void);
+
+// Advances n MCLK cycles.
+void sim_cycles(unsigned long n);
+
+// Calls fn(arg) at t_us of simulated time. For harness stimulus.
+void sim_at(double t_us, void (*fn)(void *arg), void *arg);
+
+// External drive of Port 1 input pins, e.g. a button or sensor. Pins
+// that are neither driven nor pulled read low.
+void sim_drive(unsigned char mask, unsigned char level);
+void sim_release(unsigned char mask);
+
+// Port 1 pin levels.
+unsigned char sim_port1(void);
+
+// Clock frequencies in Hz.
+double sim_mclk_hz(void);
+double sim_smclk_hz(void);
+
+// Analog inputs.
+extern double sim_temp_c;       // Die temperature.
+extern double sim_temp_offset;  // Sensor offset from the typical curve in
+                                // volts, included in the TLV calibration.
+extern int sim_tlv_adc;         // 0 leaves the ADC10 calibration out of
+                                // the TLV.
+extern double sim_vcc;          // Supply voltage.
+extern double sim_vlo_hz;       // VLO, 4 to 20 kHz on real parts, 12 kHz
+                                // typical.
+extern double sim_adc_volts[8]; // A0..A7.
+
+// Reports a timing or protocol violation. Printed with the simulated time
+// (the first few of each kind) and counted.
+void sim_violation(const char *who, const char *fmt, ...)
+    __attribute__ ((format(printf, 2, 3)));
+int sim_violations(void);
+
+#endif
@@ -0,0 +1,145 @@
+// lib/adcscan.c on the simulated ADC10 and DTC.
+//
+//     ./adcscan
+//
+// Scans VCC/2 (A11), the temperature sensor (A10), A3 and A0 at 4, 16, 1
+// and 2 scans, with distinct voltages on A0 to A7, at 1 Mhz. After every
+// scan's block interrupt it checks:
+//
+// - the block, A11 first down to A0, each slot the ideal code of its
+//   channel;
+// - the block's completion, from the ADC10SC write that started the scan
+//   (adcscan_start() or the previous ISR, its last access before the
+//   exit) to the interrupt request, against SCAN_US;
+// - the ISR, from the request until it has returned, against ISR_US.
+//   Only register accesses and the entry and exit take time (sim.h), so
+//   this is the least it takes.
+//
+// Then the round's averages against the codes. Prints the worst times,
+// exits with 1 on any error.
+
+#include <stdio.h>
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+#include "../sim.h"
+#include "adcscan.h"
+#include "delay.h"
+
+#define REF_V 2.5
+#define TOP   11
+// 12 channels of ADC10OSC / 4, 5 Mhz in the simulator, 64 clocks of
+// sample and 13 of conversion each.
+#define SCAN_US  (12 * (64 + 13) * 4 / 5.0)
+#define SCAN_TOLERANCE_US 1
+// Half a conversion, the next scan's first result is a whole one away.
+#define ISR_US 30
+
+static const adcscan_channel channels[] = {{11, 2}, {10, 4}, {3, 0},
+                                           {0, 1}};
+#define CHANNELS (sizeof(channels) / sizeof(channels[0]))
+#define SCANS 16
+
+static unsigned int errors;
+static unsigned int scans;
+static double started_us; // The scan's ADC10SC write.
+static double worst_scan_us;
+static double worst_isr_us;
+
+// The ideal converter's code for channel inch.
+static unsigned int code(unsigned int inch)
+{
+    double v = 0;
+
+    if(inch < 8)
+        v = sim_adc_volts[inch];
+    else if(inch == 10)
+        v = 0.00355 * sim_temp_c + 0.986 + sim_temp_offset;
+    else if(inch == 11)
+        v = sim_vcc / 2;
+    return (unsigned int)(1023 * v / REF_V + 0.5);
+}
+
+static void isr_done(int vector, double irq_us)
+{
+    volatile unsigned int *block = sim_adc10_block();
+    double scan_us = irq_us - started_us;
+    double isr_us = sim_time_us() - irq_us;
+    unsigned int i;
+
+    if(vector != ADC10_VECTOR)
+        return;
+    scans++;
+    for(i = 0; i <= TOP; ++i)
+    {
+        if(block[i] == code(TOP - i))
+            continue;
+        if(errors++ < 10)
+            fprintf(stderr, "scan %u: block[%u] is %u, A%u is %u\n",
+                    scans, i, block[i], TOP - i, code(TOP - i));
+    }
+    if(scan_us - SCAN_US > SCAN_TOLERANCE_US ||
+       SCAN_US - scan_us > SCAN_TOLERANCE_US)
+    {
+        if(errors++ < 10)
+            fprintf(stderr, "scan %u: block done after %.1f us, not %.1f\n",
+                    scans, scan_us, SCAN_US);
+    }
+    if(isr_us > ISR_US && errors++ < 10)
+        fprintf(stderr, "scan %u: ISR took %.1f us\n", scans, isr_us);
+    worst_scan_us = scan_us > worst_scan_us ? scan_us : worst_scan_us;
+    worst_isr_us = isr_us > worst_isr_us ? isr_us : worst_isr_us;
+    // The exit's 5 cycles come after the write.
+    started_us = sim_time_us() - 5e6 / sim_mclk_hz();
+}
+
+static int app(void)
+{
+    unsigned int i;
+
+    WDTCTL = WDTPW | WDTHOLD;
+    DCOCTL = 0;
+    BCSCTL1 = CALBC1_1MHZ;
+    DCOCTL = CALDCO_1MHZ;
+    adcscan_init(channels, CHANNELS, SREF0 | REFON | REF2_5V | ADC10SHT_3);
+    delay_ms(1);
+    __eint();
+
+    adcscan_start();
+    started_us = sim_time_us();
+    __dint();
+    while(!adcscan_done())
+    {
+        __bis_status_register(LPM0_bits | GIE);
+        __dint();
+    }
+    __eint();
+
+    for(i = 0; i < CHANNELS; ++i)
+    {
+        unsigned int want = code(channels[i].inch);
+        unsigned int got = adcscan_result(i);
+        if(got != want && errors++ < 10)
+            fprintf(stderr, "A%u averaged to %u, not %u\n",
+                    channels[i].inch, got, want);
+    }
+    return 0;
+}
+
+int main(void)
+{
+    unsigned int i;
+
+    for(i = 0; i < 8; ++i)
+        sim_adc_volts[i] = 0.1 + 0.25 * i;
+    sim_isr_done = isr_done;
+
+    int violations = sim_run(app, 1);
+    if(scans != SCANS && errors++ < 10)
+        fprintf(stderr, "%u scans, not %u\n", scans, SCANS);
+
+    printf("%u scans, blocks done after %.1f us at worst (%.1f), ISR "
+           "%.1f us at worst\n", scans, worst_scan_us, SCAN_US, worst_isr_us);
+    return violations || errors ? 1 : 0;
+}
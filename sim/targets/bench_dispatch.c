@@ -0,0 +1,590 @@
+// Interrupt dispatch benchmark for ../lib/dispatch.c, see ../bench.h.
+//
+//     ./bench_dispatch
+//
+// Every case runs at 8 Mhz with Timer_A counting SMCLK / 8 in continuous
+// mode, the way multiapp does. us and cycles go from the interrupt
+// request (flag and enable set, sim_irq_us()) to the first instruction
+// of the handler, through the vector and the dispatcher:
+//
+// port1:      an edge on the priority 0 pin.
+// port1_last: edges on all three pins at once, to the priority 2 handler
+//             after the other two have read P1IN.
+// taccr0:     a TACCR0 compare.
+// taiv:       a TACCR2 compare, through TAIV.
+// sampling:   multiapp's capture (../../multiapp/capture.c) sampling an
+//             NEC frame at 100 kHz, against button edges every ms and
+//             TACCR1 and TACCR2 every 0.7 and 1.3 ms. us and cycles are
+//             the worst sample, from the compare to capture_sample()'s
+//             P1IN read, through the TACCR0 vector or the port 1 and
+//             TAIV ISRs polling for it (dispatch.h). The frame it sends
+//             has to hold the level of every sample, as read.
+//
+// The simulator charges the ISR entry and exit and the register accesses,
+// not the other instructions (sim.h). The bench charges dispatch.c's, and
+// capture.c's tick() up to its P1IN read, with sim_cycles() as counted
+// below, ahead of the register access or handler call they lead up to
+// (sim_access). errors is 1 if a case is over its budget. For sampling
+// also if a sample is SAMPLE_LATE_CYCLES late or missed
+// (capture_missed()), or the frame isn't what was read.
+
+#include <stdio.h>
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+#include "../bench.h"
+#include "../sim.h"
+#include "../vuart.h"
+#include "dispatch.h"
+#include "tasks.h"
+
+#define OTHER     (1 << 0)
+#define UART_TX   (1 << 6)
+#define PINS      (IR_SENSOR | BUTTON | OTHER)
+
+// Addresses sim_access gets, from include/msp430.h.
+#define P1IN_ADDR    0x0020
+#define P1IFG_ADDR   0x0023
+#define TAIV_ADDR    0x012e
+#define TACCTL0_ADDR 0x0162
+
+// Request to the first handler, and to each further one of a port 1
+// interrupt. The TACCR0 polls take 10 cycles on entry and 10 per entry.
+#define BUDGET_CYCLES      80
+#define BUDGET_NEXT_CYCLES 44
+// Under the 80 cycles of a 100 kHz period.
+#define SAMPLE_LATE_CYCLES 64
+#define TACCR1_TICKS  700
+#define TACCR2_TICKS  1300
+#define STIMULUS_US   50e3
+// The frame and the 9600 bps it takes to send it.
+#define SAMPLING_S    0.25
+// capture.c's whole frame, 15.2 ms.
+#define CAPTURE_SAMPLES 1520
+#define HEADER_BYTES 3
+
+// Cycles of dispatch.c's instructions other than register accesses, for
+// mspgcc -Os code with SLAU144's cycle table. An ISR that calls out saves
+// r12 to r15 plus what it keeps across the calls, 3 cycles a push and 2 a
+// pop. The handlers here return 0, so no LPM bits are cleared.
+//
+// A TACCR0 poll (taccr0_due()) after its TACCTL0 read: and, cmp, jne.
+#define POLL_CYCLES 6
+// Due, after the CCIFG clear: timer[0] (3), call (4).
+#define FAST_ENTER  7
+#define FAST_LEAVE  1  // wake |= the result.
+// dispatch_pins() up to its first poll: 7 pushes.
+#define PINS_ENTER 21
+#define PINS_START 1   // i cleared, after the P1IFG clear.
+// i against port1_count (3), jc (2), before each poll but the first.
+#define PINS_LOOP  5
+// After a poll: i * 4 (3), the mask (3), and with pending (1), jz (2).
+#define PINS_TEST  9
+#define PINS_CALL  5  // call port1+2(r14).
+#define PINS_BACK  1  // wake |= the result.
+#define PINS_NEXT  3  // ++i, jmp.
+// After the end poll: wake tested (3), 7 pops (14).
+#define PINS_LEAVE 17
+// dispatch_taccr0(): 4 pushes (12), timer[0] (3), call (4).
+#define TACCR0_ENTER 19
+// Result tested (3), 4 pops (8).
+#define TACCR0_LEAVE 11
+// dispatch_taiv() up to its first poll: 5 pushes.
+#define TAIV_ENTER 15
+#define TAIV_TEST  3  // TAIV tested, after its read.
+#define TAIV_CALL  7  // timer[iv >> 1] (3), call (4).
+#define TAIV_BACK  1  // wake |= the result, before the poll.
+#define TAIV_LOOP  2  // jmp back to the TAIV read, after it.
+// After TAIV read 0: wake tested (3), 5 pops (10).
+#define TAIV_LEAVE 13
+// A handler's own return value and ret.
+#define HANDLER_RET 4
+// capture.c's tick(): state compared (4), jne (2), call (5), and
+// capture_sample()'s push (3) up to its P1IN read.
+#define TICK_ENTER 14
+
+enum { FIRST_PIN, LAST_PIN, COMPARE0, COMPARE2, SAMPLING };
+
+// What dispatch.c does next after a poll, to charge what comes before it.
+enum { NEXT_PENDING, NEXT_HANDLER, NEXT_POLL, NEXT_TAIV, NEXT_DONE };
+
+static int mode;
+// The interrupt requested at irq_seen_us: cycles run but not charged yet,
+// whether a poll's instructions after it are among them, when that poll
+// read TACCTL0, and whether P1IFG or TAIV has been read.
+static double irq_seen_us;
+static unsigned int owed;
+static int polled;
+static double poll_us;
+static int pins_read;
+static int taiv_read;
+// In a handler, whose accesses aren't dispatch.c's.
+static int in_handler;
+static double worst_us;
+
+static vuart uart;
+static dispatch_port1_fn capture_edge;
+static dispatch_timer_fn capture_tick;
+static int in_tick;
+// Levels capture_sample() read, 1 for space.
+static unsigned char levels[CAPTURE_SAMPLES];
+static unsigned int reads;
+
+// From `since` to now, kept if it is the worst of the case.
+static void measure_from(double since)
+{
+    double us = sim_time_us() - since;
+
+    if(us > worst_us)
+    {
+        worst_us = us;
+        bench_begin_at(since, 0);
+        bench_end(0);
+    }
+}
+
+static void measure(void)
+{
+    measure_from(sim_irq_us());
+}
+
+// Starts the bookkeeping over for a new interrupt, owing its ISR's
+// instructions up to the first poll.
+static void irq_seen(void)
+{
+    if(sim_irq_us() == irq_seen_us)
+        return;
+    irq_seen_us = sim_irq_us();
+    owed = sim_vector() == PORT1_VECTOR ? PINS_ENTER :
+           sim_vector() == TIMERA1_VECTOR ? TAIV_ENTER : 0;
+    polled = 0;
+    pins_read = 0;
+    taiv_read = 0;
+}
+
+// Charges what ran up to `next`: the instructions owed, and after a poll
+// those that take dispatch.c from it to `next`.
+static void pay(int next)
+{
+    static const unsigned int pins_after[] = {
+        0,                                 // NEXT_PENDING
+        PINS_TEST + PINS_CALL,             // NEXT_HANDLER
+        PINS_TEST + PINS_NEXT + PINS_LOOP, // NEXT_POLL
+        0,                                 // NEXT_TAIV
+        PINS_LEAVE,                        // NEXT_DONE
+    };
+
+    irq_seen();
+    if(polled)
+    {
+        if(sim_vector() == PORT1_VECTOR)
+            owed += pins_after[next];
+        else if(next == NEXT_TAIV && taiv_read)
+            owed += TAIV_LOOP;
+        polled = 0;
+    }
+    sim_cycles(owed);
+    owed = 0;
+}
+
+// dispatch.c's accesses in the port 1 and TAIV ISRs.
+static void access(unsigned int addr)
+{
+    int vector = sim_vector();
+    double us;
+
+    if(in_handler || (vector != PORT1_VECTOR && vector != TIMERA1_VECTOR))
+        return;
+    if(addr == TACCTL0_ADDR)
+    {
+        // The CCIFG clear, if the poll before it found the compare due.
+        us = sim_irq_waiting_us(TIMERA0_VECTOR);
+        if(polled && us >= 0 && us <= poll_us)
+        {
+            sim_cycles(owed);
+            owed = 0;
+            return;
+        }
+        pay(NEXT_POLL);
+        owed = POLL_CYCLES;
+        polled = 1;
+        poll_us = sim_time_us() + 4e6 / sim_mclk_hz();
+    }
+    else if(addr == P1IFG_ADDR)
+    {
+        pay(NEXT_PENDING);
+        // The read, then the clear after P1IE's.
+        if(pins_read++)
+            owed = PINS_START + PINS_LOOP;
+    }
+    else if(addr == TAIV_ADDR)
+    {
+        pay(NEXT_TAIV);
+        owed = TAIV_TEST;
+        taiv_read = 1;
+    }
+}
+
+// On entering a port 1 handler, and on leaving it up to the next poll.
+static void pins_enter(void)
+{
+    pay(NEXT_HANDLER);
+    in_handler = 1;
+}
+
+static void pins_leave(void)
+{
+    in_handler = 0;
+    owed = HANDLER_RET + PINS_BACK + PINS_NEXT + PINS_LOOP;
+}
+
+// The rest of an ISR, after its end poll or TAIV read.
+static void isr_done(int vector, double irq_us)
+{
+    (void)irq_us;
+    if(vector == PORT1_VECTOR || vector == TIMERA1_VECTOR)
+    {
+        pay(NEXT_DONE);
+        if(vector == TIMERA1_VECTOR)
+            sim_cycles(TAIV_LEAVE);
+    }
+}
+
+static unsigned char ir_edge(unsigned char pins)
+{
+    (void)pins;
+    pins_enter();
+    if(mode == FIRST_PIN)
+        measure();
+    else
+        (void)P1IN;
+    pins_leave();
+    return 0;
+}
+
+static unsigned char button(unsigned char pins)
+{
+    (void)pins;
+    pins_enter();
+    (void)P1IN;
+    pins_leave();
+    return 0;
+}
+
+static unsigned char other(unsigned char pins)
+{
+    (void)pins;
+    pins_enter();
+    if(mode == LAST_PIN)
+        measure();
+    pins_leave();
+    return 0;
+}
+
+// capture.c's edge(), charged like the others.
+static unsigned char timed_edge(unsigned char pins)
+{
+    unsigned char wake;
+
+    pins_enter();
+    wake = capture_edge(pins);
+    pins_leave();
+    return wake;
+}
+
+static unsigned char compare0(void)
+{
+    sim_cycles(TACCR0_ENTER);
+    measure();
+    TACCTL0 = 0;
+    sim_cycles(HANDLER_RET + TACCR0_LEAVE);
+    return 0;
+}
+
+// capture.c's tick(), charged for the path that called it: the TACCR0
+// vector, or a poll in the port 1 or TAIV ISR.
+static unsigned char timed_tick(void)
+{
+    int vector = sim_vector();
+    unsigned char wake;
+
+    if(vector == TIMERA0_VECTOR)
+        sim_cycles(TACCR0_ENTER + TICK_ENTER);
+    else
+        sim_cycles(FAST_ENTER + TICK_ENTER);
+    in_handler = 1;
+    in_tick = 1;
+    wake = capture_tick();
+    in_tick = 0;
+    in_handler = 0;
+    if(vector == TIMERA0_VECTOR)
+        sim_cycles(HANDLER_RET + TACCR0_LEAVE);
+    else
+    {
+        // Back at the poll, whose instructions after it come next.
+        owed = HANDLER_RET + FAST_LEAVE;
+        polled = 1;
+    }
+    return wake;
+}
+
+// capture_sample()'s read, the only one in tick().
+static void sample_read(unsigned int addr)
+{
+    if(!in_tick || addr != P1IN_ADDR)
+        return;
+    measure_from(sim_compare_us(0));
+    if(reads < CAPTURE_SAMPLES)
+        levels[reads] = (sim_port1() & IR_SENSOR) != 0;
+    reads++;
+}
+
+static void on_access(unsigned int addr)
+{
+    access(addr);
+    sample_read(addr);
+}
+
+// capture.c's handlers go through timed_edge() and timed_tick() in
+// sampling.
+unsigned char __real_dispatch_port1(unsigned char mask, unsigned char priority,
+                                    dispatch_port1_fn fn);
+void __real_dispatch_timer(unsigned char source, dispatch_timer_fn fn);
+
+unsigned char __wrap_dispatch_port1(unsigned char mask, unsigned char priority,
+                                    dispatch_port1_fn fn)
+{
+    if(mode == SAMPLING)
+    {
+        capture_edge = fn;
+        fn = timed_edge;
+    }
+    return __real_dispatch_port1(mask, priority, fn);
+}
+
+void __wrap_dispatch_timer(unsigned char source, dispatch_timer_fn fn)
+{
+    if(mode == SAMPLING && source == DISPATCH_TACCR0)
+    {
+        capture_tick = fn;
+        fn = timed_tick;
+    }
+    __real_dispatch_timer(source, fn);
+}
+
+// One source per TAIV interrupt: TACCR1 and TACCR2 never fall on the same
+// tick here.
+static void taiv_enter(void)
+{
+    pay(NEXT_HANDLER);
+    sim_cycles(TAIV_CALL);
+    in_handler = 1;
+}
+
+static void taiv_leave(void)
+{
+    in_handler = 0;
+    owed = HANDLER_RET + TAIV_BACK;
+}
+
+static unsigned char taccr1(void)
+{
+    taiv_enter();
+    TACCR1 += TACCR1_TICKS;
+    taiv_leave();
+    return 0;
+}
+
+static unsigned char taccr2(void)
+{
+    taiv_enter();
+    if(mode == COMPARE2)
+    {
+        measure();
+        TACCTL2 = 0;
+    }
+    else
+        TACCR2 += TACCR2_TICKS;
+    taiv_leave();
+    return 0;
+}
+
+// Handlers stay registered across the cases, the capture's from the
+// sampling case on. It runs last, its TACCR0 handler replaces compare0().
+static void setup(void)
+{
+    static int registered;
+    static int capturing;
+
+    WDTCTL = WDTPW | WDTHOLD;
+    DCOCTL = 0;
+    BCSCTL1 = CALBC1_8MHZ;
+    DCOCTL = CALDCO_8MHZ;
+    TACTL = TASSEL_2 | ID_3 | MC_2 | TACLR;
+
+    P1DIR &= ~PINS;
+    P1IES |= PINS;
+    P1IFG &= ~PINS;
+    P1IE |= PINS;
+
+    if(!registered)
+    {
+        registered = 1;
+        dispatch_port1(OTHER, 2, other);
+        dispatch_port1(IR_SENSOR, 0, ir_edge);
+        dispatch_port1(BUTTON, 1, button);
+        dispatch_timer(DISPATCH_TACCR0, compare0);
+        dispatch_timer(DISPATCH_TACCR1, taccr1);
+        dispatch_timer(DISPATCH_TACCR2, taccr2);
+    }
+    if(mode == SAMPLING && !capturing)
+    {
+        capturing = 1;
+        capture_init();
+    }
+}
+
+static int app(void)
+{
+    setup();
+    switch(mode)
+    {
+    case COMPARE0:
+        TACCR0 = TAR + 100;
+        TACCTL0 = CCIE;
+        break;
+    case COMPARE2:
+        TACCR1 = TAR + 50;
+        TACCR2 = TAR + 100;
+        TACCTL2 = CCIE;
+        break;
+    case SAMPLING:
+        TACCR1 = TAR + TACCR1_TICKS;
+        TACCR2 = TAR + TACCR2_TICKS;
+        TACCTL1 = CCIE;
+        TACCTL2 = CCIE;
+        break;
+    }
+    while(1)
+    {
+        __bis_status_register(LPM0_bits | GIE);
+        // Woken by the capture when its frame is full.
+        if(mode == SAMPLING)
+            capture_run();
+    }
+    return 0;
+}
+
+static void drive(void *arg)
+{
+    sim_drive(*(unsigned char *)arg, 0);
+}
+
+static void release(void *arg)
+{
+    sim_drive(*(unsigned char *)arg, *(unsigned char *)arg);
+}
+
+static void check(void)
+{
+    unsigned int budget = BUDGET_CYCLES;
+
+    if(mode == LAST_PIN)
+        budget += 2 * BUDGET_NEXT_CYCLES;
+    bench_set("errors", worst_us * 8 > budget);
+}
+
+// The frame on the UART against the levels read: header, then a bit per
+// sample from bit 0, space after the last.
+static unsigned int frame_errors(void)
+{
+    unsigned int errors = 0;
+    unsigned int i;
+
+    vuart_flush(&uart);
+    if(uart.len < HEADER_BYTES || uart.buf[0] != 0x21 ||
+       uart.buf[1] != (reads + 7) / 8 || uart.len != HEADER_BYTES +
+       uart.buf[1])
+    {
+        fprintf(stderr, "sampling: %u UART bytes, not a frame of %u "
+                "samples\n", uart.len, reads);
+        return 1;
+    }
+    for(i = 0; i < uart.buf[1] * 8u; ++i)
+    {
+        unsigned int bit = uart.buf[HEADER_BYTES + i / 8] >> (i % 8) & 1;
+        errors += bit != (i < reads ? levels[i] : 1);
+    }
+    if(errors)
+        fprintf(stderr, "sampling: %u samples sent not as read\n", errors);
+    return errors;
+}
+
+static void check_sampling(void)
+{
+    unsigned int errors = frame_errors();
+
+    if(capture_missed())
+        fprintf(stderr, "sampling: %u samples missed\n", capture_missed());
+    errors += capture_missed() + (reads != CAPTURE_SAMPLES);
+    bench_set("samples", reads);
+    bench_set("errors", worst_us * 8 > SAMPLE_LATE_CYCLES || errors);
+}
+
+static int run(const char *name, int m, double seconds, void (*done)(void))
+{
+    mode = m;
+    irq_seen_us = -1;
+    worst_us = 0;
+    sim_drive(PINS, PINS);
+    return bench_run(name, app, seconds, done);
+}
+
+// 9 ms leader mark, 4.5 ms space, then 562.5 us marks with 1687.5 us
+// (1) or 562.5 us (0) spaces, past the capture's end, from t_us.
+static void nec_frame(double t_us, unsigned long code)
+{
+    static unsigned char ir = IR_SENSOR;
+    int i;
+
+    sim_at(t_us, drive, &ir);
+    sim_at(t_us + 9000, release, &ir);
+    t_us += 13500;
+    for(i = 0; i < 8; ++i)
+    {
+        sim_at(t_us, drive, &ir);
+        sim_at(t_us + 562.5, release, &ir);
+        t_us += 562.5 + ((code >> i) & 1 ? 1687.5 : 562.5);
+    }
+}
+
+int main(void)
+{
+    static unsigned char ir = IR_SENSOR;
+    static unsigned char all = PINS;
+    static unsigned char button_pin = BUTTON;
+    int ok = 1;
+    int i;
+
+    sim_isr_done = isr_done;
+    sim_access = on_access;
+
+    sim_at(1e3, drive, &ir);
+    ok &= run("dispatch/port1", FIRST_PIN, 2e-3, check);
+    sim_at(1e3, drive, &all);
+    ok &= run("dispatch/port1_last", LAST_PIN, 2e-3, check);
+    ok &= run("dispatch/taccr0", COMPARE0, 2e-3, check);
+    ok &= run("dispatch/taiv", COMPARE2, 2e-3, check);
+
+    for(i = 0; i < STIMULUS_US / 1e3; ++i)
+    {
+        sim_at(i * 1e3 + 500, drive, &button_pin);
+        sim_at(i * 1e3 + 900, release, &button_pin);
+    }
+    nec_frame(1.2e3, 0xef);
+    vuart_attach(&uart, UART_TX, 9600);
+    ok &= run("dispatch/sampling", SAMPLING, SAMPLING_S, check_sampling);
+    sim_detach(&uart.dev);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+// interrupt_count benchmark on a virtual HD44780, see ../bench.h.
+//
+//     ./bench_interrupt_count
+//
+// press: 100 presses, 100 ms apart and held for 40 ms. The LCD can only
+// have D7 back once the button is up, so each update is timed from the
+// release to the last E pulse it causes. us and bus_bytes are the last
+// update (99 to 100, the longest carry), avg_us and avg_bytes the mean
+// over all of them. errors is 1 if the display doesn't end on 100.
+//
+// press_bounce: BOUNCE_PRESSES presses that bounce on both edges, held
+// 2 to 21 ms and pressed again 19 to 21 ms after the release, around the
+// 20 ms debounce. The LCD takes D7 for the update as soon as the button
+// is up, so the release bounce and the next press land while it is
+// sending or has a nibble queued. errors is 1 if the display doesn't end
+// on BOUNCE_PRESSES. us is the whole run, bus_bytes what it sent.
+//
+// boot: from reset until the first count, 0, is on the display.
+//
+// digits_divide, digits_bcd: the count turned into characters for the
+// update from 99 to 100, at 1 Mhz. divide is the i % 10, i /= 10 loop
+// main() had before the count was BCD, bcd count_show()'s nibbles.
+// avg_cycles is the mean over 1 to 9999. Both are computation only, so
+// the cases charge the cycles counted below by hand: estimates
+// (bench_estimate()), not gated.
+
+#include <msp430.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../bench.h"
+#include "../sim.h"
+#include "../vhd44780.h"
+
+#define BUTTON (1 << 3)
+#define LCD_E  (1 << 4)
+
+#define PRESSES  100
+#define FIRST_US 200e3
+#define EVERY_US 100e3
+#define HOLD_US  40e3
+
+// Counted by hand for mspgcc -Os code with SLAU144's cycle table, so
+// they don't follow interrupt_count.c when it changes. The G2231 has no
+// multiplier, % and / are libgcc's __modhi3 and __divhi3: the argument
+// (2) and call (5), the sign checks (10), 16 rounds of shift, compare and
+// subtract (136), ret (3), 156 each. A digit is both plus the character
+// stored and the loop (14): 326.
+#define DIVIDE_DIGIT_CYCLES 326
+// buf[9], p, the zero test (12), the ring put's argument (2).
+#define DIVIDE_SETUP_CYCLES 14
+// count_show(), a digit: the nibble (7), lead (8), the character (6),
+// compared with count_shown (7), bcd <<= 4 and the loop (9).
+#define BCD_DIGIT_CYCLES 37
+// first and lead set (3), the digits' loop entered (2), the first test
+// after it (4), call and ret (8).
+#define BCD_SETUP_CYCLES 17
+#define DIGITS_COUNT 100
+
+#define BOUNCE_PRESSES 120
+// Contact bounce: the pin flips at these offsets from the edge, an even
+// number of times, so it ends where the edge went.
+static const double bounce_us[] = {60, 140, 200, 330, 410, 700};
+
+int sim_app_main(void);
+
+// From interrupt_count.c.
+extern volatile unsigned int count;
+extern char count_shown[];
+
+static vhd44780 lcd;
+static double release_us;
+static double last_e_us;
+static unsigned long release_bytes;
+static double total_us;
+static unsigned long total_bytes;
+static unsigned int updates;
+static int booting;
+
+static unsigned long bytes(void)
+{
+    return lcd.instructions + lcd.data_writes;
+}
+
+// Closes the update the previous release started.
+static void update_done(void)
+{
+    if(release_us && last_e_us > release_us)
+    {
+        total_us += last_e_us - release_us;
+        total_bytes += bytes() - release_bytes;
+        updates++;
+    }
+}
+
+static void press(void *arg)
+{
+    (void)arg;
+    sim_drive(BUTTON, 0);
+}
+
+static void release(void *arg)
+{
+    (void)arg;
+    update_done();
+    sim_release(BUTTON);
+    release_us = sim_time_us();
+    release_bytes = bytes();
+    bench_begin(release_bytes);
+}
+
+// Called after lcd (attached before it), so the write is counted.
+static void e_fall(sim_device *dev, unsigned char old, unsigned char now)
+{
+    (void)dev;
+    if(!(old & LCD_E) || (now & LCD_E))
+        return;
+    if(booting && lcd.ddram[3] == '0')
+    {
+        booting = 0;
+        bench_begin_at(0, 0);
+        bench_end(bytes());
+    }
+    if(!release_us)
+        return;
+    last_e_us = sim_time_us();
+    bench_end(bytes());
+}
+
+static sim_device e_dev = {"e", e_fall, 0};
+
+static void button_low(void *arg)
+{
+    (void)arg;
+    sim_drive(BUTTON, 0);
+}
+
+static void button_high(void *arg)
+{
+    (void)arg;
+    sim_release(BUTTON);
+}
+
+// An edge to level (1 up, 0 down) at t, bouncing first.
+static void bounce_edge(double t, int level)
+{
+    unsigned int i;
+
+    sim_at(t, level ? button_high : button_low, 0);
+    for(i = 0; i < sizeof(bounce_us) / sizeof(bounce_us[0]); ++i)
+        sim_at(t + bounce_us[i], (level ^ (i & 1)) ? button_low : button_high,
+               0);
+}
+
+// The old conversion of n.
+static unsigned long divide_cycles(unsigned int n)
+{
+    unsigned long cycles = DIVIDE_SETUP_CYCLES;
+
+    // '0' for 0, else a digit at a time.
+    do
+    {
+        cycles += DIVIDE_DIGIT_CYCLES;
+        n /= 10;
+    }
+    while(n);
+    return cycles;
+}
+
+// count_show() always goes through the 4 digits.
+static unsigned long bcd_cycles(unsigned int n)
+{
+    (void)n;
+    return BCD_SETUP_CYCLES + 4 * BCD_DIGIT_CYCLES;
+}
+
+static unsigned long (*digits_cycles)(unsigned int n);
+
+static int digits_app(void)
+{
+    WDTCTL = WDTPW | WDTHOLD;
+    DCOCTL = 0;
+    BCSCTL1 = CALBC1_1MHZ;
+    DCOCTL = CALDCO_1MHZ;
+    bench_begin(0);
+    sim_cycles(digits_cycles(DIGITS_COUNT));
+    bench_end(0);
+    return 0;
+}
+
+static void digits_done(void)
+{
+    unsigned long total = 0;
+    unsigned int n;
+
+    for(n = 1; n <= 9999; ++n)
+        total += digits_cycles(n);
+    bench_estimate();
+    bench_set("avg_cycles", total / 9999.0);
+}
+
+static int shown_count(void)
+{
+    char shown[VHD44780_COLS + 1];
+    int n = -1;
+    int end = 0;
+    int i;
+
+    // Only the count on the first line, spaces for what was never
+    // written.
+    for(i = 0; i < VHD44780_COLS; ++i)
+        shown[i] = lcd.ddram[i] ? lcd.ddram[i] : ' ';
+    shown[i] = 0;
+    sscanf(shown, " %d %n", &n, &end);
+    return end == VHD44780_COLS ? n : -1;
+}
+
+// Schedules press i and, from there, the next one: all of them at once
+// won't fit in the event queue.
+static unsigned int bounce_i;
+static double bounce_t;
+
+static void bounce_press(void *arg)
+{
+    // Holds and gaps swept in 250 and 50 us steps so the edges fall at
+    // every point of the debounce and the LCD update.
+    double hold = 2e3 + (bounce_i % 77) * 250;
+
+    (void)arg;
+    bounce_edge(bounce_t, 0);
+    bounce_edge(bounce_t + hold, 1);
+    bounce_t += hold + 19e3 + (bounce_i % 41) * 50;
+    if(++bounce_i < BOUNCE_PRESSES)
+        sim_at(bounce_t, bounce_press, 0);
+}
+
+// The whole sweep, for the run time.
+static double bounce_us_total(void)
+{
+    double t = FIRST_US;
+    unsigned int i;
+
+    for(i = 0; i < BOUNCE_PRESSES; ++i)
+        t += 2e3 + (i % 77) * 250 + 19e3 + (i % 41) * 50;
+    return t;
+}
+
+static int bounce_app(void)
+{
+    bench_begin(0);
+    return sim_app_main();
+}
+
+static void bounce_done(void)
+{
+    int n = shown_count();
+
+    bench_end(bytes());
+    bench_set("errors", n != BOUNCE_PRESSES);
+}
+
+static void press_done(void)
+{
+    update_done();
+    if(updates)
+    {
+        bench_set("avg_us", total_us / updates);
+        bench_set("avg_bytes", (double)total_bytes / updates);
+    }
+    bench_set("errors", shown_count() != PRESSES || updates != PRESSES);
+}
+
+// Display fresh from power on again.
+static void lcd_reset(void)
+{
+    sim_detach(&lcd.dev);
+    memset(&lcd, 0, sizeof(lcd));
+    vhd44780_attach(&lcd, 1 << 5, LCD_E, 0x0f);
+}
+
+int main(void)
+{
+    int ok = 1;
+    int i;
+
+    sim_attach(&e_dev);
+    vhd44780_attach(&lcd, 1 << 5, LCD_E, 0x0f);
+    booting = 1;
+    ok &= bench_run("interrupt_count/boot", sim_app_main, 1, 0);
+    booting = 0;
+
+    lcd_reset();
+    for(i = 0; i < PRESSES; ++i)
+    {
+        sim_at(FIRST_US + i * EVERY_US, press, 0);
+        sim_at(FIRST_US + i * EVERY_US + HOLD_US, release, 0);
+    }
+    ok &= bench_run("interrupt_count/press", sim_app_main,
+                    (FIRST_US + PRESSES * EVERY_US) / 1e6, press_done);
+
+    // Counting from 0 again, on a display cleared at boot.
+    lcd_reset();
+    count = 0;
+    memset(count_shown, ' ', 4);
+    release_us = 0;
+    bounce_t = FIRST_US;
+    sim_at(bounce_t, bounce_press, 0);
+    ok &= bench_run("interrupt_count/press_bounce", bounce_app,
+                    (bounce_us_total() + 100e3) / 1e6, bounce_done);
+
+    sim_detach(&lcd.dev);
+    sim_detach(&e_dev);
+    digits_cycles = divide_cycles;
+    ok &= bench_run("interrupt_count/digits_divide", digits_app, 0.1,
+                    digits_done);
+    digits_cycles = bcd_cycles;
+    ok &= bench_run("interrupt_count/digits_bcd", digits_app, 0.1,
+                    digits_done);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,701 @@
+// lcddemo benchmarks on a virtual PCD8544, see ../bench.h.
+//
+//     ./bench_lcddemo [-u]
+//
+// display_clear: the 504 bytes of a clear, from display_goto().
+// frame: a full screen of a pattern, checked on the glass (errors).
+// burst_*mhz: BURST_FRAMES full screens with display_send_bytes() at
+// each clock, spi_clock() keeping SCLK at 4 Mhz at most. bytes_per_s and
+// fps are over all of them, the last one is checked on the glass.
+// rand_int: the generator's period.
+// text_line: one 14 character line with a number, text_puts(), at
+// lcddemo's 16 Mhz. errors also if it takes LINE_US or more.
+// text_line_1mhz: the same at 1 Mhz, where SCLK is 1 Mhz too: 84 bytes
+// of 16 bit shifts, each loaded with two register writes, take 1008 us
+// whatever the code around them does.
+// text_screen: 84 characters blitted into a frame buffer and sent with
+// display_send_bytes().
+// text_utoa: text_utoa() checked against printf for every 16 bit value.
+// physics_landing: jumps onto a block at the fastest and the slowest
+// frame rate, errors unless the player lands on it, rides it and falls
+// back to the ground when it has gone past.
+// physics_frame_rate: one jump at dt 5 to PHYSICS_DT_MAX (10 to 131 ms
+// frames). peak_spread_px and air_spread_ms are how much its height and
+// its time in the air (to the frame) vary; table_air_spread_ms is the
+// same for the step tables lcddemo jumped with before, whose jump took a
+// number of frames. errors if the height varies by more than a pixel.
+// rand_int, text_utoa and the physics cases are computation only and
+// take no simulated time, so they are checks without us or cycles (see
+// ../bench.h).
+// physics_step, physics_table_step: one frame of lcddemo's jump at 1 Mhz,
+// coming down over lcddemo's 2 blocks at dt 10 (20 ms), the longest
+// path: physics_step() and the step tables it replaced. Computation
+// only, so the cases charge the cycles counted below by hand: estimates
+// (bench_estimate()), not gated. jump_cycles is a whole jump from the
+// ground at dt 10.
+// scroll_redraw_*, scroll_ring_*: SCROLL_FRAMES frames of two blocks
+// 5 or 20 columns wide going past, without the player. redraw is how
+// lcddemo drew them before world.h, each block drawn and then erased a
+// byte at a time; ring is world_flush() and world_scroll(). us_per_frame
+// and bytes_per_frame are the means. errors counts the frames where the
+// ring's bank on the glass isn't the blocks.
+// boot: lcddemo from reset until the score's 0 is on the display, the
+// first frame.
+//
+// The text cases compare the glass with golden/<case>.pbm (errors are
+// the pixels that differ). -u writes the images instead, look at them
+// before committing.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <msp430.h>
+
+#include "../bench.h"
+#include "../sim.h"
+#include "../vpcd8544.h"
+#include "clock.h"
+#include "pcd8544.h"
+#include "physics.h"
+#include "spi.h"
+#include "text.h"
+#include "world.h"
+
+#define FRAME_BYTES (VPCD8544_BANKS * VPCD8544_COLS)
+#define BURST_FRAMES 10
+#define SCROLL_FRAMES 100
+#define LINE_US 1000
+
+// physics.c and the old tables counted by hand for mspgcc -Os with
+// SLAU144's cycle table, so they don't follow the code. scale(): the
+// arguments and call (7), x >>= 1 (1), sum and bit (2), ret (3), and per
+// bit of dt sum >>= 1 (1), the test (3), bit <<= 1 and the loop (3), the
+// add when dt has it (1).
+#define SCALE_CYCLES     13
+#define SCALE_BIT_CYCLES 7
+// physics_step(): call and arguments (8), 4 pushes (12), floor (2), dt
+// clamped (4).
+#define STEP_ENTER_CYCLES 26
+// Both scale() results added to b->v and b->y, the mean's halves (14).
+#define STEP_MOVE_CYCLES  14
+// v >= 0 (3), b->y against the block's top (5).
+#define STEP_TEST_CYCLES  8
+// A block tested: col < PHYSICS_WIDTH (7), col + len >= 0 (8), floor (2),
+// the loop (5).
+#define STEP_BLOCK_CYCLES 22
+// standing worked out and stored (9), y and v stored (8), 4 pops (8),
+// ret (3).
+#define STEP_LEAVE_CYCLES 28
+// The tables' longest frame, coming down: gravity_pending tested (5),
+// the index against the end (5), the row against the ground (5), the
+// previous row kept (6), the row stepped and the index moved on (13),
+// button_pressed skipped (5), the block under the player tested (13).
+#define TABLE_FRAME_CYCLES 52
+#define PHYSICS_BLOCKS 2
+#define PHYSICS_DT 10
+
+// From lcddemo.c.
+void init_cpu(void);
+unsigned int rand_int();
+extern volatile unsigned int rand;
+
+static vpcd8544 lcd;
+static int update_golden;
+static unsigned char burst_mhz;
+static double burst_us;
+static signed char scroll_len;
+static double scroll_us;
+static unsigned long scroll_bytes;
+static unsigned int scroll_errors;
+static int booted;
+
+static unsigned long bytes(void)
+{
+    return lcd.commands + lcd.data;
+}
+
+// Checkerboard, one byte per column.
+static unsigned char pattern(unsigned int i)
+{
+    return (i % VPCD8544_COLS) & 1 ? 0xaa : 0x55;
+}
+
+static int display_clear_app(void)
+{
+    init_cpu();
+    display_init();
+    bench_begin(bytes());
+    display_clear();
+    bench_end(bytes());
+    return 0;
+}
+
+static int frame_app(void)
+{
+    unsigned int i;
+
+    init_cpu();
+    display_init();
+    bench_begin(bytes());
+    display_goto(0, 0);
+    DISPLAY_SET_DATA();
+    for(i = 0; i < FRAME_BYTES; ++i)
+        display_send_byte(pattern(i));
+    bench_end(bytes());
+    return 0;
+}
+
+// display_init() sets horizontal addressing: column first, then bank.
+static void frame_done(void)
+{
+    unsigned int errors = 0;
+    unsigned int i;
+
+    for(i = 0; i < FRAME_BYTES; ++i)
+        if(lcd.ram[i / VPCD8544_COLS][i % VPCD8544_COLS] != pattern(i))
+            errors++;
+    bench_set("errors", errors);
+}
+
+// MCLK and SMCLK at mhz, SCLK divided to at most 4 Mhz.
+static void set_clock(unsigned char mhz)
+{
+    // Firmware globals outlive a run, the listener only goes in once.
+    static unsigned char listening;
+
+    if(!listening)
+        listening = clock_listen(spi_clock);
+    clock_set(mhz);
+}
+
+static int burst_app(void)
+{
+    static unsigned char frame[FRAME_BYTES];
+    unsigned int i;
+
+    init_cpu();
+    set_clock(burst_mhz);
+    display_init();
+    for(i = 0; i < FRAME_BYTES; ++i)
+        frame[i] = pattern(i);
+
+    bench_begin(bytes());
+    burst_us = sim_time_us();
+    for(i = 0; i < BURST_FRAMES; ++i)
+    {
+        display_goto(0, 0);
+        DISPLAY_SET_DATA();
+        display_send_bytes(frame, FRAME_BYTES);
+    }
+    burst_us = sim_time_us() - burst_us;
+    bench_end(bytes());
+    return 0;
+}
+
+static void burst_done(void)
+{
+    frame_done();
+    bench_set("bytes_per_s", (long)(BURST_FRAMES * FRAME_BYTES * 1e6 /
+                                    burst_us));
+    bench_set("fps", (long)(BURST_FRAMES * 1e6 / burst_us));
+}
+
+// Blocks as lcddemo moves them, a new one at the right edge when the
+// first is gone.
+static void scroll_blocks(block *blocks)
+{
+    blocks[0].col--;
+    blocks[1].col--;
+    if(blocks[0].col == -blocks[0].len)
+    {
+        blocks[0] = blocks[1];
+        blocks[1].col = 84;
+    }
+}
+
+// Whether the blocks' bank on the glass is blocks.
+static int scroll_shown(const block *blocks)
+{
+    int col;
+    int j;
+
+    for(col = 0; col < VPCD8544_COLS; ++col)
+    {
+        unsigned char want = 0;
+        for(j = 0; j < 2; ++j)
+            if(col >= blocks[j].col && col < blocks[j].col + blocks[j].len)
+                want = 0xff;
+        if(lcd.ram[WORLD_BANK][col] != want)
+            return 0;
+    }
+    return 1;
+}
+
+static void scroll_begin(void)
+{
+    scroll_errors = 0;
+    bench_begin(bytes());
+    scroll_us = sim_time_us();
+    scroll_bytes = bytes();
+}
+
+static void scroll_end(void)
+{
+    scroll_us = sim_time_us() - scroll_us;
+    scroll_bytes = bytes() - scroll_bytes;
+    bench_end(bytes());
+}
+
+static void scroll_done(void)
+{
+    bench_set("us_per_frame", scroll_us / SCROLL_FRAMES);
+    bench_set("bytes_per_frame", (double)scroll_bytes / SCROLL_FRAMES);
+    bench_set("errors", scroll_errors);
+}
+
+static int scroll_redraw_app(void)
+{
+    block blocks[2] = {{20, scroll_len}, {50, scroll_len}};
+    unsigned int frame;
+    unsigned char j;
+    signed char i;
+
+    init_cpu();
+    display_init();
+    scroll_begin();
+    for(frame = 0; frame < SCROLL_FRAMES; ++frame)
+    {
+        for(j = 0; j < 2; ++j)
+        {
+            signed char begin = blocks[j].col < 0 ? 0 : blocks[j].col;
+            signed char end = blocks[j].col + blocks[j].len;
+            if(end > 84)
+                end = 84;
+            if(begin >= end)
+                continue;
+            display_goto(4, begin);
+            DISPLAY_SET_DATA();
+            for(i = begin; i < end; ++i)
+                display_send_byte(0xff);
+        }
+        for(j = 0; j < 2; ++j)
+        {
+            signed char begin = blocks[j].col < 0 ? 0 : blocks[j].col;
+            signed char end = blocks[j].col + blocks[j].len;
+            if(end > 84)
+                end = 84;
+            if(begin >= end)
+                continue;
+            display_goto(4, begin);
+            DISPLAY_SET_DATA();
+            for(i = begin; i < end; ++i)
+                display_send_byte(0x00);
+        }
+        scroll_blocks(blocks);
+    }
+    scroll_end();
+    return 0;
+}
+
+static int scroll_ring_app(void)
+{
+    block blocks[2] = {{20, scroll_len}, {50, scroll_len}};
+    unsigned int frame;
+
+    init_cpu();
+    display_init();
+    world_init(blocks, 2);
+    scroll_begin();
+    for(frame = 0; frame < SCROLL_FRAMES; ++frame)
+    {
+        world_flush(0, 0);
+        scroll_errors += !scroll_shown(blocks);
+        scroll_blocks(blocks);
+        world_scroll(blocks, 2);
+    }
+    scroll_end();
+    return 0;
+}
+
+// Int is 16 bits on the MSP430, only the low bits feed back.
+static void rand_int_done(void)
+{
+    unsigned int seed = rand & 0xffff;
+    unsigned long period = 0;
+
+    do
+        rand_int();
+    while(++period <= 0x10000 && (rand & 0xffff) != seed);
+    bench_set("period", period);
+}
+
+static void golden(const char *name)
+{
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s/%s.pbm", GOLDEN_DIR, name);
+    if(update_golden)
+    {
+        if(!vpcd8544_save_pbm(&lcd, path))
+            perror(path);
+        return;
+    }
+    long differ = vpcd8544_compare_pbm(&lcd, path);
+    if(differ < 0)
+    {
+        fprintf(stderr, "%s: missing or not %dx%d\n", path, VPCD8544_COLS,
+                8 * VPCD8544_BANKS);
+        differ = VPCD8544_COLS * 8 * VPCD8544_BANKS;
+    }
+    bench_set("errors", differ);
+}
+
+static unsigned char line_mhz;
+static double line_us;
+
+static int text_line_app(void)
+{
+    char line[TEXT_COLS + 1] = "Score ";
+
+    init_cpu();
+    set_clock(line_mhz);
+    display_init();
+    text_goto(2, 0);
+    bench_begin(bytes());
+    line_us = sim_time_us();
+    text_utoa(65535, line + 6, TEXT_COLS - 6);
+    text_puts(line);
+    line_us = sim_time_us() - line_us;
+    bench_end(bytes());
+    return 0;
+}
+
+static void text_line_done(void)
+{
+    golden("text_line");
+}
+
+static void text_line_fast_done(void)
+{
+    golden("text_line");
+    if(line_us >= LINE_US)
+        bench_set("errors", 1);
+}
+
+static int text_screen_app(void)
+{
+    static unsigned char frame[TEXT_LINES][VPCD8544_COLS];
+    char line[TEXT_COLS + 1];
+    unsigned char i;
+    unsigned char j;
+
+    init_cpu();
+    display_init();
+    bench_begin(bytes());
+    for(i = 0; i < TEXT_LINES; ++i)
+    {
+        for(j = 0; j < TEXT_COLS; ++j)
+            line[j] = TEXT_FIRST + i * TEXT_COLS + j;
+        line[j] = 0;
+        text_blit(frame[i], line);
+    }
+    display_goto(0, 0);
+    DISPLAY_SET_DATA();
+    display_send_bytes(frame[0], sizeof(frame));
+    bench_end(bytes());
+    return 0;
+}
+
+static void text_screen_done(void)
+{
+    golden("text_screen");
+}
+
+static void text_utoa_done(void)
+{
+    char want[8];
+    char got[8];
+    unsigned long errors = 0;
+    unsigned int n;
+
+    for(n = 0; n <= 0xffff; ++n)
+    {
+        snprintf(want, sizeof(want), "%u", n);
+        errors += text_utoa(n, got, 0) != strlen(want) || strcmp(got, want);
+        snprintf(want, sizeof(want), "%5u", n);
+        errors += text_utoa(n, got, 5) != 5 || strcmp(got, want);
+    }
+    bench_set("errors", errors);
+}
+
+// For the checks, which do their work in done.
+static int computation_app(void)
+{
+    init_cpu();
+    return 0;
+}
+
+// Frames of dt, as lcddemo's loop steps them: physics, then the blocks
+// move a column left. Jumps when the block gets to jump_col.
+static unsigned int landing_errors(unsigned char dt, signed char jump_col)
+{
+    physics_body player = {PHYSICS_FIX(PHYSICS_GROUND), 0, 1};
+    block blocks[1] = {{30, 10}};
+    unsigned char rode = 0;
+    unsigned int frame;
+
+    for(frame = 0; blocks[0].col > -blocks[0].len - 40; ++frame)
+    {
+        if(blocks[0].col == jump_col && !physics_jump(&player))
+            return 1;
+        physics_step(&player, dt, blocks, 1);
+        if(player.y > PHYSICS_FIX(PHYSICS_GROUND))
+            return 1;
+        // Standing over the block has to be on it.
+        if(player.standing && blocks[0].col < PHYSICS_WIDTH &&
+           blocks[0].col + blocks[0].len > 0 && frame > 1)
+        {
+            if(player.y != PHYSICS_FIX(PHYSICS_BLOCK))
+                return 1;
+            rode = 1;
+        }
+        blocks[0].col--;
+    }
+    return !rode || !player.standing ||
+           player.y != PHYSICS_FIX(PHYSICS_GROUND);
+}
+
+static void physics_landing_done(void)
+{
+    unsigned int errors = 0;
+
+    // Early enough that the block doesn't run into the player and late
+    // enough that it comes down on it. Blocks move a column per frame, so
+    // short frames jump from further away.
+    errors += landing_errors(5, 27);
+    errors += landing_errors(20, 8);
+    errors += landing_errors(PHYSICS_DT_MAX, 5);
+    bench_set("errors", errors);
+}
+
+// lcddemo's jump before the physics: a row step per frame from these
+// tables, then one frame to switch to falling and one to stop.
+static unsigned int table_air_frames(void)
+{
+    static const unsigned char up[] = {1, 2, 3, 1, 1, 0, 0, 0};
+    static const unsigned char down[] = {1, 2, 2, 3, 4, 4};
+    unsigned char row = PHYSICS_GROUND;
+    unsigned int frames = sizeof(up) + 1;
+    unsigned int i;
+
+    for(i = 0; i < sizeof(up); ++i)
+        row -= up[i];
+    for(i = 0; i < sizeof(down) && row != PHYSICS_GROUND; ++i, ++frames)
+        row += down[i];
+    return frames + 1;
+}
+
+static void physics_frame_rate_done(void)
+{
+    static const unsigned char dts[] = {5, 10, 20, 40, PHYSICS_DT_MAX};
+    // A dt in ms.
+    const double dt_ms = PHYSICS_DT_TICKS / 125.0;
+    double peak_min = 1e9, peak_max = 0;
+    double air_min = 1e9, air_max = 0;
+    double table_min, table_max;
+    unsigned int i;
+
+    for(i = 0; i < sizeof(dts); ++i)
+    {
+        physics_body player = {PHYSICS_FIX(PHYSICS_GROUND), 0, 1};
+        int top = player.y;
+        unsigned int frames = 0;
+
+        physics_jump(&player);
+        do
+        {
+            physics_step(&player, dts[i], 0, 0);
+            if(player.y < top)
+                top = player.y;
+            frames++;
+        }
+        while(!player.standing && frames < 1000);
+
+        double peak = (PHYSICS_FIX(PHYSICS_GROUND) - top) / 256.0;
+        double air = frames * dts[i] * dt_ms;
+        peak_min = peak < peak_min ? peak : peak_min;
+        peak_max = peak > peak_max ? peak : peak_max;
+        air_min = air < air_min ? air : air_min;
+        air_max = air > air_max ? air : air_max;
+    }
+    table_min = table_air_frames() * dts[0] * dt_ms;
+    table_max = table_air_frames() * dts[sizeof(dts) - 1] * dt_ms;
+
+    bench_set("peak_px", peak_max);
+    bench_set("peak_spread_px", peak_max - peak_min);
+    bench_set("air_spread_ms", air_max - air_min);
+    bench_set("table_air_spread_ms", table_max - table_min);
+    bench_set("errors", peak_max - peak_min > 1);
+}
+
+static unsigned long scale_cycles(unsigned char dt)
+{
+    unsigned long n = SCALE_CYCLES + 8 * SCALE_BIT_CYCLES;
+
+    for(; dt; dt >>= 1)
+        n += dt & 1;
+    return n;
+}
+
+// physics_step() on b before it, over n blocks.
+static unsigned long step_cycles(const physics_body *b, unsigned char dt,
+                                 unsigned char n)
+{
+    unsigned long cycles = STEP_ENTER_CYCLES + 2 * scale_cycles(dt) +
+                           STEP_MOVE_CYCLES + STEP_TEST_CYCLES +
+                           STEP_LEAVE_CYCLES;
+    physics_body next = *b;
+
+    // The blocks are tested with the new velocity.
+    physics_step(&next, dt, 0, 0);
+    if(next.v >= 0 && b->y <= PHYSICS_FIX(PHYSICS_BLOCK))
+        cycles += n * STEP_BLOCK_CYCLES;
+    return cycles;
+}
+
+// Blocks out of the way, so the jump lands on the ground.
+static const block away[PHYSICS_BLOCKS] = {{60, 5}, {75, 5}};
+
+static unsigned long (*frame_cycles)(void);
+static unsigned long (*jump_cycles)(void);
+
+static unsigned long physics_frame_cycles(void)
+{
+    // Coming down, above the blocks' top.
+    physics_body b = {PHYSICS_FIX(PHYSICS_BLOCK - 4), 1000, 0};
+
+    return step_cycles(&b, PHYSICS_DT, PHYSICS_BLOCKS);
+}
+
+static unsigned long physics_jump_cycles(void)
+{
+    physics_body b = {PHYSICS_FIX(PHYSICS_GROUND), 0, 1};
+    unsigned long cycles = 0;
+
+    physics_jump(&b);
+    do
+    {
+        cycles += step_cycles(&b, PHYSICS_DT, PHYSICS_BLOCKS);
+        physics_step(&b, PHYSICS_DT, away, PHYSICS_BLOCKS);
+    }
+    while(!b.standing);
+    return cycles;
+}
+
+static unsigned long table_frame_cycles(void)
+{
+    return TABLE_FRAME_CYCLES;
+}
+
+// The tables took the same frames whatever the frame rate.
+static unsigned long table_jump_cycles(void)
+{
+    return table_air_frames() * TABLE_FRAME_CYCLES;
+}
+
+static int physics_cycles_app(void)
+{
+    init_cpu();
+    bench_begin(0);
+    sim_cycles(frame_cycles());
+    bench_end(0);
+    bench_estimate();
+    bench_set("jump_cycles", jump_cycles());
+    return 0;
+}
+
+// Called after lcd (attached before it), so the transfer is seen.
+static void boot_sce(sim_device *dev, unsigned char old, unsigned char now)
+{
+    static const unsigned char *zero = text_font['0' - TEXT_FIRST];
+    unsigned char *at = lcd.ram[0] + (TEXT_COLS - 1) * TEXT_WIDTH;
+
+    (void)dev;
+    if(!(~old & now & DISPLAY_SCE) || booted ||
+       memcmp(at, zero, TEXT_GLYPH_WIDTH))
+        return;
+    booted = 1;
+    bench_begin_at(0, 0);
+    bench_end(bytes());
+}
+
+static sim_device boot_dev = {"boot", boot_sce, 0};
+
+int sim_app_main(void);
+
+// Runs a case on a display fresh from power on.
+static int run(const char *name, int (*app)(void), void (*done)(void))
+{
+    memset(&lcd, 0, sizeof(lcd));
+    vpcd8544_attach(&lcd, 1 << 1, 1 << 2, 1 << 4, 1 << 5, 1 << 6);
+    int ok = bench_run(name, app, 1, done);
+    sim_detach(&lcd.dev);
+    return ok;
+}
+
+static int check(const char *name, void (*done)(void))
+{
+    return bench_check(name, computation_app, 1, done);
+}
+
+int main(int argc, char **argv)
+{
+    static const unsigned char mhz[] = {1, 8, 16};
+    static const unsigned char widths[] = {5, 20};
+    char name[32];
+    unsigned int i;
+    int ok = 1;
+
+    update_golden = argc > 1 && !strcmp(argv[1], "-u");
+
+    ok &= run("lcddemo/display_clear", display_clear_app, 0);
+    ok &= run("lcddemo/frame", frame_app, frame_done);
+    for(i = 0; i < sizeof(mhz); ++i)
+    {
+        burst_mhz = mhz[i];
+        snprintf(name, sizeof(name), "lcddemo/burst_%umhz", mhz[i]);
+        ok &= run(name, burst_app, burst_done);
+    }
+    for(i = 0; i < sizeof(widths); ++i)
+    {
+        scroll_len = widths[i];
+        snprintf(name, sizeof(name), "lcddemo/scroll_redraw_%u", widths[i]);
+        ok &= run(name, scroll_redraw_app, scroll_done);
+        snprintf(name, sizeof(name), "lcddemo/scroll_ring_%u", widths[i]);
+        ok &= run(name, scroll_ring_app, scroll_done);
+    }
+    ok &= check("lcddemo/rand_int", rand_int_done);
+    line_mhz = 16;
+    ok &= run("lcddemo/text_line", text_line_app, text_line_fast_done);
+    line_mhz = 1;
+    ok &= run("lcddemo/text_line_1mhz", text_line_app, text_line_done);
+    ok &= run("lcddemo/text_screen", text_screen_app, text_screen_done);
+    ok &= check("lcddemo/text_utoa", text_utoa_done);
+    ok &= check("lcddemo/physics_landing", physics_landing_done);
+    ok &= check("lcddemo/physics_frame_rate", physics_frame_rate_done);
+    frame_cycles = physics_frame_cycles;
+    jump_cycles = physics_jump_cycles;
+    ok &= run("lcddemo/physics_step", physics_cycles_app, 0);
+    frame_cycles = table_frame_cycles;
+    jump_cycles = table_jump_cycles;
+    ok &= run("lcddemo/physics_table_step", physics_cycles_app, 0);
+
+    // Not for the whole second, the game itself isn't measured.
+    memset(&lcd, 0, sizeof(lcd));
+    sim_attach(&boot_dev);
+    vpcd8544_attach(&lcd, 1 << 1, 1 << 2, 1 << 4, 1 << 5, 1 << 6);
+    ok &= bench_run("lcddemo/boot", sim_app_main, 0.1, 0);
+    sim_detach(&lcd.dev);
+    sim_detach(&boot_dev);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,343 @@
+// lcdtemp and lib benchmarks on a virtual HD44780, see ../bench.h.
+//
+//     ./bench_lcdtemp
+//
+// hd44780_string: lcd_goto() and 16 characters, checked on the glass.
+// lcd_disp_digit: one big digit.
+// adc_round: one lcdtemp round, 16 temperature and 4 VCC scans.
+// temperature: tempsensor_convert() of the round's reading, error_c from
+// the simulated die temperature. The conversion is computation only, so
+// the case charges CONVERT_CYCLES for it: us and cycles are an estimate
+// (bench_estimate()), not gated.
+// boot: lcdtemp from reset until the first reading is on the display,
+// the E pulse that puts the V after VCC there.
+// delay_us_*: delay_us(1, 10, 100, 1000) at each clock, max_error_us
+// from the time asked for.
+// delay_clock_switch: one run through 1, 8 and 16 Mhz with clock_set(),
+// delay_us(25, 100, 1000) and delay_ms(1, 10) at each. us_error_us and
+// ms_error_us are the worst over them; errors counts delays outside
+// delay.h's bounds (3 cycles plus 4 per doubling for delay_us, 10 plus 6
+// a ms for delay_ms) and clocks that didn't switch.
+// tempsensor_cal_*mv: tempsensor_convert() with the TLV calibration of a
+// sensor that many mV off the typical curve, swept from -40 C over each
+// reference's range in 5 C steps. errors counts readings more than
+// SENSOR_ERROR_C off and a missed calibration.
+// tempsensor_nocal_*mv: the same without the ADC10 calibration in the
+// TLV, so on the typical curve: the readings are off by the offset's
+// 1 / 3.55 mV per C, errors counts the ones more than SENSOR_ERROR_C off
+// that and a calibration found anyway. Readings that would be outside
+// the range are left out.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <msp430.h>
+#include <intrinsics.h>
+
+#include "../bench.h"
+#include "../sim.h"
+#include "../vhd44780.h"
+#include "adcscan.h"
+#include "clock.h"
+#include "delay.h"
+#include "hd44780.h"
+#include "tempsensor.h"
+
+#define TEXT "Benchmark 0123 C"
+
+// tempsensor_convert() counted by hand for mspgcc -Os code with SLAU144's
+// cycle table, an estimate that doesn't follow tempsensor.c. Through the
+// interpolation with all 5 fraction bits set, the longest path: call
+// (5), push r11 (3), base loaded and compared (6), code -= base (1), i =
+// code >> 5 (11), i checked (4), frac (2), step (7), sum and bit (3), 5
+// rounds of the shift and add (45), rounding, the shift back and
+// table[i] (11), pop and ret (5).
+#define CONVERT_CYCLES 103
+
+#define SENSOR_ERROR_C 1.0
+
+// From lcdtemp.c.
+void lcd_set_fonts(void);
+void lcd_disp_digit(unsigned char digit);
+
+// As in lcdtemp.c.
+static const adcscan_channel channels[] = {{10, 4}, {11, 2}};
+// One temperature scan.
+static const adcscan_channel sensor[] = {{10, 0}};
+
+static vhd44780 lcd;
+static unsigned char delay_mhz_asked;
+static int booted;
+
+static unsigned long bytes(void)
+{
+    return lcd.instructions + lcd.data_writes;
+}
+
+// Firmware globals outlive a run, the clock listener only goes in once.
+static void init(unsigned char mhz)
+{
+    static unsigned char listening;
+
+    WDTCTL = WDTPW | WDTHOLD;
+    if(!listening)
+        listening = clock_listen(delay_clock);
+    clock_set(mhz);
+}
+
+static int string_app(void)
+{
+    unsigned int i;
+
+    init(CLOCK_1MHZ);
+    lcd_initialize();
+    bench_begin(bytes());
+    lcd_goto(0x40);
+    LCD_SET_DATA();
+    for(i = 0; i < sizeof(TEXT) - 1; ++i)
+        lcd_send_data(TEXT[i]);
+    bench_end(bytes());
+    return 0;
+}
+
+static void string_done(void)
+{
+    bench_set("errors", memcmp(lcd.ddram + 0x40, TEXT, sizeof(TEXT) - 1) != 0);
+}
+
+static int digit_app(void)
+{
+    init(CLOCK_1MHZ);
+    lcd_initialize();
+    lcd_set_fonts();
+    bench_begin(bytes());
+    lcd_disp_digit((0x4 << 4) | 8);
+    bench_end(bytes());
+    return 0;
+}
+
+// One round, from adcscan_start() until it is done.
+static void adc_round(void)
+{
+    adcscan_start();
+    __dint();
+    while(!adcscan_done())
+    {
+        __bis_status_register(LPM0_bits | GIE);
+        __dint();
+    }
+    __eint();
+}
+
+static void adc_init(void)
+{
+    init(CLOCK_1MHZ);
+    adcscan_init(channels, 2, SREF0 | REFON | REF2_5V | ADC10SHT_3);
+    delay_ms(1);
+    tempsensor_init(TEMPSENSOR_C | TEMPSENSOR_2_5V);
+    __eint();
+}
+
+static int adc_round_app(void)
+{
+    adc_init();
+    bench_begin(0);
+    adc_round();
+    bench_end(0);
+    return 0;
+}
+
+static int temperature_app(void)
+{
+    int t;
+
+    adc_init();
+    adc_round();
+    bench_begin(0);
+    sim_cycles(CONVERT_CYCLES);
+    t = tempsensor_convert(adcscan_result(0));
+    bench_end(0);
+    bench_estimate();
+    bench_set("error_c", t / 10.0 - sim_temp_c);
+    return 0;
+}
+
+// Readings from -40 C to top_c, against the die temperature plus shift_c.
+// Those that would be outside that are clamped, and left out. Returns
+// the errors, keeps the worst in *worst.
+static unsigned int sweep(unsigned int ref, double top_c, double shift_c,
+                          double *worst)
+{
+    unsigned int errors = 0;
+    double t;
+
+    adcscan_init(sensor, 1, SREF0 | REFON | ref | ADC10SHT_3);
+    delay_ms(1);
+    errors += tempsensor_init(TEMPSENSOR_C | (ref ? TEMPSENSOR_2_5V : 0)) !=
+              sim_tlv_adc;
+    for(t = -40; t <= top_c; t += 5)
+    {
+        if(t + shift_c < -40 || t + shift_c > top_c)
+            continue;
+        sim_temp_c = t;
+        adc_round();
+        double e = tempsensor_convert(adcscan_result(0)) / 10.0 - t - shift_c;
+        e = e < 0 ? -e : e;
+        *worst = e > *worst ? e : *worst;
+        errors += e > SENSOR_ERROR_C;
+    }
+    return errors;
+}
+
+static int sensor_app(void)
+{
+    // Calibrated readings have no offset left, the typical curve all of
+    // it: 3.55 mV per C.
+    double shift_c = sim_tlv_adc ? 0 : sim_temp_offset / 0.00355;
+    double worst = 0;
+    unsigned int errors;
+
+    init(CLOCK_1MHZ);
+    __eint();
+    // tempsensor.h's range for each reference.
+    errors = sweep(0, 75, shift_c, &worst);
+    errors += sweep(REF2_5V, 155, shift_c, &worst);
+    sim_temp_c = 25;
+    bench_set("max_error_c", (long)(worst * 100 + 0.5) / 100.0);
+    bench_set("errors", errors);
+    return 0;
+}
+
+static int delay_app(void)
+{
+    static const unsigned int n[] = {1, 10, 100, 1000};
+    double error = 0;
+    unsigned int i;
+
+    init(delay_mhz_asked);
+    bench_begin(0);
+    for(i = 0; i < sizeof(n) / sizeof(n[0]); ++i)
+    {
+        double t = sim_time_us();
+        delay_us(n[i]);
+        t = sim_time_us() - t - n[i];
+        if(t > error || -t > error)
+            error = t < 0 ? -t : t;
+    }
+    bench_end(0);
+    // To the ns, the times are sums of picoseconds.
+    bench_set("max_error_us", (long)(error * 1000 + 0.5) / 1000.0);
+    return 0;
+}
+
+// How far the delay of n was off from want_us, kept in *worst. Returns 1
+// if it is short or more than slack cycles long.
+static unsigned int delay_error(void (*delay)(unsigned int), unsigned int n,
+                                double want_us, unsigned long slack,
+                                double *worst)
+{
+    double t = sim_time_us();
+    double mhz = sim_mclk_hz() / 1e6;
+
+    delay(n);
+    t = sim_time_us() - t - want_us;
+    // To the ns, the times are sums of picoseconds.
+    t = (long)(t * 1000 + (t < 0 ? -0.5 : 0.5)) / 1000.0;
+    *worst = t > *worst ? t : -t > *worst ? -t : *worst;
+    return t < 0 || t * mhz > slack;
+}
+
+static int delay_switch_app(void)
+{
+    static const unsigned char mhz[] = {CLOCK_1MHZ, CLOCK_8MHZ, CLOCK_16MHZ};
+    static const unsigned int us[] = {25, 100, 1000};
+    static const unsigned int ms[] = {1, 10};
+    double us_error = 0;
+    double ms_error = 0;
+    unsigned int errors = 0;
+    unsigned int i, j;
+
+    init(CLOCK_1MHZ);
+    bench_begin(0);
+    for(i = 0; i < sizeof(mhz); ++i)
+    {
+        unsigned char shift = i ? (mhz[i] == 8 ? 3 : 4) : 0;
+
+        clock_set(mhz[i]);
+        errors += sim_mclk_hz() < mhz[i] * 0.98e6 ||
+                  sim_mclk_hz() > mhz[i] * 1.02e6;
+        for(j = 0; j < sizeof(us) / sizeof(us[0]); ++j)
+            errors += delay_error(delay_us, us[j], us[j], 3 + 4 * shift,
+                                  &us_error);
+        for(j = 0; j < sizeof(ms) / sizeof(ms[0]); ++j)
+            errors += delay_error(delay_ms, ms[j], 1000.0 * ms[j],
+                                  10 + 6 * ms[j], &ms_error);
+    }
+    bench_end(0);
+    bench_set("us_error_us", us_error);
+    bench_set("ms_error_us", ms_error);
+    bench_set("errors", errors);
+    return 0;
+}
+
+// Runs a case on a display fresh from power on.
+static int run(const char *name, int (*app)(void), void (*done)(void))
+{
+    memset(&lcd, 0, sizeof(lcd));
+    vhd44780_attach(&lcd, 1 << 5, 1 << 4, 0x0f);
+    int ok = bench_run(name, app, 1, done);
+    sim_detach(&lcd.dev);
+    return ok;
+}
+
+// Called after lcd (attached before it), so the write is seen.
+static void boot_e(sim_device *dev, unsigned char old, unsigned char now)
+{
+    (void)dev;
+    if((old & ~now & (1 << 4)) && lcd.ddram[0x0f] == 'V' && !booted)
+    {
+        booted = 1;
+        bench_begin_at(0, 0);
+        bench_end(bytes());
+    }
+}
+
+static sim_device boot_dev = {"boot", boot_e, 0};
+
+int sim_app_main(void);
+
+int main(void)
+{
+    static const unsigned char mhz[] = {1, 8, 16};
+    static const int offsets_mv[] = {-20, 0, 20};
+    char name[32];
+    unsigned int i;
+    int ok = 1;
+
+    ok &= run("lcdtemp/hd44780_string", string_app, string_done);
+    ok &= run("lcdtemp/lcd_disp_digit", digit_app, 0);
+    ok &= run("lcdtemp/adc_round", adc_round_app, 0);
+    ok &= run("lcdtemp/temperature", temperature_app, 0);
+    sim_attach(&boot_dev);
+    ok &= run("lcdtemp/boot", sim_app_main, 0);
+    sim_detach(&boot_dev);
+    for(i = 0; i < sizeof(mhz); ++i)
+    {
+        delay_mhz_asked = mhz[i];
+        snprintf(name, sizeof(name), "lib/delay_us_%umhz", mhz[i]);
+        ok &= run(name, delay_app, 0);
+    }
+    ok &= run("lib/delay_clock_switch", delay_switch_app, 0);
+    // The calibration, and the typical curve without it, at each offset.
+    for(sim_tlv_adc = 1; sim_tlv_adc >= 0; --sim_tlv_adc)
+        for(i = 0; i < sizeof(offsets_mv) / sizeof(offsets_mv[0]); ++i)
+        {
+            sim_temp_offset = offsets_mv[i] / 1e3;
+            snprintf(name, sizeof(name), "lib/tempsensor_%s_%dmv",
+                     sim_tlv_adc ? "cal" : "nocal", offsets_mv[i]);
+            ok &= bench_check(name, sensor_app, 1, 0);
+        }
+    sim_tlv_adc = 1;
+    sim_temp_offset = 0;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+// multiapp benchmarks on a virtual HD44780, see ../bench.h.
+//
+//     ./bench_multiapp
+//
+// boot: multiapp from reset until the first temperature and VCC are on
+// the display, the E pulse that puts the V after VCC there.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../bench.h"
+#include "../sim.h"
+#include "../vhd44780.h"
+
+#define LCD_E (1 << 4)
+
+int sim_app_main(void);
+
+static vhd44780 lcd;
+static int booted;
+
+static unsigned long bytes(void)
+{
+    return lcd.instructions + lcd.data_writes;
+}
+
+// Called after lcd (attached before it), so the write is seen.
+static void boot_e(sim_device *dev, unsigned char old, unsigned char now)
+{
+    (void)dev;
+    if((old & ~now & LCD_E) && lcd.ddram[0x4f] == 'V' && !booted)
+    {
+        booted = 1;
+        bench_begin_at(0, 0);
+        bench_end(bytes());
+    }
+}
+
+static sim_device boot_dev = {"boot", boot_e, 0};
+
+int main(void)
+{
+    int ok = 1;
+
+    sim_attach(&boot_dev);
+    vhd44780_attach(&lcd, 1 << 5, LCD_E, 0x0f);
+    // Button and IR receiver idle high.
+    sim_drive((1 << 3) | (1 << 7), (1 << 3) | (1 << 7));
+    ok &= bench_run("multiapp/boot", sim_app_main, 1, 0);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// remote benchmark, see ../bench.h.
+//
+//     ./bench_remote
+//
+// ir_to_uart: from the first edge of an NEC frame on the IR receiver to
+// the last edge of the capture on the UART, bus_bytes the UART bytes.
+// first_byte_us is the time to the first start bit.
+
+#include <stdio.h>
+
+#include "../bench.h"
+#include "../sim.h"
+#include "../vuart.h"
+
+#define UART_TX   (1 << 1)
+#define BUTTON    (1 << 3)
+#define IR_SENSOR (1 << 4)
+
+#define FRAME_US 100e3
+
+int sim_app_main(void);
+
+static vuart uart;
+
+static void ir_low(void *arg)
+{
+    static int first = 1;
+    (void)arg;
+
+    if(first)
+    {
+        bench_begin(0);
+        first = 0;
+    }
+    sim_drive(IR_SENSOR, 0);
+}
+
+static void ir_high(void *arg)
+{
+    (void)arg;
+    sim_drive(IR_SENSOR, IR_SENSOR);
+}
+
+// As in remote.c.
+static void nec_frame(double t, unsigned long code)
+{
+    int i;
+    sim_at(t, ir_low, 0);
+    sim_at(t += 9000, ir_high, 0);
+    t += 4500;
+    for(i = 0; i < 32; ++i)
+    {
+        sim_at(t, ir_low, 0);
+        sim_at(t += 560, ir_high, 0);
+        t += (code >> i) & 1 ? 1690 : 560;
+    }
+    sim_at(t, ir_low, 0);
+    sim_at(t + 560, ir_high, 0);
+}
+
+// Called after uart (attached before it), so the byte being received is
+// counted.
+static void tx(sim_device *dev, unsigned char old, unsigned char now)
+{
+    static int first = 1;
+    double t = sim_time_us();
+    (void)dev;
+
+    if(!((old ^ now) & UART_TX) || t < FRAME_US)
+        return;
+    if(first)
+    {
+        bench_set("first_byte_us", t - FRAME_US);
+        first = 0;
+    }
+    bench_end(uart.len + uart.in_frame);
+}
+
+static sim_device tx_dev = {"tx", tx, 0};
+
+int main(void)
+{
+    int ok = 1;
+
+    sim_attach(&tx_dev);
+    vuart_attach(&uart, UART_TX, 9600);
+    sim_drive(IR_SENSOR | BUTTON, IR_SENSOR | BUTTON);
+    nec_frame(FRAME_US, 0xbf40ff00);
+    ok &= bench_run("remote/ir_to_uart", sim_app_main, 0.4, 0);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+// gpio_bench (either build) on a virtual HD44780, pressing the button
+// every 200 ms. Both builds must show the same digits.
+//
+//     ./gpio_macro [seconds]
+//     ./gpio_template [seconds]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../sim.h"
+#include "../vhd44780.h"
+
+#define BUTTON (1 << 3)
+
+int sim_app_main(void);
+
+static vhd44780 lcd;
+
+static void press(void *arg)
+{
+    (void)arg;
+    sim_drive(BUTTON, 0);
+}
+
+static void release(void *arg)
+{
+    (void)arg;
+    sim_release(BUTTON);
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 2;
+    double t;
+
+    vhd44780_attach(&lcd, 1 << 5, 1 << 4, 0x0f);
+    for(t = 200e3; t < seconds * 1e6; t += 200e3)
+    {
+        sim_at(t, press, 0);
+        sim_at(t + 50e3, release, 0);
+    }
+
+    int violations = sim_run(sim_app_main, seconds);
+
+    vhd44780_print(&lcd, stdout);
+    vhd44780_stats(&lcd, stdout);
+    return violations ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+// interrupt_blink (or hello, built from this too), printing when the led
+// changes.
+//
+//     ./interrupt_blink [-f vlo_hz] [seconds]
+//
+// The VLO runs at vlo_hz (VLO_HZ by default, slow on purpose). At every
+// toggle after the first the time systick_us() has counted since then is
+// compared with the simulated time, and has to be within MAX_DRIFT_PPM.
+// Toggles only come on ticks: how far each is from a multiple of BLINK_US
+// after the first may only spread over a tick, give or take MAX_DRIFT_PPM
+// of the run.
+// The average supply current over the run is printed (see energy.h).
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../energy.h"
+#include "../sim.h"
+// SYSTICK_CYCLES, built with the projects' flags.
+#include <msp430.h>
+#include "systick.h"
+
+#define LED (1 << 6)
+#define VLO_HZ 9400
+#define MAX_DRIFT_PPM 200
+#define BLINK_US 500000
+
+int sim_app_main(void);
+
+static unsigned int toggles;
+static double first_us;
+static unsigned long first_tick_us;
+static double drift_ppm;
+// Toggle times less the multiples of BLINK_US since the first.
+static double off_min_us;
+static double off_max_us;
+
+static void led(sim_device *dev, unsigned char old, unsigned char now)
+{
+    static double last_us;
+    double t = sim_time_us();
+    (void)dev;
+
+    if(!((old ^ now) & LED))
+        return;
+    printf("%10.3f ms led %s (+%.3f ms)\n", t / 1000,
+           (now & LED) ? "on " : "off", (t - last_us) / 1000);
+    last_us = t;
+
+    // Toggles come straight after a tick, so both clocks are read at the
+    // same point of one.
+    if(!toggles++)
+    {
+        first_us = t;
+        first_tick_us = systick_us();
+        return;
+    }
+    drift_ppm = ((double)(systick_us() - first_tick_us) - (t - first_us)) /
+                (t - first_us) * 1e6;
+
+    double off = t - first_us - (toggles - 1) * (double)BLINK_US;
+    off_min_us = off < off_min_us ? off : off_min_us;
+    off_max_us = off > off_max_us ? off : off_max_us;
+}
+
+static sim_device led_dev = {"led", led, 0};
+
+int main(int argc, char **argv)
+{
+    double seconds = 10;
+    int violations;
+    int c;
+
+    sim_vlo_hz = VLO_HZ;
+    while((c = getopt(argc, argv, "f:")) != -1)
+    {
+        switch(c)
+        {
+        case 'f':
+            sim_vlo_hz = atof(optarg);
+            break;
+        default:
+            return 2;
+        }
+    }
+    if(optind < argc)
+        seconds = atof(argv[optind]);
+
+    sim_attach(&led_dev);
+    violations = sim_run(sim_app_main, seconds);
+
+    double spread = off_max_us - off_min_us;
+    double tick_us = SYSTICK_CYCLES * 1e6 / sim_vlo_hz;
+    printf("VLO %.0f Hz, tick %lu us (%.0f us), drift %.0f ppm over %u "
+           "toggles spread over %.3f ms, average %.3f uA\n", sim_vlo_hz,
+           systick_tick_us(), tick_us, drift_ppm, toggles,
+           spread / 1000, energy_average_ua());
+    return violations || toggles < 2 || fabs(drift_ppm) > MAX_DRIFT_PPM ||
+           spread > tick_us + seconds * MAX_DRIFT_PPM ? 1 : 0;
+}
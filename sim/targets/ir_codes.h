@@ -0,0 +1,19 @@
+// NEC codes for the remote_send build, in the format ir_analyze.py
+// --header writes. Written by hand: an NEC frame is longer than the
+// 16 ms remote captures.
+#ifndef IR_CODES_H_
+#define IR_CODES_H_
+
+// Pulse distance coding, times in us. Bit 0 is received first.
+#define IR_LEADER_MARK   9000
+#define IR_LEADER_SPACE  4500
+#define IR_MARK          560
+#define IR_SPACE_0       560
+#define IR_SPACE_1       1690
+#define IR_BITS          32
+// irtx_protocol for irtx_send(), see lib/irtx.h.
+#define IR_PROTOCOL      {9000, 4500, 560, 560, 560, 1690}
+
+#define IR_POWER         0xbf40ff00UL
+
+#endif
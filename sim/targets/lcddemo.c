@@ -0,0 +1,50 @@
+// lcddemo on a virtual PCD8544, with the button pressed now and then.
+//
+//     ./lcddemo [seconds] [image.pbm]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../sim.h"
+#include "../vpcd8544.h"
+
+#define BUTTON (1 << 3)
+
+int sim_app_main(void);
+
+static vpcd8544 lcd;
+
+static void press(void *arg)
+{
+    (void)arg;
+    sim_drive(BUTTON, 0);
+}
+
+static void release(void *arg)
+{
+    (void)arg;
+    sim_release(BUTTON);
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 3;
+    double t;
+
+    vpcd8544_attach(&lcd, 1 << 1, 1 << 2, 1 << 4, 1 << 5, 1 << 6);
+
+    // Jump every 700 ms, held for 50 ms.
+    for(t = 500e3; t < seconds * 1e6 && t < 100e6; t += 700e3)
+    {
+        sim_at(t, press, 0);
+        sim_at(t + 50e3, release, 0);
+    }
+
+    int violations = sim_run(sim_app_main, seconds);
+
+    vpcd8544_print(&lcd, stdout);
+    vpcd8544_stats(&lcd, stdout);
+    if(argc > 2 && !vpcd8544_save_pbm(&lcd, argv[2]))
+        perror(argv[2]);
+    return violations ? 1 : 0;
+}
@@ -0,0 +1,57 @@
+// lcdtemp on a virtual HD44780.
+//
+//     ./lcdtemp [-t C] [-o mV] [-v volts] [-n] [seconds]
+//
+// -t is the die temperature, -o this chip's sensor error from the typical
+// curve, -v the supply voltage. -n leaves the factory calibration out of
+// the TLV.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../sim.h"
+#include "../vhd44780.h"
+
+int sim_app_main(void);
+
+static vhd44780 lcd;
+
+int main(int argc, char **argv)
+{
+    double seconds = 2;
+    int c;
+
+    while((c = getopt(argc, argv, "t:o:v:n")) != -1)
+    {
+        switch(c)
+        {
+        case 't':
+            sim_temp_c = atof(optarg);
+            break;
+        case 'o':
+            sim_temp_offset = atof(optarg) / 1000;
+            break;
+        case 'v':
+            sim_vcc = atof(optarg);
+            break;
+        case 'n':
+            sim_tlv_adc = 0;
+            break;
+        default:
+            return 2;
+        }
+    }
+    if(optind < argc)
+        seconds = atof(argv[optind]);
+
+    vhd44780_attach(&lcd, 1 << 5, 1 << 4, 0x0f);
+
+    int violations = sim_run(sim_app_main, seconds);
+
+    printf("%.1f C (%.1f F), %.2f V\n", sim_temp_c, sim_temp_c * 9 / 5 + 32,
+           sim_vcc);
+    vhd44780_print(&lcd, stdout);
+    vhd44780_stats(&lcd, stdout);
+    return violations ? 1 : 0;
+}
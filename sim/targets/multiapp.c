@@ -0,0 +1,200 @@
+// multiapp on a virtual HD44780, IR receiver and serial port.
+//
+//     ./multiapp [-t C] [-v volts] [seconds]
+//
+// PRESSES button presses while two IR frames come in: a short one while
+// the button is down, then an NEC one. At the end the first line has to
+// show the presses and the second the temperature and VCC. Both frames
+// have to come out of the UART with the marks they cover within
+// TOLERANCE_US of the ones sent, the NEC one with its 9 ms leader whole.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../sim.h"
+#include "../vhd44780.h"
+#include "../vuart.h"
+
+#define BUTTON    (1 << 3)
+#define UART_TX   (1 << 6)
+#define IR_SENSOR (1 << 7)
+
+#define PRESSES 5
+#define FRAMES  2
+#define TOLERANCE_US 40
+#define HEADER_BYTES 3
+#define MAX_MARKS 34
+
+int sim_app_main(void);
+
+static vhd44780 lcd;
+static vuart uart;
+
+// Marks sent, from the first one's start.
+static double sent_start[FRAMES][MAX_MARKS];
+static double sent_end[FRAMES][MAX_MARKS];
+static unsigned int sent_marks[FRAMES];
+// Whole marks each capture has to show: all of the short frame, the NEC
+// leader and the first bit's mark.
+static const unsigned int min_marks[FRAMES] = {10, 2};
+
+static void drive_low(void *arg)
+{
+    sim_drive(*(unsigned char *)arg, 0);
+}
+
+static void drive_high(void *arg)
+{
+    sim_drive(*(unsigned char *)arg, *(unsigned char *)arg);
+}
+
+static void ir_mark(unsigned int f, double t, double t0, double us)
+{
+    static unsigned char ir = IR_SENSOR;
+    unsigned int n = sent_marks[f]++;
+
+    sim_at(t, drive_low, &ir);
+    sim_at(t + us, drive_high, &ir);
+    sent_start[f][n] = t - t0;
+    sent_end[f][n] = t + us - t0;
+}
+
+// 2 ms mark, 1 ms space, 8 bits of 250 us mark and 250 us or 500 us
+// space, final mark. Captured whole, it ends on 5 ms of space.
+static void short_frame(unsigned int f, double t, unsigned char code)
+{
+    double t0 = t;
+    int i;
+
+    ir_mark(f, t, t0, 2000);
+    t += 3000;
+    for(i = 0; i < 8; ++i)
+    {
+        ir_mark(f, t, t0, 250);
+        t += 250 + ((code >> i) & 1 ? 500 : 250);
+    }
+    ir_mark(f, t, t0, 250);
+}
+
+// 9 ms leader mark, 4.5 ms space, 32 bits of 562.5 us mark and 562.5 us
+// or 1687.5 us space, final mark. Longer than the capture, which ends
+// after 15.2 ms.
+static void nec_frame(unsigned int f, double t, unsigned long code)
+{
+    double t0 = t;
+    int i;
+
+    ir_mark(f, t, t0, 9000);
+    t += 13500;
+    for(i = 0; i < 32; ++i)
+    {
+        ir_mark(f, t, t0, 562.5);
+        t += 562.5 + ((code >> i) & 1 ? 1687.5 : 562.5);
+    }
+    ir_mark(f, t, t0, 562.5);
+}
+
+// Compares the marks in the n-th frame on the UART with the ones sent.
+// The last one captured can be cut off.
+static int check_frame(unsigned int f)
+{
+    unsigned int at = 0;
+    unsigned int bytes = 0;
+    unsigned int n;
+    unsigned int i;
+    unsigned int marks = 0;
+    unsigned int start = 0;
+    unsigned int first = 0;
+    double error = 0;
+
+    for(n = 0; n <= f; ++n, at += HEADER_BYTES + bytes)
+    {
+        if(at + HEADER_BYTES > uart.len || uart.buf[at] != 0x21)
+        {
+            printf("capture %u: no frame\n", f);
+            return 0;
+        }
+        bytes = uart.buf[at + 1];
+    }
+    at -= HEADER_BYTES + bytes;
+    n = bytes * 8;
+
+    for(i = 0; i < n; ++i)
+    {
+        unsigned int bit = uart.buf[at + HEADER_BYTES + i / 8] >> (i % 8) & 1;
+        unsigned int was = i ? uart.buf[at + HEADER_BYTES + (i - 1) / 8] >>
+                               ((i - 1) % 8) & 1 : 1;
+        if(bit == was)
+            continue;
+        if(!bit)
+        {
+            start = i;
+            if(!marks)
+                first = i;
+            continue;
+        }
+        if(marks < sent_marks[f])
+        {
+            double s = (start - first) * 10.0;
+            double e = (i - first) * 10.0;
+            if(fabs(sent_start[f][marks] - s) > error)
+                error = fabs(sent_start[f][marks] - s);
+            if(fabs(sent_end[f][marks] - e) > error)
+                error = fabs(sent_end[f][marks] - e);
+        }
+        marks++;
+    }
+    printf("capture %u: %u samples, %u whole marks, edges within %.0f us\n",
+           f, n, marks, error);
+    return marks >= min_marks[f] && marks <= sent_marks[f] && error <= TOLERANCE_US;
+}
+
+int main(int argc, char **argv)
+{
+    static unsigned char button = BUTTON;
+    double seconds = 2;
+    int ok = 1;
+    int c;
+    int i;
+
+    while((c = getopt(argc, argv, "t:v:")) != -1)
+    {
+        switch(c)
+        {
+        case 't':
+            sim_temp_c = atof(optarg);
+            break;
+        case 'v':
+            sim_vcc = atof(optarg);
+            break;
+        default:
+            return 2;
+        }
+    }
+    if(optind < argc)
+        seconds = atof(argv[optind]);
+
+    vhd44780_attach(&lcd, 1 << 5, 1 << 4, 0x0f);
+    vuart_attach(&uart, UART_TX, 9600);
+    sim_drive(BUTTON | IR_SENSOR, BUTTON | IR_SENSOR);
+    for(i = 0; i < PRESSES; ++i)
+    {
+        sim_at(300e3 + i * 150e3, drive_low, &button);
+        sim_at(360e3 + i * 150e3, drive_high, &button);
+    }
+    short_frame(0, 610e3, 0xa5);
+    nec_frame(1, 1300e3, 0x00ff10efUL);
+
+    int violations = sim_run(sim_app_main, seconds);
+    vuart_flush(&uart);
+
+    vhd44780_print(&lcd, stdout);
+    printf("%u UART bytes\n", uart.len);
+    ok &= atoi((const char *)lcd.ddram) == PRESSES;
+    ok &= lcd.ddram[0x43] == 'F' && lcd.ddram[0x4f] == 'V';
+    for(i = 0; i < FRAMES; ++i)
+        ok &= check_frame(i);
+    return violations || !ok ? 1 : 0;
+}
@@ -0,0 +1,269 @@
+// remote capturing an NEC frame from the IR receiver and sending it over
+// the software UART, then sending IR when the button is pressed, then
+// capturing a short frame that ends on the idle timeout.
+//
+//     ./remote [raw output file]
+//     ./remote_send
+//
+// The raw output can be read by show_samples.py in place of the serial
+// port. The leading mark of the NEC capture has to be within
+// TOLERANCE_US of the 9 ms sent. remote replays the capture, and the
+// demodulated IR has to match it. remote_send is built with IR_CODE
+// (targets/ir_codes.h) and the IR has to decode back to that NEC code.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../sim.h"
+#include "../virrx.h"
+#include "../vuart.h"
+
+#ifdef IR_CODE
+#include "ir_codes.h"
+#endif
+
+#define UART_TX   (1 << 1)
+#define BUTTON    (1 << 3)
+#define IR_SENSOR (1 << 4)
+#define IR_LED    (1 << 6)
+
+// Captured and replayed edges within this of the ones sent.
+#define TOLERANCE_US 40
+// Frame header: 0x21, sample bytes, pre-trigger bytes.
+#define HEADER_BYTES 3
+#define MAX_SAMPLES (8 * 255)
+
+int sim_app_main(void);
+
+static vuart uart;
+static virrx ir;
+
+static void ir_low(void *arg)
+{
+    (void)arg;
+    sim_drive(IR_SENSOR, 0);
+}
+
+static void ir_high(void *arg)
+{
+    (void)arg;
+    sim_drive(IR_SENSOR, IR_SENSOR);
+}
+
+// Receiver output is active low: 9 ms mark, 4.5 ms space, 32 bits of
+// 560 us mark and 560 us (0) or 1690 us (1) space, final mark.
+static void nec_frame(double t, unsigned long code)
+{
+    int i;
+    sim_at(t, ir_low, 0);
+    sim_at(t += 9000, ir_high, 0);
+    t += 4500;
+    for(i = 0; i < 32; ++i)
+    {
+        sim_at(t, ir_low, 0);
+        sim_at(t += 560, ir_high, 0);
+        t += (code >> i) & 1 ? 1690 : 560;
+    }
+    sim_at(t, ir_low, 0);
+    sim_at(t + 560, ir_high, 0);
+}
+
+// 2 ms mark, 1 ms space, 8 bits of 250 us mark and 250 us or 500 us
+// space, final mark. With the idle timeout the capture is shorter than
+// sample[].
+static void short_frame(double t, unsigned char code)
+{
+    int i;
+    sim_at(t, ir_low, 0);
+    sim_at(t += 2000, ir_high, 0);
+    t += 1000;
+    for(i = 0; i < 8; ++i)
+    {
+        sim_at(t, ir_low, 0);
+        sim_at(t += 250, ir_high, 0);
+        t += (code >> i) & 1 ? 500 : 250;
+    }
+    sim_at(t, ir_low, 0);
+    sim_at(t + 250, ir_high, 0);
+}
+
+// Samples of the n-th frame the UART received, 1 for space. Returns the
+// number of samples, 0 if there is no such frame.
+static unsigned int frame(unsigned int n, unsigned char *level,
+                          unsigned int *pre)
+{
+    unsigned int at = 0;
+    unsigned int i;
+
+    while(at + HEADER_BYTES <= uart.len && uart.buf[at] == 0x21)
+    {
+        unsigned int bytes = uart.buf[at + 1];
+        if(at + HEADER_BYTES + bytes > uart.len)
+            break;
+        if(!n--)
+        {
+            for(i = 0; i < bytes * 8; ++i)
+                level[i] = uart.buf[at + HEADER_BYTES + i / 8] >> (i % 8) & 1;
+            *pre = uart.buf[at + 2] * 8;
+            return bytes * 8;
+        }
+        at += HEADER_BYTES + bytes;
+    }
+    return 0;
+}
+
+static int check_capture(void)
+{
+    unsigned char level[MAX_SAMPLES];
+    unsigned int pre;
+    unsigned int n = frame(0, level, &pre);
+    unsigned int start;
+    unsigned int end;
+    int ok = 1;
+
+    for(start = 0; start < n && level[start]; ++start)
+        ;
+    for(end = start; end < n && !level[end]; ++end)
+        ;
+    if(end == n)
+    {
+        printf("capture: no leading mark\n");
+        return 0;
+    }
+    printf("capture: leading mark %u us of 9000, starts at sample %u, "
+           "%u pre-trigger\n", (end - start) * 10, start, pre);
+    ok = abs((int)(end - start) * 10 - 9000) <= TOLERANCE_US;
+
+    n = frame(1, level, &pre);
+    printf("capture: short frame %u samples\n", n);
+    return ok && n && n < 1520;
+}
+
+static void press(void *arg)
+{
+    (void)arg;
+    sim_drive(BUTTON, 0);
+}
+
+static void release(void *arg)
+{
+    (void)arg;
+    sim_drive(BUTTON, BUTTON);
+}
+
+#ifdef IR_CODE
+// Decodes the marks as an NEC frame. Returns 0 if they aren't one.
+static int nec_decode(unsigned long *code)
+{
+    unsigned int i;
+
+    if(ir.marks != 34 || fabs(ir.end[0] - ir.start[0] - 9000) > 500)
+        return 0;
+    *code = 0;
+    for(i = 0; i < 32; ++i)
+    {
+        double space = ir.start[i + 2] - ir.end[i + 1];
+        if(space > 1125)
+            *code |= 1UL << i;
+    }
+    return 1;
+}
+
+static int check_ir(void)
+{
+    unsigned long code;
+
+    if(!nec_decode(&code))
+    {
+        printf("ir: %u marks, not an NEC frame\n", ir.marks);
+        return 0;
+    }
+    printf("ir: sent 0x%08lx, decoded 0x%08lx\n",
+           (unsigned long)IR_CODE, code);
+    return code == IR_CODE;
+}
+#else
+// Compares the replayed marks with the ones in the capture sent over the
+// UART, relative to the first mark.
+static int check_ir(void)
+{
+    unsigned char level[MAX_SAMPLES];
+    unsigned int pre;
+    unsigned int n = frame(0, level, &pre);
+    unsigned int i;
+    unsigned int marks = 0;
+    unsigned int start = 0;
+    unsigned int first = 0;
+    double error = 0;
+
+    if(!n || !ir.marks)
+    {
+        printf("ir: nothing to compare\n");
+        return 0;
+    }
+    for(i = 0; i <= n; ++i)
+    {
+        unsigned int bit = i < n ? level[i] : 1;
+        unsigned int was = i ? level[i - 1] : 1;
+        if(bit == was)
+            continue;
+        if(!bit)
+        {
+            start = i;
+            if(!marks)
+                first = i;
+            continue;
+        }
+        if(marks < ir.marks)
+        {
+            double s = (start - first) * 10.0;
+            double e = (i - first) * 10.0;
+            if(fabs(ir.start[marks] - ir.start[0] - s) > error)
+                error = fabs(ir.start[marks] - ir.start[0] - s);
+            if(fabs(ir.end[marks] - ir.start[0] - e) > error)
+                error = fabs(ir.end[marks] - ir.start[0] - e);
+        }
+        marks++;
+    }
+    printf("ir: %u marks captured, %u replayed, edges within %.0f us\n",
+           marks, ir.marks, error);
+    return marks == ir.marks && error <= TOLERANCE_US;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    unsigned int i;
+
+    vuart_attach(&uart, UART_TX, 9600);
+    virrx_attach(&ir, IR_LED);
+    sim_drive(IR_SENSOR | BUTTON, IR_SENSOR | BUTTON);
+    nec_frame(100e3, 0xbf40ff00);
+    // After the capture is sent.
+    sim_at(400e3, press, 0);
+    sim_at(450e3, release, 0);
+    // After remote_send's NEC frame and the button settling time.
+    short_frame(600e3, 0xa5);
+
+    int violations = sim_run(sim_app_main, 0.9);
+    vuart_flush(&uart);
+    virrx_flush(&ir);
+
+    printf("%u bytes\n", uart.len);
+    for(i = 0; i < uart.len; ++i)
+        printf("%02x%c", uart.buf[i], (i % 16 == 15) ? '\n' : ' ');
+    putchar('\n');
+
+    if(argc > 1)
+    {
+        FILE *f = fopen(argv[1], "wb");
+        if(!f || fwrite(uart.buf, 1, uart.len, f) != uart.len || fclose(f))
+            perror(argv[1]);
+    }
+    if(!check_capture())
+        violations++;
+    if(!check_ir())
+        violations++;
+    return violations ? 1 : 0;
+}
@@ -0,0 +1,252 @@
+#include "vhd44780.h"
+
+#define DL 0x10
+#define N  0x08
+
+#define POWER_ON_US 40000.0
+#define E_PULSE_US  0.45
+
+static void busy(vhd44780 *lcd, double us)
+{
+    lcd->busy_until_us = sim_time_us() + us;
+    lcd->busy_us += us;
+}
+
+// Next DDRAM address. Two line mode has 0x00..0x27 and 0x40..0x67.
+static unsigned char ddram_next(const vhd44780 *lcd, unsigned char ac,
+                                int inc)
+{
+    if(!(lcd->function & N))
+        return (ac + (inc ? 1 : 79)) % 80;
+    if(inc)
+        return ac == 0x27 ? 0x40 : ac == 0x67 ? 0x00 : ac + 1;
+    return ac == 0x40 ? 0x27 : ac == 0x00 ? 0x67 : ac - 1;
+}
+
+static void instruction(vhd44780 *lcd, unsigned char c)
+{
+    lcd->instructions++;
+    if(c & 0x80)
+    {
+        lcd->ac = c & 0x7f;
+        lcd->to_cgram = 0;
+        busy(lcd, 37);
+    }
+    else if(c & 0x40)
+    {
+        lcd->ac = c & 0x3f;
+        lcd->to_cgram = 1;
+        busy(lcd, 37);
+    }
+    else if(c & 0x20)
+    {
+        lcd->function = c & 0x1c;
+        busy(lcd, 37);
+    }
+    else if(c & 0x10)
+    {
+        // Cursor or display shift.
+        int right = c & 0x04;
+        if(c & 0x08)
+            lcd->shift = (lcd->shift + (right ? 39 : 1)) % 40;
+        else
+            lcd->ac = ddram_next(lcd, lcd->ac, right);
+        busy(lcd, 37);
+    }
+    else if(c & 0x08)
+    {
+        lcd->control = c & 0x07;
+        busy(lcd, 37);
+    }
+    else if(c & 0x04)
+    {
+        lcd->entry = c & 0x03;
+        busy(lcd, 37);
+    }
+    else if(c & 0x02)
+    {
+        lcd->ac = 0;
+        lcd->to_cgram = 0;
+        lcd->shift = 0;
+        busy(lcd, 1520);
+    }
+    else if(c & 0x01)
+    {
+        int i;
+        for(i = 0; i < 0x80; ++i)
+            lcd->ddram[i] = ' ';
+        lcd->ac = 0;
+        lcd->to_cgram = 0;
+        lcd->shift = 0;
+        lcd->entry |= 0x02;
+        busy(lcd, 1520);
+    }
+}
+
+static void data(vhd44780 *lcd, unsigned char d)
+{
+    int inc = lcd->entry & 0x02;
+
+    lcd->data_writes++;
+    if(lcd->to_cgram)
+    {
+        lcd->cgram[lcd->ac & 0x3f] = d & 0x1f;
+        lcd->ac = (lcd->ac + (inc ? 1 : 63)) & 0x3f;
+    }
+    else
+    {
+        lcd->ddram[lcd->ac] = d;
+        lcd->ac = ddram_next(lcd, lcd->ac, inc);
+        if(lcd->entry & 0x01)
+            lcd->shift = (lcd->shift + (inc ? 1 : 39)) % 40;
+    }
+    busy(lcd, 37 + 4);
+}
+
+static void latch(vhd44780 *lcd, unsigned char nibble, int rs)
+{
+    double t = sim_time_us();
+
+    if(t < POWER_ON_US)
+        sim_violation(lcd->dev.name, "write %.0f us after power on, "
+                      "needs 40 ms", t);
+    else if(t < lcd->busy_until_us)
+        sim_violation(lcd->dev.name, "write while busy, %.1f us early",
+                      lcd->busy_until_us - t);
+
+    // 8-bit mode, D0..D3 aren't wired and read as 0.
+    if(lcd->function & DL)
+    {
+        unsigned char c = nibble << 4;
+        lcd->half = 0;
+        if(rs)
+        {
+            data(lcd, c);
+        }
+        else if((c & 0xf0) == 0x30)
+        {
+            // Reset by instruction: 4.1 ms, then 100 us.
+            if(lcd->init < 3)
+                lcd->init++;
+            lcd->instructions++;
+            busy(lcd, lcd->init == 1 ? 4100 : lcd->init == 2 ? 100 : 37);
+        }
+        else
+        {
+            instruction(lcd, c);
+        }
+        return;
+    }
+
+    if(!lcd->half)
+    {
+        lcd->nibble = nibble;
+        lcd->half = 1;
+        return;
+    }
+    lcd->half = 0;
+    if(rs)
+        data(lcd, (lcd->nibble << 4) | nibble);
+    else
+        instruction(lcd, (lcd->nibble << 4) | nibble);
+}
+
+static void pins(sim_device *dev, unsigned char old, unsigned char now)
+{
+    vhd44780 *lcd = (vhd44780 *)dev;
+    unsigned char d = now & lcd->data;
+
+    if(~old & now & lcd->e)
+        lcd->e_rise_us = sim_time_us();
+    if(!(old & ~now & lcd->e))
+        return;
+
+    if(sim_time_us() - lcd->e_rise_us < E_PULSE_US)
+        sim_violation(dev->name, "E pulse %.0f ns, minimum 450 ns",
+                      (sim_time_us() - lcd->e_rise_us) * 1000);
+    if((old ^ now) & (lcd->data | lcd->rs))
+        sim_violation(dev->name, "data changed on the E falling edge");
+
+    unsigned char mask = lcd->data;
+    while(mask && !(mask & 1))
+    {
+        d >>= 1;
+        mask >>= 1;
+    }
+    latch(lcd, d & 0x0f, (now & lcd->rs) != 0);
+}
+
+void vhd44780_attach(vhd44780 *lcd, unsigned char rs, unsigned char e,
+                     unsigned char data)
+{
+    int i;
+    lcd->dev.name = "hd44780";
+    lcd->dev.pins = pins;
+    lcd->rs = rs;
+    lcd->e = e;
+    lcd->data = data;
+    for(i = 0; i < 0x80; ++i)
+        lcd->ddram[i] = ' ';
+    lcd->entry = 0x02;
+    lcd->function = DL;
+    sim_attach(&lcd->dev);
+}
+
+static char cgram_glyph(const vhd44780 *lcd, unsigned char c)
+{
+    const unsigned char *rows = &lcd->cgram[(c & 0x07) * 8];
+    int top = rows[0] || rows[1];
+    int middle = rows[2] || rows[3] || rows[4] || rows[5];
+    int bottom = rows[6] || rows[7];
+
+    if(top && middle && bottom)
+        return '#';
+    if(top && bottom)
+        return '=';
+    if(top)
+        return '"';
+    if(bottom)
+        return '_';
+    if(middle)
+        return '-';
+    return ' ';
+}
+
+void vhd44780_print(const vhd44780 *lcd, FILE *f)
+{
+    int line;
+    int i;
+
+    fputs("+----------------+\n", f);
+    for(line = 0; line < 2; ++line)
+    {
+        fputc('|', f);
+        for(i = 0; i < VHD44780_COLS; ++i)
+        {
+            unsigned char c = ' ';
+            if(lcd->function & N)
+                c = lcd->ddram[line * 0x40 + (lcd->shift + i) % 40];
+            else if(!line)
+                c = lcd->ddram[(lcd->shift + i) % 80];
+            if(!(lcd->control & 0x04))
+                c = ' '; // Display off.
+            else if(c < 0x10)
+                c = cgram_glyph(lcd, c);
+            else if(c == 0xdf)
+                c = 'o'; // Degree sign in the A00 ROM.
+            else if(c < 0x20 || c > 0x7e)
+                c = '?';
+            fputc(c, f);
+        }
+        fputs("|\n", f);
+    }
+    fputs("+----------------+\n", f);
+}
+
+void vhd44780_stats(const vhd44780 *lcd, FILE *f)
+{
+    double t = sim_time_us();
+    fprintf(f, "%s: %lu instructions, %lu data writes, busy %.1f%% of "
+            "%.1f ms\n", lcd->dev.name, lcd->instructions, lcd->data_writes,
+            t > 0 ? 100 * lcd->busy_us / t : 0.0, t / 1000);
+}
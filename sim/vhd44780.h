@@ -0,0 +1,55 @@
+#ifndef VHD44780_H_
+#define VHD44780_H_
+
+#include <stdio.h>
+
+#include "sim.h"
+
+// Virtual HD44780 16x2 character display on Port 1, RW tied to GND.
+//
+// Latches on E falling edges. Starts in 8-bit mode with D4..D7 wired, so
+// the usual 0x3, 0x3, 0x3, 0x2 sequence is needed to get to 4-bit mode.
+// Flags writes during the 40 ms power on time, the 4.1 ms/100 us init
+// waits, the 1.52 ms clear/home and the 37 us (41 us for data) execution
+// time, and E pulses shorter than 450 ns.
+
+#define VHD44780_COLS 16
+
+typedef struct
+{
+    sim_device dev;
+    // Pin masks, data covers D4..D7 on four consecutive pins.
+    unsigned char rs;
+    unsigned char e;
+    unsigned char data;
+
+    unsigned char ddram[0x80];
+    unsigned char cgram[0x40];
+    unsigned char ac;
+    unsigned char to_cgram;
+    unsigned char entry;    // I/D, S.
+    unsigned char control;  // D, C, B.
+    unsigned char function; // DL, N, F.
+    unsigned char shift;    // Display shift.
+    unsigned char init;     // 0x3 function sets seen in 8-bit mode.
+    unsigned char nibble;   // High nibble waiting in 4-bit mode.
+    unsigned char half;
+    double busy_until_us;
+    double e_rise_us;
+
+    // Throughput.
+    unsigned long instructions;
+    unsigned long data_writes;
+    double busy_us;
+} vhd44780;
+
+void vhd44780_attach(vhd44780 *lcd, unsigned char rs, unsigned char e,
+                     unsigned char data);
+
+// Both lines as text. CGRAM characters are drawn by which rows they
+// fill: '#' full, '"' top, '_' bottom, '=' top and bottom, '-' middle.
+void vhd44780_print(const vhd44780 *lcd, FILE *f);
+// Instructions and data written and how much of the time was busy.
+void vhd44780_stats(const vhd44780 *lcd, FILE *f);
+
+#endif
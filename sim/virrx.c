@@ -0,0 +1,52 @@
+#include "virrx.h"
+
+static void end_mark(virrx *rx)
+{
+    if(!rx->in_mark)
+        return;
+    rx->in_mark = 0;
+    if(rx->marks < VIRRX_MARKS)
+        rx->end[rx->marks++] = rx->last_fall;
+}
+
+static void pins(sim_device *dev, unsigned char old, unsigned char now)
+{
+    virrx *rx = (virrx *)dev;
+    double t = sim_time_us();
+
+    if(!((old ^ now) & rx->pin))
+        return;
+    if(!(now & rx->pin))
+    {
+        rx->last_fall = t;
+        return;
+    }
+
+    if(rx->in_mark && t - rx->last_rise > VIRRX_GAP_US)
+        end_mark(rx);
+    if(rx->in_mark)
+    {
+        double khz = 1e3 / (t - rx->last_rise);
+        if(khz < 36 || khz > 40)
+            sim_violation(dev->name, "carrier at %.1f kHz", khz);
+    }
+    else if(rx->marks < VIRRX_MARKS)
+    {
+        rx->in_mark = 1;
+        rx->start[rx->marks] = t;
+    }
+    rx->last_rise = t;
+}
+
+void virrx_attach(virrx *rx, unsigned char pin)
+{
+    rx->dev.name = "ir";
+    rx->dev.pins = pins;
+    rx->pin = pin;
+    sim_attach(&rx->dev);
+}
+
+void virrx_flush(virrx *rx)
+{
+    end_mark(rx);
+}
@@ -0,0 +1,35 @@
+#ifndef VIRRX_H_
+#define VIRRX_H_
+
+#include "sim.h"
+
+// Virtual IR receiver looking at the pin that drives the IR LED.
+//
+// Demodulates like a TSOP receiver: a mark starts on the first carrier
+// rising edge after a gap and ends on the last falling edge before the
+// next one. Flags carrier periods outside 36 to 40 kHz within a mark.
+
+#define VIRRX_MARKS 128
+// Longer than this without a rising edge ends a mark.
+#define VIRRX_GAP_US 100
+
+typedef struct
+{
+    sim_device dev;
+    unsigned char pin; // Pin mask.
+
+    // Mark start and end times in us.
+    double start[VIRRX_MARKS];
+    double end[VIRRX_MARKS];
+    unsigned int marks;
+
+    int in_mark;
+    double last_rise;
+    double last_fall;
+} virrx;
+
+void virrx_attach(virrx *rx, unsigned char pin);
+// Ends a mark still open at the end of a run. Call before reading marks.
+void virrx_flush(virrx *rx);
+
+#endif
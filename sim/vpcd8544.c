@@ -0,0 +1,243 @@
+#include "vpcd8544.h"
+
+#define PD 0x04
+#define V  0x02
+#define H  0x01
+
+static void command(vpcd8544 *lcd, unsigned char c)
+{
+    lcd->commands++;
+    if(c == 0x00)
+        return;
+    if((c & 0xf8) == 0x20)
+    {
+        lcd->function = c & 0x07;
+        return;
+    }
+    if(lcd->function & H)
+    {
+        // Extended set: temperature coefficient, bias, Vop.
+        if(c & 0x80)
+            lcd->vop = c & 0x7f;
+        else if((c & 0xf8) != 0x10 && (c & 0xfc) != 0x04)
+            sim_violation(lcd->dev.name, "unknown extended command 0x%02x", c);
+        return;
+    }
+    if(c & 0x80)
+    {
+        if((c & 0x7f) >= VPCD8544_COLS)
+            sim_violation(lcd->dev.name, "x address %d out of range", c & 0x7f);
+        else
+            lcd->x = c & 0x7f;
+    }
+    else if(c & 0x40)
+    {
+        if((c & 0x07) >= VPCD8544_BANKS || (c & 0x38))
+            sim_violation(lcd->dev.name, "y address 0x%02x out of range", c);
+        else
+            lcd->y = c & 0x07;
+    }
+    else if((c & 0xf8) == 0x08)
+        lcd->display = c & 0x05;
+    else
+        sim_violation(lcd->dev.name, "unknown command 0x%02x", c);
+}
+
+static void data(vpcd8544 *lcd, unsigned char d)
+{
+    if(!lcd->data)
+        lcd->first_us = sim_time_us();
+    lcd->last_us = sim_time_us();
+    lcd->data++;
+
+    if(lcd->function & PD)
+        sim_violation(lcd->dev.name, "data written in power down");
+    lcd->ram[lcd->y][lcd->x] = d;
+
+    if(lcd->function & V)
+    {
+        if(++lcd->y == VPCD8544_BANKS)
+        {
+            lcd->y = 0;
+            if(++lcd->x == VPCD8544_COLS)
+                lcd->x = 0;
+        }
+    }
+    else if(++lcd->x == VPCD8544_COLS)
+    {
+        lcd->x = 0;
+        if(++lcd->y == VPCD8544_BANKS)
+            lcd->y = 0;
+    }
+}
+
+static void pins(sim_device *dev, unsigned char old, unsigned char now)
+{
+    vpcd8544 *lcd = (vpcd8544 *)dev;
+    unsigned char rising = ~old & now;
+
+    if(!(now & lcd->res))
+    {
+        // Reset: power down, basic set, horizontal addressing, blank.
+        if(old & lcd->res)
+        {
+            lcd->function = PD;
+            lcd->display = 0;
+            lcd->x = lcd->y = 0;
+            lcd->bits = 0;
+        }
+        return;
+    }
+    if(rising & lcd->res)
+    {
+        lcd->was_reset = 1;
+        return;
+    }
+
+    if(rising & lcd->sce)
+    {
+        if(lcd->bits)
+            sim_violation(dev->name, "SCE released after %d bits", lcd->bits);
+        lcd->bits = 0;
+    }
+    if(!(rising & lcd->sclk) || (now & lcd->sce))
+        return;
+
+    double t = sim_time_us();
+    if(lcd->commands || lcd->data || lcd->bits)
+        // To the ps, 4 Mhz exactly shouldn't fail on rounding.
+        if(t - lcd->last_rise_us < 0.25 - 1e-6)
+            sim_violation(dev->name, "SCLK period %.0f ns, minimum 250 ns",
+                          (t - lcd->last_rise_us) * 1000);
+    lcd->last_rise_us = t;
+    if((old ^ now) & lcd->sdin)
+        sim_violation(dev->name, "SDIN changed on the SCLK edge sampling it");
+    if(!lcd->was_reset)
+        sim_violation(dev->name, "clocked before the reset pulse");
+
+    lcd->shift = (lcd->shift << 1) | ((now & lcd->sdin) ? 1 : 0);
+    if(++lcd->bits < 8)
+        return;
+    lcd->bits = 0;
+    if(now & lcd->dc)
+        data(lcd, lcd->shift);
+    else
+        command(lcd, lcd->shift);
+}
+
+void vpcd8544_attach(vpcd8544 *lcd, unsigned char res, unsigned char sce,
+                     unsigned char dc, unsigned char sclk, unsigned char sdin)
+{
+    lcd->dev.name = "pcd8544";
+    lcd->dev.pins = pins;
+    lcd->res = res;
+    lcd->sce = sce;
+    lcd->dc = dc;
+    lcd->sclk = sclk;
+    lcd->sdin = sdin;
+    lcd->function = PD;
+    sim_attach(&lcd->dev);
+}
+
+static int pixel(const vpcd8544 *lcd, int x, int y)
+{
+    int on = (lcd->ram[y / 8][x] >> (y % 8)) & 1;
+    if(lcd->function & PD)
+        return 0;
+    switch(lcd->display)
+    {
+    case 0x00:
+        return 0;
+    case 0x01:
+        return 1;
+    case 0x05:
+        return !on;
+    default:
+        return on;
+    }
+}
+
+void vpcd8544_print(const vpcd8544 *lcd, FILE *f)
+{
+    static const char cell[] = " '.:";
+    int x;
+    int y;
+
+    fputc('+', f);
+    for(x = 0; x < VPCD8544_COLS; ++x)
+        fputc('-', f);
+    fputs("+\n", f);
+    for(y = 0; y < 8 * VPCD8544_BANKS; y += 2)
+    {
+        fputc('|', f);
+        for(x = 0; x < VPCD8544_COLS; ++x)
+            fputc(cell[pixel(lcd, x, y) | pixel(lcd, x, y + 1) << 1], f);
+        fputs("|\n", f);
+    }
+    fputc('+', f);
+    for(x = 0; x < VPCD8544_COLS; ++x)
+        fputc('-', f);
+    fputs("+\n", f);
+}
+
+int vpcd8544_save_pbm(const vpcd8544 *lcd, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    int x;
+    int y;
+
+    if(!f)
+        return 0;
+    fprintf(f, "P4\n%d %d\n", VPCD8544_COLS, 8 * VPCD8544_BANKS);
+    for(y = 0; y < 8 * VPCD8544_BANKS; ++y)
+    {
+        unsigned char row[(VPCD8544_COLS + 7) / 8] = {0};
+        for(x = 0; x < VPCD8544_COLS; ++x)
+            if(pixel(lcd, x, y))
+                row[x / 8] |= 0x80 >> (x % 8);
+        fwrite(row, 1, sizeof(row), f);
+    }
+    return fclose(f) == 0;
+}
+
+long vpcd8544_compare_pbm(const vpcd8544 *lcd, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    long differ = 0;
+    int w;
+    int h;
+    int x;
+    int y;
+
+    if(!f)
+        return -1;
+    if(fscanf(f, "P4 %d %d", &w, &h) != 2 || fgetc(f) == EOF ||
+       w != VPCD8544_COLS || h != 8 * VPCD8544_BANKS)
+    {
+        fclose(f);
+        return -1;
+    }
+    for(y = 0; y < h; ++y)
+    {
+        unsigned char row[(VPCD8544_COLS + 7) / 8];
+        if(fread(row, 1, sizeof(row), f) != sizeof(row))
+        {
+            fclose(f);
+            return -1;
+        }
+        for(x = 0; x < w; ++x)
+            differ += !(row[x / 8] & (0x80 >> (x % 8))) != !pixel(lcd, x, y);
+    }
+    fclose(f);
+    return differ;
+}
+
+void vpcd8544_stats(const vpcd8544 *lcd, FILE *f)
+{
+    double span = lcd->last_us - lcd->first_us;
+    fprintf(f, "%s: %lu commands, %lu data bytes", lcd->dev.name,
+            lcd->commands, lcd->data);
+    if(span > 0)
+        fprintf(f, ", %.0f data bytes/s", (lcd->data - 1) * 1e6 / span);
+    fputc('\n', f);
+}
@@ -0,0 +1,61 @@
+#ifndef VPCD8544_H_
+#define VPCD8544_H_
+
+#include <stdio.h>
+
+#include "sim.h"
+
+// Virtual PCD8544 (Nokia 5110) 84x48 display on Port 1.
+//
+// Decodes the serial command stream (sampled on SCLK rising edges while
+// SCE is low) into a framebuffer and flags:
+// - SCLK faster than 4 Mhz.
+// - SDIN changing on the same edge that samples it.
+// - Anything sent before the reset pulse.
+// - Out of range addresses.
+
+#define VPCD8544_COLS 84
+#define VPCD8544_BANKS 6
+
+typedef struct
+{
+    sim_device dev;
+    // Pin masks.
+    unsigned char res;
+    unsigned char sce;
+    unsigned char dc;
+    unsigned char sclk;
+    unsigned char sdin;
+
+    unsigned char ram[VPCD8544_BANKS][VPCD8544_COLS];
+    unsigned char x;
+    unsigned char y;
+    unsigned char function; // Last function set (PD, V, H).
+    unsigned char display;  // Last display control (D, E).
+    unsigned char vop;
+    unsigned char was_reset;
+    unsigned char shift;
+    unsigned char bits;
+    double last_rise_us;
+
+    // Throughput.
+    unsigned long commands;
+    unsigned long data;
+    double first_us;
+    double last_us;
+} vpcd8544;
+
+void vpcd8544_attach(vpcd8544 *lcd, unsigned char res, unsigned char sce,
+                     unsigned char dc, unsigned char sclk, unsigned char sdin);
+
+// Text rendering, two pixel rows per line.
+void vpcd8544_print(const vpcd8544 *lcd, FILE *f);
+// Binary PBM image of the glass. Returns 0 on failure.
+int vpcd8544_save_pbm(const vpcd8544 *lcd, const char *path);
+// Pixels that differ from a PBM saved by vpcd8544_save_pbm(), -1 if it
+// can't be read or has another size.
+long vpcd8544_compare_pbm(const vpcd8544 *lcd, const char *path);
+// Bytes received and rate.
+void vpcd8544_stats(const vpcd8544 *lcd, FILE *f);
+
+#endif
@@ -0,0 +1,60 @@
+#include "vuart.h"
+
+static void finish(vuart *uart)
+{
+    uart->in_frame = 0;
+    // Start bit 0, stop bit 1.
+    if((uart->frame & 1) || !(uart->frame & 0x200))
+    {
+        sim_violation(uart->dev.name, "framing error");
+        return;
+    }
+    if(uart->len < VUART_SIZE)
+        uart->buf[uart->len++] = uart->frame >> 1;
+}
+
+// Takes the bits whose middle is before t at the current level.
+static void take(vuart *uart, double t)
+{
+    while(uart->in_frame &&
+          uart->start_us + (uart->bits + 0.5) * uart->bit_us < t)
+    {
+        if(uart->level)
+            uart->frame |= 1 << uart->bits;
+        if(++uart->bits == 10)
+            finish(uart);
+    }
+}
+
+static void pins(sim_device *dev, unsigned char old, unsigned char now)
+{
+    vuart *uart = (vuart *)dev;
+    double t = sim_time_us();
+
+    if(!((old ^ now) & uart->rx))
+        return;
+    take(uart, t);
+    uart->level = (now & uart->rx) != 0;
+    if(!uart->in_frame && !uart->level)
+    {
+        uart->in_frame = 1;
+        uart->start_us = t;
+        uart->bits = 0;
+        uart->frame = 0;
+    }
+}
+
+void vuart_attach(vuart *uart, unsigned char rx, unsigned long bps)
+{
+    uart->dev.name = "uart";
+    uart->dev.pins = pins;
+    uart->rx = rx;
+    uart->bit_us = 1e6 / bps;
+    uart->level = 1;
+    sim_attach(&uart->dev);
+}
+
+void vuart_flush(vuart *uart)
+{
+    take(uart, uart->start_us + 10 * uart->bit_us);
+}
@@ -0,0 +1,31 @@
+#ifndef VUART_H_
+#define VUART_H_
+
+#include "sim.h"
+
+// Virtual serial receiver (8N1) on a Port 1 pin, e.g. a software UART
+// going to the Launchpad's USB bridge. Flags framing errors.
+
+#define VUART_SIZE 4096
+
+typedef struct
+{
+    sim_device dev;
+    unsigned char rx; // Pin mask.
+    double bit_us;
+
+    unsigned char buf[VUART_SIZE];
+    unsigned int len;
+    int in_frame;
+    double start_us;
+    unsigned char level; // Line level since the last edge.
+    unsigned int bits;   // Bits taken so far, start bit included.
+    unsigned int frame;
+} vuart;
+
+void vuart_attach(vuart *uart, unsigned char rx, unsigned long bps);
+// Finishes a frame whose last bits had no edge after them. Call before
+// reading buf at the end of a run.
+void vuart_flush(vuart *uart);
+
+#endif
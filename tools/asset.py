@@ -0,0 +1,342 @@
+#!/usr/bin/env python3
+"""Turns a 1 bit image into a C header with the bytes a display takes.
+
+Run by make through lib/asset.mk. Dark pixels are on. PBM (P1 or P4) and
+PNG (8 bit or less, not interlaced) are read; PNG pixels are on when they
+are darker than half and not more than half transparent.
+
+pcd8544: the image in the PCD8544's order, bank by bank (8 rows, bit 0
+at the top), column by column, as NAME[]. The height has to be a multiple
+of 8. A glyph strip 5 columns per glyph comes out as consecutive glyphs.
+
+hd44780: the image cut into 5x8 cells. Each different cell is a CGRAM
+glyph, numbered in the order they first come up, as NAME_cgram[] with 8
+rows per glyph, bit 4 the left pixel, ready to write from CGRAM address 0.
+With --picture WxH the image is a row of pictures W cells wide and H
+high (the big digits, 3x2), and NAME_map[] has each picture's glyph codes
+row by row, two per byte with the first in the low nibble.
+
+--rle packs NAME[] or NAME_cgram[] for rle_decode() (lib/rle.h): a byte
+c < 0x80 is followed by c + 1 bytes as they are, c >= 0x80 by one byte
+that is repeated c - 0x80 + 2 times. Use it for data that is streamed to
+the display from the start, not for anything indexed.
+
+Every header is decoded again and compared with the image before it is
+written; exits with 1 when they differ or the image doesn't fit.
+
+    asset.py pcd8544 [--rle] image.pbm name.pcd8544.h
+    asset.py hd44780 [--rle] [--picture WxH] image.pbm name.hd44780.h
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+CGRAM_GLYPHS = 8
+CELL_W = 5
+CELL_H = 8
+RLE_LITERAL = 128
+RLE_RUN = 129
+
+
+class AssetError(Exception):
+    pass
+
+
+def read_pbm(data):
+    # Header fields, each possibly after comments.
+    fields = []
+    pos = 0
+    while len(fields) < 3:
+        m = re.compile(rb'(?:\s|#[^\n]*\n)*(\S+)').match(data, pos)
+        if not m:
+            raise AssetError('short PBM header')
+        fields.append(m.group(1))
+        pos = m.end()
+    magic, w, h = fields[0], int(fields[1]), int(fields[2])
+    if magic == b'P1':
+        bits = [c - ord('0') for c in re.sub(rb'#[^\n]*', b'', data[pos:])
+                if c in b'01']
+        if len(bits) < w * h:
+            raise AssetError('short PBM data')
+        return [bits[y * w:(y + 1) * w] for y in range(h)]
+    if magic == b'P4':
+        pos += 1
+        stride = (w + 7) // 8
+        if len(data) < pos + stride * h:
+            raise AssetError('short PBM data')
+        return [[data[pos + y * stride + x // 8] >> (7 - x % 8) & 1
+                 for x in range(w)] for y in range(h)]
+    raise AssetError('not a PBM (P1 or P4)')
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(data):
+    pos = 8
+    idat = b''
+    palette = []
+    alpha = []
+    while pos < len(data):
+        n, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + n]
+        pos += 12 + n
+        if kind == b'IHDR':
+            w, h, depth, color, _, _, interlace = struct.unpack('>IIBBBBB',
+                                                               body)
+        elif kind == b'PLTE':
+            palette = [body[i:i + 3] for i in range(0, n, 3)]
+        elif kind == b'tRNS':
+            alpha = list(body)
+        elif kind == b'IDAT':
+            idat += body
+    if depth > 8 or interlace:
+        raise AssetError('PNG deeper than 8 bits or interlaced')
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+    bpp = max(1, channels * depth // 8)
+    stride = (w * channels * depth + 7) // 8
+    raw = zlib.decompress(idat)
+    rows = []
+    prev = bytearray(stride)
+    for y in range(h):
+        f = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            line[i] = (line[i] + (0, a, b, (a + b) // 2,
+                                  paeth(a, b, c))[f]) & 0xff
+        prev = line
+        samples = [line[i * depth // 8] >> (8 - depth - i * depth % 8) &
+                   ((1 << depth) - 1) for i in range(w * channels)]
+        top = (1 << depth) - 1
+        row = []
+        for x in range(w):
+            s = samples[x * channels:(x + 1) * channels]
+            if color == 3:
+                rgb = palette[s[0]]
+                a = alpha[s[0]] if s[0] < len(alpha) else 255
+                lum, top_lum, opaque = sum(rgb) / 3, 255, a >= 128
+            else:
+                lum = sum(s[:3 if color in (2, 6) else 1]) / (
+                    3 if color in (2, 6) else 1)
+                top_lum = top
+                opaque = s[-1] * 2 >= top if color in (4, 6) else True
+            row.append(1 if opaque and lum * 2 < top_lum else 0)
+        rows.append(row)
+    return rows
+
+
+def read_image(path):
+    data = open(path, 'rb').read()
+    if data.startswith(b'\x89PNG\r\n\x1a\n'):
+        return read_png(data)
+    return read_pbm(data)
+
+
+def rle_encode(data):
+    out = []
+    literal = []
+
+    def flush():
+        if literal:
+            out.append(len(literal) - 1)
+            out.extend(literal)
+            del literal[:]
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and \
+                run < RLE_RUN:
+            run += 1
+        if run >= 2:
+            flush()
+            out.extend((0x80 + run - 2, data[i]))
+        else:
+            literal.append(data[i])
+            if len(literal) == RLE_LITERAL:
+                flush()
+        i += run
+    flush()
+    return out
+
+
+def rle_decode(data):
+    out = []
+    i = 0
+    while i < len(data):
+        c = data[i]
+        if c & 0x80:
+            out.extend([data[i + 1]] * (c - 0x80 + 2))
+            i += 2
+        else:
+            out.extend(data[i + 1:i + c + 2])
+            i += c + 2
+    return out
+
+
+def pcd8544_bytes(img):
+    h, w = len(img), len(img[0])
+    if h % 8:
+        raise AssetError('height %d is not a multiple of 8' % h)
+    return [sum(img[bank * 8 + b][x] << b for b in range(8))
+            for bank in range(h // 8) for x in range(w)]
+
+
+def pcd8544_image(data, w, h):
+    return [[data[(y // 8) * w + x] >> (y % 8) & 1 for x in range(w)]
+            for y in range(h)]
+
+
+def cell(img, cx, cy):
+    return tuple(sum(img[cy * CELL_H + r][cx * CELL_W + b] << (4 - b)
+                     for b in range(CELL_W)) for r in range(CELL_H))
+
+
+def hd44780_glyphs(img, picture):
+    h, w = len(img), len(img[0])
+    pw, ph = picture or (w // CELL_W, h // CELL_H)
+    if w % (pw * CELL_W) or h != ph * CELL_H:
+        raise AssetError('%dx%d is not a row of %dx%d cell pictures' %
+                         (w, h, pw, ph))
+    glyphs = []
+    codes = []
+    for p in range(w // (pw * CELL_W)):
+        for cy in range(ph):
+            for cx in range(pw):
+                g = cell(img, p * pw + cx, cy)
+                if g not in glyphs:
+                    glyphs.append(g)
+                codes.append(glyphs.index(g))
+    if len(glyphs) > CGRAM_GLYPHS:
+        raise AssetError('%d different cells, CGRAM holds %d' %
+                         (len(glyphs), CGRAM_GLYPHS))
+    return glyphs, codes, pw * ph
+
+
+def hd44780_image(cgram, codes, per, pw, w, h):
+    img = [[0] * w for _ in range(h)]
+    for i, code in enumerate(codes):
+        p, c = divmod(i, per)
+        cx, cy = p * pw + c % pw, c // pw
+        for r in range(CELL_H):
+            for b in range(CELL_W):
+                img[cy * CELL_H + r][cx * CELL_W + b] = \
+                    cgram[code * CELL_H + r] >> (4 - b) & 1
+    return img
+
+
+def pack_map(codes, per):
+    out = []
+    for p in range(0, len(codes), per):
+        pic = codes[p:p + per] + [0] * (per % 2)
+        out.extend(pic[i] | pic[i + 1] << 4 for i in range(0, per, 2))
+    return out
+
+
+def unpack_map(data, per):
+    per_bytes = (per + 1) // 2
+    codes = []
+    for p in range(0, len(data), per_bytes):
+        pic = []
+        for b in data[p:p + per_bytes]:
+            pic.extend((b & 0x0f, b >> 4))
+        codes.extend(pic[:per])
+    return codes
+
+
+def c_array(name, data):
+    lines = ['static const unsigned char %s[] = {' % name]
+    for i in range(0, len(data), 8):
+        lines.append('    ' + ', '.join('0x%02x' % b
+                                        for b in data[i:i + 8]) + ',')
+    lines.append('};')
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.split('\n\n')[0])
+    parser.add_argument('kind', choices=('pcd8544', 'hd44780'))
+    parser.add_argument('image')
+    parser.add_argument('header')
+    parser.add_argument('--rle', action='store_true',
+                        help='pack for rle_decode()')
+    parser.add_argument('--picture', metavar='WxH',
+                        help='cells per picture, hd44780 only')
+    args = parser.parse_args()
+
+    name = os.path.basename(args.image).rsplit('.', 1)[0]
+    upper = name.upper()
+    guard = re.sub(r'\W', '_', os.path.basename(args.header).upper()) + '_'
+    picture = None
+    if args.picture:
+        picture = tuple(int(n) for n in args.picture.split('x'))
+
+    try:
+        img = read_image(args.image)
+        h, w = len(img), len(img[0])
+        body = []
+        if args.kind == 'pcd8544':
+            data = pcd8544_bytes(img)
+            stored = rle_encode(data) if args.rle else data
+            back = pcd8544_image(rle_decode(stored) if args.rle else stored,
+                                 w, h)
+            body.append('// %dx%d, %d bytes%s.' %
+                        (w, h, len(data),
+                         ', RLE in %d' % len(stored) if args.rle else ''))
+            body.append('#define %s_WIDTH %d' % (upper, w))
+            body.append('#define %s_BANKS %d' % (upper, h // 8))
+            body.append('#define %s_BYTES %d' % (upper, len(data)))
+            body.extend(c_array(name, stored))
+        else:
+            glyphs, codes, per = hd44780_glyphs(img, picture)
+            cgram = [row for g in glyphs for row in g]
+            stored = rle_encode(cgram) if args.rle else cgram
+            packed = pack_map(codes, per)
+            back = hd44780_image(
+                rle_decode(stored) if args.rle else stored,
+                unpack_map(packed, per) if picture else codes, per,
+                picture[0] if picture else w // CELL_W, w, h)
+            body.append('// %d glyphs, %d CGRAM bytes%s.' %
+                        (len(glyphs), len(cgram),
+                         ', RLE in %d' % len(stored) if args.rle else ''))
+            body.append('#define %s_GLYPHS %d' % (upper, len(glyphs)))
+            body.append('#define %s_CGRAM_BYTES %d' % (upper, len(cgram)))
+            body.extend(c_array(name + '_cgram', stored))
+            if picture:
+                body.append('')
+                body.append('// %d pictures, %d bytes each.' %
+                            (len(packed) * 2 // (per + per % 2),
+                             (per + 1) // 2))
+                body.append('#define %s_MAP_BYTES %d' %
+                            (upper, (per + 1) // 2))
+                body.extend(c_array(name + '_map', packed))
+        if back != img:
+            raise AssetError('decoded header differs from the image')
+    except (AssetError, KeyError, OSError, ValueError, zlib.error) as e:
+        sys.stderr.write('%s: %s\n' % (args.image, e))
+        return 1
+
+    with open(args.header, 'w') as f:
+        f.write('\n'.join(
+            ['// Generated by tools/asset.py from %s, do not edit.' %
+             os.path.basename(args.image),
+             '#ifndef %s' % guard, '#define %s' % guard, ''] + body +
+            ['', '#endif', '']))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
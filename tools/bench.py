@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Runs the simulator benchmarks and compares them with the baseline.
+
+Run through the top level Makefile (make bench), which builds sim/ first.
+Each sim/bench_* program prints one JSON line per case (see sim/bench.h):
+simulated us, MCLK cycles and bytes put on the display or UART bus, plus
+case specific fields (errors, error_c, max_error_us, period, ...). Checks
+(bench_check()) have only their fields and show - for the metrics.
+
+The cases are written as one JSON object keyed by name (-o) and checked
+against tools/bench_baseline.json. Exits with 1 when a program fails
+(violations), a case reports errors, or a case's us, cycles or bus_bytes
+went up by more than --threshold percent. --update makes the results the
+new baseline.
+
+Cases marked estimate (bench_estimate()) charge cycles counted by hand
+from the source, which don't follow the code. They are shown, but only
+their errors are checked, and they are left out of the baseline.
+
+    bench.py [-o results.json] [--threshold PERCENT] [--update]
+"""
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BASELINE = os.path.join(ROOT, 'tools', 'bench_baseline.json')
+# Lower is better for all of them.
+METRICS = ('us', 'cycles', 'bus_bytes')
+
+
+def run():
+    """Returns {name: case} from every bench program and whether they
+    all passed."""
+    cases = {}
+    ok = True
+    for prog in sorted(glob.glob(os.path.join(ROOT, 'sim', 'bench_*'))):
+        if not os.access(prog, os.X_OK) or prog.endswith('.c'):
+            continue
+        p = subprocess.run([prog], stdout=subprocess.PIPE,
+                           stderr=subprocess.PIPE, universal_newlines=True)
+        if p.returncode:
+            sys.stderr.write(p.stderr)
+            print('%s: failed' % os.path.basename(prog))
+            ok = False
+        for line in p.stdout.splitlines():
+            if line.startswith('{'):
+                case = json.loads(line)
+                cases[case.pop('name')] = case
+    return cases, ok
+
+
+def change(new, old):
+    if old == new:
+        return ''
+    if not old:
+        return 'new'
+    return '%+.1f%%' % (100.0 * (new - old) / old)
+
+
+def compare(cases, baseline, threshold):
+    """Prints the cases against the baseline. Returns the names of the
+    ones that got worse or report errors."""
+    worse = []
+    print('%-26s %12s %10s %6s  %s' % ('case', 'us', 'cycles', 'bus',
+                                       'vs baseline'))
+    for name in sorted(cases):
+        case = cases[name]
+        old = baseline.get(name)
+        estimate = case.get('estimate')
+        notes = []
+        for m in METRICS:
+            if estimate or old is None or m not in old or m not in case:
+                continue
+            c = change(case[m], old[m])
+            if c:
+                notes.append('%s %s' % (m, c))
+            if case[m] > old[m] * (1 + threshold / 100.0):
+                worse.append(name)
+        for key in sorted(set(case) - set(METRICS) - {'estimate'}):
+            notes.append('%s %g' % (key, case[key]))
+            if old is not None and old.get(key) != case[key]:
+                notes[-1] += ' (was %s)' % old.get(key)
+        if case.get('errors'):
+            worse.append(name)
+        if estimate:
+            notes.insert(0, 'estimate')
+        elif old is None:
+            notes.insert(0, 'new')
+        if 'us' in case:
+            shown = '%12.3f %10d %6d' % (case['us'], case['cycles'],
+                                         case['bus_bytes'])
+        else:
+            shown = '%12s %10s %6s' % ('-', '-', '-')
+        print('%-26s %s  %s' % (name, shown, ', '.join(notes)))
+    for name in sorted(set(baseline) - set(cases)):
+        print('%-26s missing' % name)
+    return sorted(set(worse))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('-o', '--output',
+                        help='write the results here as JSON')
+    parser.add_argument('--baseline', default=BASELINE)
+    parser.add_argument('--threshold', type=float, default=1.0,
+                        help='percent a metric may grow (default 1)')
+    parser.add_argument('--update', action='store_true',
+                        help='write the results as the new baseline')
+    args = parser.parse_args()
+
+    cases, ok = run()
+    if not cases:
+        sys.exit('bench: no results, build sim/ first (make sim)')
+    text = json.dumps(cases, indent=1, sort_keys=True) + '\n'
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text)
+
+    baseline = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+    worse = compare(cases, baseline, args.threshold)
+
+    if args.update:
+        measured = dict((name, case) for name, case in cases.items()
+                        if not case.get('estimate'))
+        with open(args.baseline, 'w') as f:
+            f.write(json.dumps(measured, indent=1, sort_keys=True) + '\n')
+        print('baseline updated')
+    elif worse:
+        print('worse than the baseline: %s' % ', '.join(worse))
+    if not ok or (worse and not args.update):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
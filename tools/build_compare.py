@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+"""Compares each project's build without LTO against the LTO build.
+
+Run through make lto-compare (top level or in a project), which builds
+the project with LTO=0 into nolto/ and then with LTO (see lib/lib.mk).
+For every elf in nolto/ and its LTO twin it prints flash and RAM as
+size_report.py counts them, the number of call instructions and of
+functions, and a static cycle estimate for the ISRs and the hot driver
+paths in HOT.
+
+The cycle estimate walks each function once, every instruction counted
+once with the MSP430 cycle tables (SLAU144), plus the estimate of every
+function it calls or branches to, once per call site. Loops are not
+unrolled, so it is not a run time: it measures what inlining removes
+(call, ret, pushes, pops and argument moves) on one trip through a path.
+A function that no longer exists in the LTO build is shown as inlined.
+
+    build_compare.py [project ...]
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+from size_report import CALL, LABEL, find_projects, section_sizes, symbols, \
+    tool, vectors
+
+# Hot paths per project, next to the ISRs.
+HOT = {
+    'interrupt_count': ('lcdq_flush',),
+    'lcddemo': ('display_clear', 'display_send_byte', 'physics_step'),
+    'lcdtemp': ('lcd_send_data', 'lcd_disp_digit', 'tempsensor_convert'),
+    'multiapp': ('lcdq_flush', 'tempsensor_convert'),
+    'remote': ('irtx_send', 'irtx_mark'),
+}
+
+# Source addressing modes.
+REG, INDIRECT, AUTOINC, IMMEDIATE, INDEXED = range(5)
+
+# Format I cycles by source mode: to a register, to the PC, to memory.
+FORMAT_I = {
+    REG: (1, 2, 4),
+    INDIRECT: (2, 2, 5),
+    AUTOINC: (2, 3, 5),
+    IMMEDIATE: (2, 3, 5),
+    INDEXED: (3, 3, 6),
+}
+
+# Format II cycles by operand mode: rra/rrc/swpb/sxt, push, call.
+FORMAT_II = {
+    REG: (1, 3, 4),
+    INDIRECT: (3, 4, 4),
+    AUTOINC: (3, 5, 5),
+    IMMEDIATE: (None, 4, 5),
+    INDEXED: (4, 5, 5),
+}
+FORMAT_II_COLUMN = {'rra': 0, 'rrc': 0, 'swpb': 0, 'sxt': 0, 'push': 1,
+                    'call': 2}
+
+# Emulated with a constant generator as the source: count as a register.
+EMULATED = {'adc', 'clr', 'dadc', 'dec', 'decd', 'inc', 'incd', 'inv',
+            'sbc', 'tst'}
+# Emulated on the status register, one cycle.
+STATUS = {'clrc', 'clrn', 'clrz', 'dint', 'eint', 'setc', 'setn', 'setz',
+          'nop'}
+# rla and rlc add the destination to itself.
+SELF = {'rla', 'rlc'}
+
+REGISTER = re.compile(r'^(r\d+|pc|sp|sr|cg)$')
+PC = ('r0', 'pc')
+
+
+def mode(operand):
+    if REGISTER.match(operand):
+        return REG
+    if operand.startswith('@'):
+        return AUTOINC if operand.endswith('+') else INDIRECT
+    if operand.startswith('#'):
+        return IMMEDIATE
+    return INDEXED  # x(Rn), symbolic and &absolute.
+
+
+def cycles(mnemonic, operands, comment):
+    """Cycles for one instruction, None if it isn't one (.word)."""
+    op = mnemonic.split('.')[0]
+    args = [a.strip() for a in operands.split(',') if a.strip()]
+    if op.startswith('j'):
+        return 2
+    if op == 'reti':
+        return 5
+    if op == 'ret':
+        return 3
+    if op in STATUS:
+        return 1
+    if op == 'pop':
+        return 2 if mode(args[0]) == REG else 5
+    if op in FORMAT_II_COLUMN:
+        return FORMAT_II[mode(args[0])][FORMAT_II_COLUMN[op]]
+    if op in EMULATED or op in SELF:
+        src, dst = (mode(args[0]) if op in SELF else REG), args[0]
+    elif op == 'br':
+        src, dst = mode(args[0]), 'pc'
+    elif len(args) == 2:
+        src, dst = mode(args[0]), args[1]
+        # #0, #1, #2, #4, #8 and #-1 come from r2 or r3.
+        if src == IMMEDIATE and re.search(r'r[23] As==', comment):
+            src = REG
+    else:
+        return None
+    column = 1 if dst in PC else 0 if mode(dst) == REG else 2
+    return FORMAT_I[src][column]
+
+
+def disassembly(elf, funcs):
+    """Returns {function: (cycles of its own instructions, callees one per
+    call site)}."""
+    by_addr = {f.start: f.name for f in funcs}
+    result = {}
+    current = None
+    for line in tool('objdump', '-d', elf).splitlines():
+        m = LABEL.match(line)
+        if m:
+            current = m.group(2)
+            result[current] = (0, [])
+            continue
+        parts = line.split('\t')
+        if current is None or len(parts) < 3 or not parts[2].strip():
+            continue
+        mnemonic = parts[2].strip()
+        text = '\t'.join(parts[3:])
+        operands, _, comment = text.partition(';')
+        n = cycles(mnemonic, operands, comment)
+        if n is None:
+            continue
+        own, callees = result[current]
+        m = CALL.search(line)
+        if m:
+            target = int(m.group(2), 0) & 0xffff
+            if target in by_addr and by_addr[target] != current:
+                callees.append(by_addr[target])
+        result[current] = (own + n, callees)
+    return result
+
+
+def path_cycles(fn, code, path=()):
+    """One pass through fn and, once per call site, its callees.
+    Recursion counts nothing the second time round."""
+    if fn in path or fn not in code:
+        return 0
+    own, callees = code[fn]
+    return own + sum(path_cycles(c, code, path + (fn,)) for c in callees)
+
+
+def base(name):
+    """display_send_byte for display_send_byte.lto_priv.0, .constprop.0,
+    .isra.0 and the like."""
+    return name.split('.')[0]
+
+
+def measure(elf):
+    sizes = section_sizes(elf)
+    funcs, _ = symbols(elf)
+    code = disassembly(elf, funcs)
+    names = {}
+    for f in funcs:
+        names.setdefault(base(f.name), f.name)
+    return {
+        'flash': sizes.get('.text', 0) + sizes.get('.data', 0) +
+        sizes.get('.rodata', 0),
+        'ram': sizes.get('.data', 0) + sizes.get('.bss', 0) +
+        sizes.get('.noinit', 0),
+        'call sites': sum(len(c[1]) for c in code.values()),
+        'functions': len(funcs),
+        'isrs': [base(isr) for isr in vectors(elf, funcs)],
+        'cycles': {b: path_cycles(n, code) for b, n in names.items()},
+    }
+
+
+def change(old, new):
+    if old == new or not old:
+        return ''
+    return '%+.1f%%' % (100.0 * (new - old) / old)
+
+
+def compare(project, name, old, new):
+    print('== %s/%s ==' % (project, name))
+    print('%-24s %8s %8s' % ('', 'no lto', 'lto'))
+    for key in ('flash', 'ram', 'call sites', 'functions'):
+        print(('%-24s %8d %8d  %s' % (key, old[key], new[key],
+                                      change(old[key], new[key]))).rstrip())
+    print('cycles, one pass:')
+    paths = sorted(set(old['isrs']) | set(new['isrs']))
+    paths += [h for h in HOT.get(project, ()) if h not in paths]
+    for fn in paths:
+        if fn not in old['cycles']:
+            continue
+        a = old['cycles'][fn]
+        if fn in new['cycles']:
+            b = new['cycles'][fn]
+            print(('  %-22s %8d %8d  %s' % (fn, a, b,
+                                            change(a, b))).rstrip())
+        else:
+            print('  %-22s %8d  inlined' % (fn, a))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('projects', nargs='*',
+                        help='project directories (default: all)')
+    args = parser.parse_args()
+
+    missing = []
+    for p in find_projects(args.projects):
+        olds = sorted(glob.glob(os.path.join(p.dir, 'nolto', '*.elf')))
+        if not olds:
+            missing.append(p.name)
+        for old in olds:
+            name = os.path.basename(old)
+            new = os.path.join(p.dir, name)
+            if not os.path.exists(new):
+                missing.append('%s/%s' % (p.name, name))
+                continue
+            compare(p.name, os.path.splitext(name)[0], measure(old),
+                    measure(new))
+    if missing:
+        sys.exit('build compare: not built (make lto-builds): %s' %
+                 ', '.join(missing))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,360 @@
+#!/usr/bin/env python3
+"""Flash, RAM and stack report for every project, checked against budgets.
+
+Run through the top level Makefile (make size-report), which builds each
+project with STACK_USAGE=1 (-fstack-usage, see lib/lib.mk) first. For
+each project it reads the elf with msp430-size, msp430-nm and
+msp430-objdump and prints:
+
+- flash (.text + .data initialisers) and RAM (.data + .bss + .noinit)
+  against the chip and the budget in tools/budgets.txt,
+- the largest functions and variables,
+- the worst case stack: deepest call chain from main plus the deepest ISR
+  (ISRs don't nest, none of them enable interrupts). Frame sizes come from
+  the .su files in the project's directory (with LTO, all the code
+  generated at the link) and its driver archive's, or from counting
+  pushes for code without them (libgcc, assembly).
+
+Exits with 1 when something is over budget or doesn't fit the chip, or
+when a project's budget is - (not measured yet, checked against the chip
+meanwhile). With --set-budgets it writes each project's budget instead:
+what it measured plus FLASH_HEADROOM and RAM_HEADROOM, at most the chip.
+
+    size_report.py [--top N] [--set-budgets] [project ...]
+"""
+
+import argparse
+import collections
+import glob
+import os
+import re
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BUDGETS = os.path.join(ROOT, 'tools', 'budgets.txt')
+TOOLCHAIN = os.environ.get('TOOLCHAIN', 'msp430')
+
+# Flash, RAM in bytes.
+CHIPS = {
+    'msp430g2231': (2048, 128),
+    'msp430g2452': (8192, 256),
+    'msp430g2553': (16384, 512),
+}
+
+# Headroom --set-budgets leaves over the measured size: a tenth of the
+# flash in whole 64 byte segments, and bytes of RAM for a few more
+# variables or a deeper call.
+FLASH_HEADROOM = 0.1
+RAM_HEADROOM = 16
+
+# Return address pushed by call, PC and SR pushed on interrupt entry.
+CALL_BYTES = 2
+ISR_BYTES = 4
+
+Project = collections.namedtuple('Project', 'name dir elf mcu')
+Function = collections.namedtuple('Function', 'name start end')
+
+
+def tool(name, *args):
+    return subprocess.check_output(('%s-%s' % (TOOLCHAIN, name),) + args,
+                                   universal_newlines=True)
+
+
+def find_projects(names):
+    projects = []
+    for mk in sorted(glob.glob(os.path.join(ROOT, '*', 'Makefile'))):
+        d = os.path.dirname(mk)
+        name = os.path.basename(d)
+        if names and name not in names:
+            continue
+        text = open(mk).read()
+        m = re.search(r'-mmcu=(\w+)', text) or \
+            re.search(r'^MCU\s*=\s*(\w+)', text, re.M)
+        if not m:
+            continue
+        elf = glob.glob(os.path.join(d, '*.elf'))
+        projects.append(Project(name, d, elf[0] if elf else None,
+                                m.group(1)))
+    return projects
+
+
+def read_budgets():
+    budgets = {}
+    for line in open(BUDGETS):
+        line = line.split('#')[0].split()
+        if line:
+            budgets[line[0]] = None if '-' in line[1:3] else \
+                (int(line[1]), int(line[2]))
+    return budgets
+
+
+def set_budgets(measured):
+    """Rewrites the budgets of the measured projects, {name: (flash, ram,
+    mcu)}, keeping the comments."""
+    lines = []
+    for line in open(BUDGETS):
+        name = line.split('#')[0].split()[:1]
+        if name and name[0] in measured:
+            flash, ram, mcu = measured.pop(name[0])
+            flash_chip, ram_chip = CHIPS[mcu]
+            flash = min(flash_chip, -(-int(flash * (1 + FLASH_HEADROOM)) //
+                                      64) * 64)
+            ram = min(ram_chip, ram + RAM_HEADROOM)
+            line = '%-17s %5d %5d\n' % (name[0], flash, ram)
+        lines.append(line)
+    open(BUDGETS, 'w').writelines(lines)
+
+
+def section_sizes(elf):
+    sizes = {}
+    for line in tool('size', '-A', elf).splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[0].startswith('.') and \
+                parts[1].isdigit():
+            sizes[parts[0]] = int(parts[1])
+    return sizes
+
+
+def symbols(elf):
+    """Returns (functions sorted by address, {name: size} for RAM)."""
+    funcs = []
+    ram = {}
+    out = tool('nm', '-S', '--size-sort', elf)
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) != 4:
+            continue
+        addr, size, kind, name = int(parts[0], 16), int(parts[1], 16), \
+            parts[2], parts[3]
+        if kind in 'Tt':
+            funcs.append(Function(name, addr, addr + size))
+        elif kind in 'DdBb':
+            ram[name] = size
+    funcs.sort(key=lambda f: f.start)
+    return funcs, ram
+
+
+def lib_dir(d):
+    """The directory of the project's driver archive (lib.mk's LIBDIR),
+    None for a project that doesn't use lib.mk."""
+    try:
+        out = subprocess.check_output(
+            ('make', '-s', '--no-print-directory', '-C', d, 'libdir'),
+            stderr=subprocess.DEVNULL, universal_newlines=True)
+    except (OSError, subprocess.CalledProcessError):
+        return None
+    return os.path.normpath(os.path.join(d, out.strip()))
+
+
+def stack_usage(dirs):
+    """Frame sizes from the .su files gcc -fstack-usage wrote in dirs."""
+    frames = {}
+    sus = []
+    for d in dirs:
+        if d:
+            sus += glob.glob(os.path.join(d, '*.su'))
+    for su in sus:
+        for line in open(su):
+            parts = line.rstrip('\n').split('\t')
+            if len(parts) >= 2:
+                frames[parts[0].split(':')[-1]] = int(parts[1])
+    return frames
+
+
+CALL = re.compile(r'\s(call|br)\s+#(-?\d+|0x[0-9a-fA-F]+)')
+JMP = re.compile(r';abs 0x([0-9a-fA-F]+)')
+INDIRECT = re.compile(r'\scall\s+[@r0-9(]')
+PUSH = re.compile(r'\spush(\.b)?\s')
+SUB_SP = re.compile(r'\ssub\s+#(\d+),\s*r1\b')
+LABEL = re.compile(r'^([0-9a-f]+) <([^>]+)>:')
+
+
+def call_graph(elf, funcs):
+    """Returns {function: set of callees}, indirect callers and an
+    estimate of frame sizes from the disassembly."""
+    by_addr = {f.start: f.name for f in funcs}
+    calls = collections.defaultdict(set)
+    indirect = set()
+    estimate = collections.Counter()
+    current = None
+    current_fn = None
+
+    for line in tool('objdump', '-d', elf).splitlines():
+        m = LABEL.match(line)
+        if m:
+            current = m.group(2)
+            current_fn = next((f for f in funcs if f.name == current), None)
+            continue
+        if current is None:
+            continue
+        m = CALL.search(line)
+        if m:
+            target = int(m.group(2), 0) & 0xffff
+            if target in by_addr:
+                calls[current].add(by_addr[target])
+            continue
+        m = JMP.search(line)
+        if m and current_fn is not None:
+            # Jump out of the function is a tail call.
+            target = int(m.group(1), 16)
+            if not current_fn.start <= target < current_fn.end and \
+                    target in by_addr:
+                calls[current].add(by_addr[target])
+            continue
+        if INDIRECT.search(line):
+            indirect.add(current)
+        elif PUSH.search(line):
+            estimate[current] += 2
+        else:
+            m = SUB_SP.search(line)
+            if m:
+                estimate[current] += int(m.group(1))
+    return calls, indirect, estimate
+
+
+def vectors(elf, funcs):
+    """ISR names from the interrupt vector table."""
+    by_addr = {f.start: f.name for f in funcs}
+    isrs = []
+    out = tool('objdump', '-s', '-j', '.vectors', elf)
+    data = b''
+    for line in out.splitlines():
+        m = re.match(r'^ ([0-9a-f]{4}) ((?:[0-9a-f]{2,8} ?){1,4})', line)
+        if m:
+            data += bytes.fromhex(m.group(2).replace(' ', ''))
+    for i in range(0, len(data) - 2, 2):  # Last one is reset.
+        name = by_addr.get(data[i] | data[i + 1] << 8)
+        if name and not name.startswith('_'):
+            isrs.append(name)
+    return sorted(set(isrs))
+
+
+def deepest(fn, calls, frames, memo, path=()):
+    """Returns (bytes, chain) for the deepest call chain from fn, None
+    bytes when it isn't bounded (recursion)."""
+    if fn in path:
+        return None, (fn,)
+    if fn in memo:
+        return memo[fn]
+    best, chain = 0, ()
+    for callee in sorted(calls.get(fn, ())):
+        depth, sub = deepest(callee, calls, frames, memo, path + (fn,))
+        if depth is None:
+            memo[fn] = (None, (fn,) + sub)
+            return memo[fn]
+        if depth + CALL_BYTES > best:
+            best, chain = depth + CALL_BYTES, sub
+    memo[fn] = (frames.get(fn, 0) + best, (fn,) + chain)
+    return memo[fn]
+
+
+def report(p, budget, top):
+    """Prints the report for one project, None for a budget not measured
+    yet. Returns (0 if it's within a measured budget and fits the chip,
+    flash, ram)."""
+    flash_chip, ram_chip = CHIPS[p.mcu]
+    sizes = section_sizes(p.elf)
+    funcs, ram_syms = symbols(p.elf)
+    frames = stack_usage((p.dir, lib_dir(p.dir)))
+    calls, indirect, estimate = call_graph(p.elf, funcs)
+    missing = [f.name for f in funcs if f.name not in frames]
+    for name in missing:
+        frames[name] = estimate[name]
+
+    flash = sizes.get('.text', 0) + sizes.get('.data', 0) + \
+        sizes.get('.rodata', 0)
+    static_ram = sizes.get('.data', 0) + sizes.get('.bss', 0) + \
+        sizes.get('.noinit', 0)
+
+    memo = {}
+    main_depth, main_chain = deepest('main', calls, frames, memo)
+    isr_depth, isr_chain = 0, ()
+    for isr in vectors(p.elf, funcs):
+        depth, chain = deepest(isr, calls, frames, memo)
+        if depth is None:
+            isr_depth, isr_chain = None, chain
+            break
+        if depth + ISR_BYTES > isr_depth:
+            isr_depth, isr_chain = depth + ISR_BYTES, chain
+    unbounded = main_depth is None or isr_depth is None
+    stack = 0 if unbounded else main_depth + isr_depth
+    ram = static_ram + stack
+
+    print('== %s (%s) ==' % (p.name, p.mcu))
+    failed = budget is None
+    limits = budget or (flash_chip, ram_chip)
+    for what, used, chip, limit in (('flash', flash, flash_chip, limits[0]),
+                                    ('ram', ram, ram_chip, limits[1])):
+        flags = []
+        if used > chip:
+            flags.append('DOES NOT FIT')
+        if used > limit:
+            flags.append('OVER BUDGET')
+        failed |= bool(flags)
+        print('%-6s %6d / budget %6d / chip %6d  %s' %
+              (what, used, limit, chip, ' '.join(flags)))
+    print('       ram is %d static + %d stack' % (static_ram, stack))
+    if budget is None:
+        print('       budget not measured, the chip meanwhile: make budgets')
+
+    if unbounded:
+        print('stack  unbounded, recursion: %s' %
+              ' -> '.join(main_chain if main_depth is None else isr_chain))
+    else:
+        print('stack  main %d: %s' % (main_depth, ' -> '.join(main_chain)))
+        if isr_chain:
+            print('       isr  %d: %s' % (isr_depth, ' -> '.join(isr_chain)))
+    for fn in sorted(indirect):
+        print('       %s makes indirect calls, not followed' % fn)
+    if missing:
+        print('       no .su for %s, frames counted from pushes' %
+              ', '.join(sorted(missing)[:6]) +
+              (' ...' if len(missing) > 6 else ''))
+
+    print('largest functions:')
+    for f in sorted(funcs, key=lambda f: f.start - f.end)[:top]:
+        print('  %6d  %-24s stack %d' % (f.end - f.start, f.name,
+                                         frames.get(f.name, 0)))
+    print('largest variables:')
+    for name, size in sorted(ram_syms.items(), key=lambda s: -s[1])[:top]:
+        print('  %6d  %s' % (size, name))
+    print()
+    return failed, flash, ram
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('projects', nargs='*',
+                        help='project directories (default: all)')
+    parser.add_argument('--top', type=int, default=5,
+                        help='functions and variables to list')
+    parser.add_argument('--set-budgets', action='store_true',
+                        help='write the measured sizes plus headroom to '
+                             'tools/budgets.txt')
+    args = parser.parse_args()
+
+    budgets = read_budgets()
+    measured = {}
+    failed = 0
+    for p in find_projects(args.projects):
+        if p.elf is None:
+            print('== %s: not built ==\n' % p.name)
+            failed = 1
+            continue
+        if p.mcu not in CHIPS:
+            sys.exit('%s: unknown chip %s' % (p.name, p.mcu))
+        budget = budgets.get(p.name, CHIPS[p.mcu])
+        over, flash, ram = report(p, budget, args.top)
+        failed |= over
+        measured[p.name] = (flash, ram, p.mcu)
+
+    if args.set_budgets:
+        set_budgets(measured)
+        print('budgets set in %s' % os.path.relpath(BUDGETS, ROOT))
+    elif failed:
+        sys.exit('size report: over budget or budget not measured')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""Decode ISR trace dumps sent by lib/trace.c (make TRACE=1).
+
+Reads from a serial port or a file of raw bytes and prints per-id
+statistics and histograms of ISR duration and latency.
+
+    trace_decode.py /dev/ttyACM0 --names add_point,start_sample \\
+        --tick-us 0.125 --deadline 80
+
+Frame layout (little endian), see trace_dump():
+    'T', ids, n,
+    ids * (count u16, ticks_max u16, ticks_sum u32, latency_max u8),
+    n * (id u8, latency u8, ticks u16)
+Remote's capture frames (0x21, sample bytes, pre-trigger bytes, samples)
+are skipped whole, so sample bytes are never taken for a header. Other
+bytes on the line are skipped one at a time.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+TRACE_HEADER = 0x54
+# remote/remote.c, see remote/show_samples.py.
+CAPTURE_HEADER = 0x21
+STAT = struct.Struct('<HHIB')
+REC = struct.Struct('<BBH')
+
+
+class Stream(object):
+    """Byte source over a serial port or a file."""
+
+    def __init__(self, path, baud):
+        if os.path.isfile(path):
+            self.f = open(path, 'rb')
+            self.ser = None
+        else:
+            import serial
+            self.ser = serial.Serial(port=path, baudrate=baud)
+            self.f = None
+
+    def read(self, n):
+        if self.ser is not None:
+            return self.ser.read(n)
+        data = self.f.read(n)
+        if len(data) < n:
+            raise EOFError
+        return data
+
+
+def read_frame(stream):
+    """Returns (stats, records) for the next trace frame."""
+    while True:
+        head = stream.read(1)[0]
+        if head == CAPTURE_HEADER:
+            size, pre = stream.read(2)
+            # The same check as show_samples.py; not a frame otherwise.
+            if 0 < size and pre < size:
+                stream.read(size)
+            continue
+        if head != TRACE_HEADER:
+            continue
+        ids, n = stream.read(2)
+        # Not a real header, resynchronise.
+        if ids == 0 or ids > 16 or n > 128:
+            continue
+        stats = [STAT.unpack(stream.read(STAT.size)) for _ in range(ids)]
+        recs = [REC.unpack(stream.read(REC.size)) for _ in range(n)]
+        if any(r[0] >= ids for r in recs):
+            continue
+        return stats, recs
+
+
+def histogram(values, bins, width=40):
+    lines = []
+    if not values:
+        return lines
+    lo, hi = min(values), max(values)
+    step = max(1, (hi - lo + bins) // bins)
+    counts = {}
+    for v in values:
+        b = (v - lo) // step
+        counts[b] = counts.get(b, 0) + 1
+    peak = max(counts.values())
+    for b in range(max(counts) + 1):
+        c = counts.get(b, 0)
+        start = lo + b * step
+        bar = '#' * (c * width // peak) if c else ''
+        lines.append('    %6d-%-6d %6d %s' % (start, start + step - 1, c, bar))
+    return lines
+
+
+def report(stats, samples, names, tick_us, deadline):
+    print('%-14s %8s %10s %10s %10s %8s' %
+          ('isr', 'count', 'avg', 'max', 'max(us)', 'max lat'))
+    for i, (count, tmax, tsum, lmax) in enumerate(stats):
+        name = names[i] if i < len(names) else 'id%d' % i
+        avg = float(tsum) / count if count else 0.0
+        flag = ''
+        if deadline is not None and tmax + lmax > deadline:
+            flag = '  MISSED DEADLINE (%d)' % deadline
+        print('%-14s %8d %10.1f %10d %10.1f %8d%s' %
+              (name, count, avg, tmax, tmax * tick_us, lmax, flag))
+    for i in sorted(samples):
+        name = names[i] if i < len(names) else 'id%d' % i
+        ticks = [t for _, t in samples[i]]
+        lats = [l for l, _ in samples[i]]
+        print('\n%s duration (ticks), %d samples' % (name, len(ticks)))
+        print('\n'.join(histogram(ticks, 10)))
+        if any(lats):
+            print('%s latency (ticks)' % name)
+            print('\n'.join(histogram(lats, 10)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('source', help='serial port or file with raw bytes')
+    parser.add_argument('--baud', type=int, default=9600)
+    parser.add_argument('--names', default='',
+                        help='comma separated names for trace ids')
+    parser.add_argument('--tick-us', type=float, default=1.0,
+                        help='microseconds per TAR tick')
+    parser.add_argument('--deadline', type=int,
+                        help='flag ids whose max latency + duration exceed '
+                             'this many ticks')
+    parser.add_argument('--frames', type=int, default=0,
+                        help='stop after this many frames (0: until EOF)')
+    args = parser.parse_args()
+
+    names = [n for n in args.names.split(',') if n]
+    stream = Stream(args.source, args.baud)
+    samples = {}
+    stats = None
+    frames = 0
+    try:
+        while not args.frames or frames < args.frames:
+            stats, recs = read_frame(stream)
+            frames += 1
+            for rid, lat, ticks in recs:
+                samples.setdefault(rid, []).append((lat, ticks))
+            if stream.ser is not None:
+                report(stats, samples, names, args.tick_us, args.deadline)
+                print()
+    except (EOFError, KeyboardInterrupt):
+        pass
+
+    if stats is None:
+        sys.exit('No trace frames found.')
+    if stream.ser is None:
+        report(stats, samples, names, args.tick_us, args.deadline)
+
+
+if __name__ == '__main__':
+    main()